@@ -0,0 +1,29 @@
+#!/bin/sh
+#
+# genscript.sh: write a large generated hoc script to the standard output.
+#
+# usage: bench/genscript.sh [megabytes]
+#
+# The script (default 50 megabytes) mixes function definitions,
+# comments, string and numeric assignments, and for loops, and is
+# used by bench/parse.sh and bench/run.sh to measure parsing speed.
+
+MB=${1:-50}
+
+exec awk -v size="$MB" 'BEGIN {
+	limit = size * 1024 * 1024
+	for (i = 0; n < limit; i++) {
+		v = "v" (i % 256)
+		if (i % 1000 == 0) {
+			s = sprintf("func f%d(a, b) {\n\tif (a > b) return a - b\n\treturn b * 2.5e-1 + a\n}\n", i)
+		} else if (i % 7 == 0) {
+			s = sprintf("# statement %d\n%s = \"string %d\\t\"\n", i, v, i)
+		} else if (i % 5 == 0) {
+			s = sprintf("for (k = 0; k < %d; k++) { %s += k %% 3; if (k >= 10) break }\n", i % 50, v)
+		} else {
+			s = sprintf("%s = (%d.%d * %s - .5) / 2 ^ 3; %s++\n", v, i, i % 10, v, v)
+		}
+		printf "%s", s
+		n += length(s)
+	}
+}'
@@ -0,0 +1,548 @@
+#include <err.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../hoc.h"
+#include "../code.h"
+#include "../error.h"
+#include "../gramm.h"
+
+/*
+ * Time primitives of the machine in isolation, linking code.o directly.
+ * Primitives that code.o exports (lookupname(), code(), addstr()) are
+ * called in a loop.  The others are static, so they are timed through
+ * the instructions that use them: a sequence of instructions is
+ * generated NSEQ times in a row and run with execute(), and the time
+ * of a simpler base sequence is subtracted, leaving the cost of what
+ * the sequence adds.  Each benchmark is calibrated, warmed up and
+ * sampled several times; samples farther than 3 MADs from the median
+ * are rejected, and the mean of the rest is reported in ns/op.
+ */
+
+#define NSEQ       64           /* copies of a sequence in a body */
+#define NGLOBALS   100          /* globals defined after the deep one */
+#define MINTIME    5e-3         /* minimum time of a sample, in seconds */
+#define MAXSAMPLES 101
+
+/* defined by the scanner in hoc */
+int toklineno = 0;
+int yylineno = 0;
+
+/* a benchmark */
+typedef struct Bench {
+	const char *name;
+	void (*setup)(void);    /* generate the body, or NULL */
+	void (*run)(long n);    /* run n operations */
+	const char *base;       /* benchmark whose time is subtracted, or NULL */
+	int done;
+	double ns;              /* mean time, in ns/op */
+} Bench;
+
+static Inst *body;              /* code run by runbody() */
+static Name *deep, *top, *svar, *func, *sqrtname, *sprintfname;
+static String *fmt, *lit;
+static const char *current;     /* benchmark being run */
+static int nsamples = 15;
+
+/* show usage */
+static void
+usage(void)
+{
+	(void)fprintf(stderr, "usage: micro [-l] [-n samples] [benchmark ...]\n");
+	exit(1);
+}
+
+/* get time in seconds */
+static double
+now(void)
+{
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) == -1)
+		err(1, "clock_gettime");
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* compare doubles, for qsort(3) */
+static int
+cmpdouble(const void *a, const void *b)
+{
+	double x = *(const double *)a;
+	double y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+/* duplicate string, exiting on error */
+static char *
+xstrdup(const char *s)
+{
+	char *p;
+
+	if ((p = strdup(s)) == NULL)
+		err(1, "strdup");
+	return p;
+}
+
+/* generate an operation with an operand of each type */
+static void
+op(void (*f)(void))
+{
+	code((Inst){.type = OPR, .u.opr = f});
+}
+
+static void
+opval(void (*f)(void), double v)
+{
+	op(f);
+	code((Inst){.type = VAL, .u.val = v});
+}
+
+static void
+opstr(void (*f)(void), String *s)
+{
+	op(f);
+	code((Inst){.type = STR, .u.str = s});
+}
+
+static void
+opname(void (*f)(void), Name *n)
+{
+	op(f);
+	code((Inst){.type = NAME, .u.name = n});
+}
+
+static void
+opcall(void (*f)(void), Name *n, int narg)
+{
+	opname(f, n);
+	code((Inst){.type = NARG, .u.narg = narg});
+}
+
+/* start generating a body */
+static void
+begbody(void)
+{
+	prepare();
+	body = getprogp();
+}
+
+/* end generating a body */
+static void
+endbody(void)
+{
+	op(NULL);
+}
+
+/* run the body n / NSEQ times */
+static void
+runbody(long n)
+{
+	for (n /= NSEQ; n > 0; n--)
+		execute(body);
+}
+
+/* define globals, a function f(a) { return a } and the strings used by the benchmarks */
+static void
+setglobals(void)
+{
+	Name *n, *a;
+	char s[16];
+	int i;
+
+	deep = installglobalname("deep", UNDEF);
+	top = installglobalname("top", UNDEF);
+	svar = installglobalname("s", UNDEF);
+	sqrtname = lookupname("sqrt");
+	sprintfname = lookupname("sprintf");
+	if (sqrtname == NULL || sprintfname == NULL)
+		errx(1, "built-in functions not found");
+	fmt = addstr(xstrdup("%g"), 1);
+	lit = addstr(xstrdup("literal"), 1);
+
+	begbody();
+	opval(constpush, 1.0);
+	opname(assign, deep);
+	op(oprpop);
+	for (i = 0; i < NGLOBALS; i++) {
+		(void)snprintf(s, sizeof s, "v%d", i);
+		n = installglobalname(s, UNDEF);
+		opval(constpush, i);
+		opname(assign, n);
+		op(oprpop);
+	}
+	opval(constpush, 0.0);
+	opname(assign, top);
+	op(oprpop);
+	opstr(strpush, lit);
+	opname(assign, svar);
+	op(oprpop);
+	endbody();
+	execute(body);
+
+	/* the code of a function must survive prepare() */
+	prepare();
+	func = installglobalname("f", FUNCTION);
+	a = installlocalname("a", NULL);
+	body = getprogp();
+	opname(eval, a);
+	op(funcret);
+	op(procret);
+	defineat(func, a, body);
+	keepcode();
+}
+
+/* push and pop a constant */
+static void
+setpushpop(void)
+{
+	int i;
+
+	begbody();
+	for (i = 0; i < NSEQ; i++) {
+		opval(constpush, 1.0);
+		op(oprpop);
+	}
+	endbody();
+}
+
+/* push two operands and pop them */
+static void
+setoperands(void)
+{
+	int i;
+
+	begbody();
+	for (i = 0; i < NSEQ; i++) {
+		opval(constpush, 7.0);
+		opval(constpush, 3.0);
+		op(oprpop);
+		op(oprpop);
+	}
+	endbody();
+}
+
+/* push two operands, apply f and pop the result */
+static void
+setbinary(void (*f)(void))
+{
+	int i;
+
+	begbody();
+	for (i = 0; i < NSEQ; i++) {
+		opval(constpush, 7.0);
+		opval(constpush, 3.0);
+		op(f);
+		op(oprpop);
+	}
+	endbody();
+}
+
+/* push an operand, apply f and pop the result */
+static void
+setunary(void (*f)(void))
+{
+	int i;
+
+	begbody();
+	for (i = 0; i < NSEQ; i++) {
+		opval(constpush, 7.0);
+		op(f);
+		op(oprpop);
+	}
+	endbody();
+}
+
+static void setadd(void)    { setbinary(add); }
+static void setsub(void)    { setbinary(sub); }
+static void setmul(void)    { setbinary(mul); }
+static void setdivd(void)   { setbinary(divd); }
+static void setmod(void)    { setbinary(mod); }
+static void setpower(void)  { setbinary(power); }
+static void setlt(void)     { setbinary(lt); }
+static void seteq(void)     { setbinary(eq); }
+static void setnegate(void) { setunary(negate); }
+static void setnot(void)    { setunary(not); }
+
+/* evaluate a variable and pop it */
+static void
+seteval(Name *n)
+{
+	int i;
+
+	begbody();
+	for (i = 0; i < NSEQ; i++) {
+		opname(eval, n);
+		op(oprpop);
+	}
+	endbody();
+}
+
+static void setevaltop(void)  { seteval(top); }
+static void setevaldeep(void) { seteval(deep); }
+
+/* assign a constant to a variable */
+static void
+setassign(void)
+{
+	int i;
+
+	begbody();
+	for (i = 0; i < NSEQ; i++) {
+		opval(constpush, 1.0);
+		opname(assign, top);
+		op(oprpop);
+	}
+	endbody();
+}
+
+/* increment a variable */
+static void
+setpostinc(void)
+{
+	int i;
+
+	begbody();
+	for (i = 0; i < NSEQ; i++) {
+		opname(postinc, top);
+		op(oprpop);
+	}
+	endbody();
+}
+
+/* assign a string literal to a variable, which moves it and frees the old one */
+static void
+setassignstr(void)
+{
+	int i;
+
+	begbody();
+	for (i = 0; i < NSEQ; i++) {
+		opstr(strpush, lit);
+		opname(assign, svar);
+		op(oprpop);
+	}
+	endbody();
+}
+
+/* assign a new string made by sprintf() to a variable */
+static void
+setsprintf(void)
+{
+	int i;
+
+	begbody();
+	for (i = 0; i < NSEQ; i++) {
+		opstr(strpush, fmt);
+		opval(constpush, 3.25);
+		opcall(bltin, sprintfname, 2);
+		opname(assign, svar);
+		op(oprpop);
+	}
+	endbody();
+}
+
+/* call a built-in function */
+static void
+setbltin(void)
+{
+	int i;
+
+	begbody();
+	for (i = 0; i < NSEQ; i++) {
+		opval(constpush, 2.0);
+		opcall(bltin, sqrtname, 1);
+		op(oprpop);
+	}
+	endbody();
+}
+
+/* call f(a) { return a } */
+static void
+setcall(void)
+{
+	int i;
+
+	begbody();
+	for (i = 0; i < NSEQ; i++) {
+		opval(constpush, 2.0);
+		opcall(call, func, 1);
+		op(oprpop);
+	}
+	endbody();
+}
+
+/* look up the first keyword, under every other name */
+static void
+runlookupname(long n)
+{
+	while (n-- > 0)
+		if (lookupname("func") == NULL)
+			errx(1, "func: name not found");
+}
+
+/* generate n instructions */
+static void
+runcode(long n)
+{
+	prepare();
+	while (n-- > 0)
+		code((Inst){.type = VAL, .u.val = 1.0});
+}
+
+/* add n automatic strings, and free them as after a statement */
+static void
+runaddstr(long n)
+{
+	prepare();
+	while (n-- > 0)
+		(void)addstr(xstrdup("string"), 0);
+	prepare();
+}
+
+static Bench benches[] = {
+	{"pushpop",    setpushpop,   runbody, NULL,       0, 0},
+	{"operands",   setoperands,  runbody, NULL,       0, 0},
+	{"add",        setadd,       runbody, "operands", 0, 0},
+	{"sub",        setsub,       runbody, "operands", 0, 0},
+	{"mul",        setmul,       runbody, "operands", 0, 0},
+	{"divd",       setdivd,      runbody, "operands", 0, 0},
+	{"mod",        setmod,       runbody, "operands", 0, 0},
+	{"power",      setpower,     runbody, "operands", 0, 0},
+	{"lt",         setlt,        runbody, "operands", 0, 0},
+	{"eq",         seteq,        runbody, "operands", 0, 0},
+	{"negate",     setnegate,    runbody, "pushpop",  0, 0},
+	{"not",        setnot,       runbody, "pushpop",  0, 0},
+	{"eval",       setevaltop,   runbody, "pushpop",  0, 0},
+	{"evaldeep",   setevaldeep,  runbody, "pushpop",  0, 0},
+	{"assign",     setassign,    runbody, "pushpop",  0, 0},
+	{"postinc",    setpostinc,   runbody, NULL,       0, 0},
+	{"assignstr",  setassignstr, runbody, NULL,       0, 0},
+	{"sprintf",    setsprintf,   runbody, "assignstr", 0, 0},
+	{"bltin",      setbltin,     runbody, "pushpop",  0, 0},
+	{"call",       setcall,      runbody, "pushpop",  0, 0},
+	{"lookupname", NULL,         runlookupname, NULL, 0, 0},
+	{"code",       NULL,         runcode, NULL,       0, 0},
+	{"addstr",     NULL,         runaddstr, NULL,     0, 0},
+	{NULL,         NULL,         NULL,    NULL,       0, 0}
+};
+
+/* find benchmark by name */
+static Bench *
+lookupbench(const char *s)
+{
+	Bench *b;
+
+	for (b = benches; b->name; b++)
+		if (strcmp(b->name, s) == 0)
+			return b;
+	return NULL;
+}
+
+/* time n operations of b, in seconds */
+static double
+sample(Bench *b, long n)
+{
+	double t;
+
+	t = now();
+	b->run(n);
+	return now() - t;
+}
+
+/* calibrate, warm up and sample b, and print its time per operation */
+static void
+measure(Bench *b)
+{
+	double t[MAXSAMPLES], dev[MAXSAMPLES];
+	double med, mad, sum;
+	Bench *base = NULL;
+	long n;
+	int i, kept;
+
+	if (b->done)
+		return;
+	if (b->base && (base = lookupbench(b->base)) != NULL)
+		measure(base);
+	current = b->name;
+	if (b->setup)
+		b->setup();
+
+	/* calibrate the number of operations of a sample, which also warms up */
+	for (n = NSEQ; sample(b, n) < MINTIME; n *= 2)
+		;
+	(void)sample(b, n);
+
+	for (i = 0; i < nsamples; i++)
+		t[i] = sample(b, n) / n * 1e9;
+	qsort(t, nsamples, sizeof *t, cmpdouble);
+	med = t[nsamples / 2];
+	for (i = 0; i < nsamples; i++)
+		dev[i] = t[i] > med ? t[i] - med : med - t[i];
+	qsort(dev, nsamples, sizeof *dev, cmpdouble);
+	mad = dev[nsamples / 2] * 1.4826;
+	for (sum = 0.0, kept = i = 0; i < nsamples; i++) {
+		if (t[i] - med > 3 * mad || med - t[i] > 3 * mad)
+			continue;
+		sum += t[i];
+		kept++;
+	}
+	b->ns = sum / kept;
+	b->done = 1;
+
+	printf("%-12s %9.2f ns/op  min %9.2f  samples %3d/%d",
+	       b->name, b->ns, t[0], kept, nsamples);
+	if (base)
+		printf("  net %9.2f ns over %s", b->ns - base->ns, base->name);
+	printf("\n");
+	fflush(stdout);
+}
+
+/* micro */
+int
+main(int argc, char *argv[])
+{
+	static char *v[] = {"micro", NULL};
+	Bench *b;
+	int ch;
+
+	while ((ch = getopt(argc, argv, "ln:")) != -1) {
+		switch (ch) {
+		case 'l':
+			for (b = benches; b->name; b++)
+				printf("%s\n", b->name);
+			return 0;
+		case 'n':
+			if ((nsamples = atoi(optarg)) < 1 || nsamples > MAXSAMPLES)
+				usage();
+			break;
+		default:
+			usage();
+			break;
+		}
+	}
+	argc -= optind;
+	argv += optind;
+
+	if (newhoc() == NULL)
+		err(1, "malloc");
+	init(1, v);
+	if (setjmp(geterrors()->begin))
+		errx(1, "%s: benchmark failed", current ? current : "setup");
+	setglobals();
+	if (argc == 0) {
+		for (b = benches; b->name; b++)
+			measure(b);
+	} else {
+		for (; *argv; argv++) {
+			if ((b = lookupbench(*argv)) == NULL)
+				errx(1, "%s: unknown benchmark", *argv);
+			measure(b);
+		}
+	}
+	cleanup();
+	return 0;
+}
@@ -0,0 +1,29 @@
+#!/bin/sh
+#
+# parse.sh: measure how fast hoc lexes and parses a large script.
+#
+# usage: bench/parse.sh [megabytes]
+#
+# A script of about the given size (default 50) is generated with
+# bench/genscript.sh, and `hoc -n` (parse without executing) is run
+# on it with bench/timeit.
+# Build hoc and bench/timeit first (make hoc bench/timeit).
+
+HOC=${HOC:-./hoc}
+TIMEIT=${TIMEIT:-bench/timeit}
+MB=${1:-50}
+SCRIPT=${TMPDIR:-/tmp}/hocparse.$$.hoc
+
+trap 'rm -f "$SCRIPT"' EXIT INT TERM
+
+sh "${0%/*}/genscript.sh" "$MB" >"$SCRIPT" || exit 1
+
+bytes=$(wc -c <"$SCRIPT")
+"$TIMEIT" -q "$HOC" -n "$SCRIPT" | awk -v bytes="$bytes" '{
+	for (i = 1; i <= NF; i++) {
+		split($i, kv, "=")
+		if (kv[1] == "median")
+			t = kv[2]
+	}
+	printf "%s bytes=%d mb_per_s=%.2f\n", $0, bytes, bytes / 1048576 / t
+}'
@@ -0,0 +1,69 @@
+#!/bin/sh
+#
+# run.sh: run the benchmark suite.
+#
+# usage: bench/run.sh [results]
+#
+# Each workload is run several times (RUNS, default 5) with
+# bench/timeit, and its median wall-clock time, peak resident set size
+# and executed instructions per second (counted once with `hoc -s`) are
+# printed.  The same numbers are written as tab-separated values, one
+# line per workload, to the results file (default
+# bench/results-COMMIT.tsv), so runs on different commits can be
+# compared.  Build hoc and bench/timeit first (make hoc bench/timeit);
+# `make bench` does both and runs this script.
+
+HOC=${HOC:-./hoc}
+TIMEIT=${TIMEIT:-bench/timeit}
+RUNS=${RUNS:-5}
+DIR=${0%/*}
+TMP=${TMPDIR:-/tmp}/hocbench.$$
+COMMIT=$(git rev-parse --short HEAD 2>/dev/null || echo unknown)
+RESULTS=${1:-$DIR/results-$COMMIT.tsv}
+
+trap 'rm -rf "$TMP"' EXIT
+trap 'exit 1' INT TERM
+
+mkdir -p "$TMP" || exit 1
+
+# generated inputs: numbers for getline.hoc, a large script to parse,
+# and a large script of loops with invariant expressions to optimize
+awk 'BEGIN { for (i = 1; i <= 200000; i++) print i * 7 % 100003 }' >"$TMP/numbers" || exit 1
+sh "$DIR/genscript.sh" 5 >"$TMP/parse.hoc" || exit 1
+awk 'BEGIN {
+	for (i = 0; i < 10; i++)
+		print "k" i " = " i
+	for (i = 0; i < 20000; i++)
+		printf "for (i = 0; i < 3; i++) s = s + (k%d * 2 + 1) * i\n", i % 10
+}' >"$TMP/loops.hoc" || exit 1
+
+# bench name input hoc-arguments ...
+bench() {
+	name=$1 input=$2
+	shift 2
+	insts=$("$HOC" -s "$@" <"$input" 2>&1 >/dev/null |
+	    awk '/^instructions executed:/ { print $3 }')
+	times=$("$TIMEIT" -q -n "$RUNS" -i "$input" "$HOC" "$@") || exit 1
+	echo "$times" | awk -v name="$name" -v insts="${insts:-0}" -v commit="$COMMIT" '{
+		for (i = 1; i <= NF; i++) {
+			split($i, kv, "=")
+			v[kv[1]] = kv[2]
+		}
+		ips = v["median"] > 0 ? insts / v["median"] : 0
+		printf "%-8s median=%.6f maxrss=%d insts=%d insts_per_s=%.0f\n",
+		    name, v["median"], v["maxrss"], insts, ips >"/dev/stderr"
+		printf "%s\t%s\t%d\t%.6f\t%.6f\t%.6f\t%d\t%d\t%.0f\n",
+		    commit, name, v["runs"], v["median"], v["min"], v["max"],
+		    v["maxrss"], insts, ips
+	}' >>"$RESULTS.tmp" || exit 1
+}
+
+printf "commit\tworkload\truns\tmedian\tmin\tmax\tmaxrss\tinsts\tinsts_per_s\n" >"$RESULTS.tmp" || exit 1
+bench loop    /dev/null      "$DIR/loop.hoc"
+bench fib     /dev/null      "$DIR/fib.hoc"
+bench sprintf /dev/null      "$DIR/sprintf.hoc"
+bench getline "$TMP/numbers" "$DIR/getline.hoc"
+bench printf  /dev/null      "$DIR/printf.hoc"
+bench parse   /dev/null      -n "$TMP/parse.hoc"
+bench optimize /dev/null     -O -w -n "$TMP/loops.hoc"
+mv "$RESULTS.tmp" "$RESULTS" && echo "results written to $RESULTS" >&2
@@ -0,0 +1,127 @@
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <err.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Run a command several times and report the median, minimum and
+ * maximum wall-clock time of the runs, and the peak resident set size
+ * of the largest run, in a single line of name=value pairs.  With -i,
+ * the standard input of each run is read from the given file.
+ */
+
+/* show usage */
+static void
+usage(void)
+{
+	(void)fprintf(stderr, "usage: timeit [-q] [-i input] [-n runs] command [arguments ...]\n");
+	exit(1);
+}
+
+/* compare doubles, for qsort(3) */
+static int
+cmpdouble(const void *a, const void *b)
+{
+	double x = *(const double *)a;
+	double y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+/* get wall-clock time in seconds */
+static double
+now(void)
+{
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) == -1)
+		err(1, "clock_gettime");
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* run command once; return its wall-clock time and update peak rss */
+static double
+run(char *argv[], const char *input, int quiet, long *maxrss)
+{
+	struct rusage ru;
+	double t;
+	pid_t pid;
+	int status, fd;
+
+	t = now();
+	switch (pid = fork()) {
+	case -1:
+		err(1, "fork");
+	case 0:
+		if (input) {
+			if ((fd = open(input, O_RDONLY)) == -1)
+				err(127, "%s", input);
+			(void)dup2(fd, STDIN_FILENO);
+			(void)close(fd);
+		}
+		if (quiet && (fd = open("/dev/null", O_WRONLY)) != -1) {
+			(void)dup2(fd, STDOUT_FILENO);
+			(void)close(fd);
+		}
+		execvp(argv[0], argv);
+		err(127, "%s", argv[0]);
+	}
+	if (wait4(pid, &status, 0, &ru) == -1)
+		err(1, "wait4");
+	t = now() - t;
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+		errx(1, "%s: command failed", argv[0]);
+	if (ru.ru_maxrss > *maxrss)
+		*maxrss = ru.ru_maxrss;
+	return t;
+}
+
+/* timeit */
+int
+main(int argc, char *argv[])
+{
+	double *t;
+	char *input = NULL;
+	long maxrss = 0;
+	int quiet = 0;
+	int i, n = 5;
+	int ch;
+
+	while ((ch = getopt(argc, argv, "+i:n:q")) != -1) {
+		switch (ch) {
+		case 'i':
+			input = optarg;
+			break;
+		case 'n':
+			if ((n = atoi(optarg)) < 1)
+				usage();
+			break;
+		case 'q':
+			quiet = 1;
+			break;
+		default:
+			usage();
+			break;
+		}
+	}
+	argc -= optind;
+	argv += optind;
+	if (argc == 0)
+		usage();
+
+	if ((t = malloc(n * sizeof *t)) == NULL)
+		err(1, "malloc");
+	for (i = 0; i < n; i++)
+		t[i] = run(argv, input, quiet, &maxrss);
+	qsort(t, n, sizeof *t, cmpdouble);
+	printf("runs=%d median=%.6f min=%.6f max=%.6f maxrss=%ld\n",
+	       n, (n % 2) ? t[n / 2] : (t[n / 2 - 1] + t[n / 2]) / 2,
+	       t[0], t[n - 1], maxrss);
+	free(t);
+	return 0;
+}
@@ -1,19 +1,87 @@
+#include <sys/resource.h>
 #include <ctype.h>
 #include <err.h>
 #include <errno.h>
+#include <limits.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <pthread.h>
 #include <time.h>
 #include "hoc.h"
 #include "code.h"
 #include "error.h"
 #include "gramm.h"
+#include "prof.h"
+#include "trace.h"
+#include "mat.h"
+#include "map.h"
+#include "pool.h"
+#include "sketch.h"
+#include "sort.h"
+#include "vec.h"
+
+extern int yylineno;            /* line being scanned */
+extern int toklineno;           /* line of the last token scanned */
+
+/*
+ * Safe point, at loop iterations, calls and between statements, where
+ * pending requests from signal handlers are served and the instruction
+ * budget is checked.  It is the only place where a running program can
+ * be stopped, so execute() does not test anything but the next opcode.
+ */
+#define SAFEPOINT() do { if (pending || hoc->stats.ninsts > hoc->maxinsts) safepoint(); } while (0)
+
+static void safepoint(void);
+static void _stats(void);
+static int ispure(Name *name, Inst *p, Inst *end);
+static int inlinelen(Name *name, Inst *p, Inst *end);
+static void optloops(Inst *p, Inst *end);
+static void dfree(String *str);
+static void arrfree(Array *a);
+static void freearrays(Array **arrays);
+static void waittasks(void);
 
 /* function declaration, needed for bltins[] */
 static double Random(void);
 static double Integer(double);
+static void _array(void);
+static void _map(void);
+static void _len(void);
+static void _sum(void);
+static void _mean(void);
+static void _min(void);
+static void _max(void);
+static void _dot(void);
+static void _count(void);
+static void _axpy(void);
+static void _vadd(void);
+static void _vmul(void);
+static void _vscale(void);
+static void _cumsum(void);
+static void _matrix(void);
+static void _rows(void);
+static void _cols(void);
+static void _matmul(void);
+static void _matvec(void);
+static void _transpose(void);
+static void _solve(void);
+static void _sort(void);
+static void _sortdesc(void);
+static void _argsort(void);
+static void _welford(void);
+static void _histogram(void);
+static void _kll(void);
+static void _add(void);
+static void _merge(void);
+static void _quantile(void);
+static void _variance(void);
+static void _bins(void);
+static void _wait(void);
 
 /* table of keywords */
 static struct {
@@ -34,6 +102,10 @@ static struct {
 	{"break",       BREAK},
 	{"continue",    CONTINUE},
 	{"return",      RETURN},
+	{"memo",        MEMO},
+	{"in",          IN},
+	{"parallel",    PARALLEL},
+	{"spawn",       SPAWN},
 	{NULL,          0}
 };
 
@@ -44,6 +116,7 @@ static struct {
 } oprs[] = {
 	{"oprpop",       oprpop},
 	{"eval",         eval},
+	{"cmdarg",       cmdarg},
 	{"add",          add},
 	{"sub",          sub},
 	{"mul",          mul},
@@ -89,78 +162,264 @@ static struct {
 	{"call",         call},
 	{"procret",      procret},
 	{"funcret",      funcret},
+	{"argpush",      argpush},
+	{"argret",       argret},
+	{"argpop",       argpop},
+	{"invpush",      invpush},
+	{"countcode",    countcode},
+	{"elempush",     elempush},
+	{"elemassign",   elemassign},
+	{"matindex",     matindex},
+	{"inmap",        inmap},
+	{"forincode",    forincode},
+	{"parforcode",   parforcode},
+	{"spawncode",    spawncode},
 	{NULL,           NULL}
 };
 
 /* table of bltins functions */
 static struct {
 	char *s;        /* name */
-	int n;          /* arity (-1 = constant) */
+	int n;          /* arity (-1 = constant, -2 = special) */
 	union {
+		void (*fs)(void);       /* special: works on the stack */
 		double d;
 		double (*f0)(void);
 		double (*f1)(double);
 		double (*f2)(double, double);
 	} u;
+	int vec;        /* function applied to arrays by vecmath() */
 } bltins[] = {
-	{"sprintf", -2, .u.d = 0.0},    /* special bltin function, must be first */
+	{"sprintf", -2, .u.fs = _sprintf},
+	{"stats",   -2, .u.fs = _stats},
 	{"pi",      -1, .u.d = M_PI},
 	{"e",       -1, .u.d = M_E},
 	{"gamma",   -1, .u.d = 0.57721566490153286060},
 	{"deg",     -1, .u.d = 57.29577951308232087680},
 	{"phi",     -1, .u.d = 1.61803398874989484820},
 	{"rand",    0,  .u.f0 = Random},
-	{"int",     1,  .u.f1 = Integer},
-	{"abs",     1,  .u.f1 = fabs},
-	{"atan",    1,  .u.f1 = atan},
-	{"cos",     1,  .u.f1 = cos},
-	{"exp",     1,  .u.f1 = exp},
-	{"log",     1,  .u.f1 = log},
-	{"log10",   1,  .u.f1 = log10},
-	{"sin",     1,  .u.f1 = sin},
-	{"sqrt",    1,  .u.f1 = sqrt},
+	{"int",     1,  .u.f1 = Integer, .vec = VECINT},
+	{"abs",     1,  .u.f1 = fabs,    .vec = VECABS},
+	{"atan",    1,  .u.f1 = atan,    .vec = VECATAN},
+	{"cos",     1,  .u.f1 = cos,     .vec = VECCOS},
+	{"exp",     1,  .u.f1 = exp,     .vec = VECEXP},
+	{"log",     1,  .u.f1 = log,     .vec = VECLOG},
+	{"log10",   1,  .u.f1 = log10,   .vec = VECLOG10},
+	{"sin",     1,  .u.f1 = sin,     .vec = VECSIN},
+	{"sqrt",    1,  .u.f1 = sqrt,    .vec = VECSQRT},
 	{"atan2",   2,  .u.f2 = atan2},
+	{"array",   -2, .u.fs = _array},
+	{"map",     -2, .u.fs = _map},
+	{"len",     -2, .u.fs = _len},
+	{"sum",     -2, .u.fs = _sum},
+	{"mean",    -2, .u.fs = _mean},
+	{"min",     -2, .u.fs = _min},
+	{"max",     -2, .u.fs = _max},
+	{"dot",     -2, .u.fs = _dot},
+	{"count",   -2, .u.fs = _count},
+	{"axpy",    -2, .u.fs = _axpy},
+	{"vadd",    -2, .u.fs = _vadd},
+	{"vmul",    -2, .u.fs = _vmul},
+	{"vscale",  -2, .u.fs = _vscale},
+	{"cumsum",  -2, .u.fs = _cumsum},
+	{"matrix",  -2, .u.fs = _matrix},
+	{"rows",    -2, .u.fs = _rows},
+	{"cols",    -2, .u.fs = _cols},
+	{"matmul",  -2, .u.fs = _matmul},
+	{"matvec",  -2, .u.fs = _matvec},
+	{"transpose", -2, .u.fs = _transpose},
+	{"solve",   -2, .u.fs = _solve},
+	{"sort",    -2, .u.fs = _sort},
+	{"sortdesc", -2, .u.fs = _sortdesc},
+	{"argsort", -2, .u.fs = _argsort},
+	{"welford", -2, .u.fs = _welford},
+	{"histogram", -2, .u.fs = _histogram},
+	{"kll",     -2, .u.fs = _kll},
+	{"add",     -2, .u.fs = _add},
+	{"merge",   -2, .u.fs = _merge},
+	{"quantile", -2, .u.fs = _quantile},
+	{"variance", -2, .u.fs = _variance},
+	{"bins",    -2, .u.fs = _bins},
+	{"wait",    -2, .u.fs = _wait},
 	{NULL,      0,  .u.d  = 0.0}
 };
 
-/* the datum stack */
-static Datum *stack = NULL;
-
-/* the machine */
-static struct {
-	Inst *head;
-	Inst *tail;
-	Inst *progp;
-	Inst *base;
-	Inst *pc;
-} prog = {NULL, NULL, NULL, NULL, NULL};
-
-/* the frame stack */
-static struct {
-	Frame *head;    /* beginning of frame stack */
-	Frame *tail;    /* current frame */
-	Frame *curr;    /* current frame */
-	Frame *next;    /* next available frame */
-} frame = {NULL, NULL, NULL, NULL};
-
-/* the string list */
-static String *autostrings = NULL;      /* strings freed automatically after execution */
-static String *finalstrings = NULL;     /* strings that should be manually freed */
-static String *argvstrings = NULL;      /* strings from command-line arguments */
-static int argc = 0;                    /* number of command-line arguments */
-
-/* the symbol table */
-static Symbol *global = NULL;           /* global symbol table */
-static Symbol *currsymtab;              /* current symbol table */
-
-/* the name table (for keywords and variable names) */
-static Name *nametab = NULL;
-
-/* flags */
-static int breaking, continuing, returning;
-
-/* previously printed value */
-static Datum prev = {.next = NULL, .isstr = 0, .u.val = 0.0};
+/* inlining of calls and optimization of loops */
+#define INLINEMAX 32            /* maximum size of inlined code */
+#define NOINLINE  INT_MIN       /* stack effect of what cannot be inlined */
+#define NEXPRS    64            /* maximum depth of expressions hoisted out of loops */
+
+/*
+ * The results of a memo function, in a direct-mapped table: a call
+ * whose arguments hash to a slot holding the same arguments returns the
+ * value in the slot; otherwise the function is run and its value
+ * replaces the slot.  Arguments are compared bit by bit.  The workers
+ * of a parallel loop share the tables under memolock.
+ */
+#define MEMOSIZE 4096           /* slots, a power of two */
+#define MEMOARGS 8              /* maximum number of parameters */
+
+typedef struct Memo {
+	double *slots;          /* MEMOSIZE slots of nparams arguments and a value */
+	unsigned char *used;
+	unsigned long long hits, misses;
+} Memo;
+
+static pthread_mutex_t memolock = PTHREAD_MUTEX_INITIALIZER;
+
+/* live and peak number and size of strings in a string list */
+typedef struct Strstats {
+	size_t n, bytes;
+	size_t maxn, maxbytes;
+} Strstats;
+
+/* a parallel loop being run, which its workers share */
+typedef struct Par {
+	Inst *body;
+	double lo;                      /* value of the loop variable at the first iteration */
+	Array **outs;                   /* arrays whose elements the body assigns */
+	size_t nouts;
+	struct Hoc **workers;
+} Par;
+
+/* a call of a function run by a task, an interpreter of its own, which its parent waits for */
+typedef struct Task {
+	Job job;
+	struct Hoc *hoc;
+	Name *name;                     /* function called */
+	Datum *args;                    /* its arguments, the last first */
+	int nargs;
+	Datum val;                      /* its value */
+	int failed;
+	Inst *errpc;                    /* where it failed */
+} Task;
+
+/*
+ * An interpreter: its machine, program, data and errors.  Each thread
+ * runs the interpreter made current by sethoc(), so interpreters made by
+ * different threads run at once without sharing anything but the parser
+ * (which libhoc.c runs under a lock) and the requests of signal handlers,
+ * which are made to the whole process.  A parallel loop is run by
+ * workers, interpreters that share the program and globals of the one
+ * running the loop, its parent, which waits for them (see parforcode()).
+ * A task runs a call spawned by its parent, which goes on meanwhile
+ * and gets its value by waiting for it (see spawncode()).
+ */
+typedef struct Hoc {
+	/* the datum stack */
+	Datum *stack;
+
+	/* the machine */
+	struct {
+		Inst *head;
+		Inst *tail;
+		Inst *progp;
+		Inst *base;
+		Inst *pc;
+	} prog;
+
+	/*
+	 * The line table holds the source line of each instruction in
+	 * program memory, in the order they were generated, apart from the
+	 * instructions themselves so execute() does not have to step over
+	 * them.  Each line is encoded as its difference from the previous
+	 * one, zigzag-encoded as a LEB128 number, so most instructions take
+	 * a single byte.  The table is cut back together with program
+	 * memory by prepare().
+	 */
+	struct {
+		unsigned char *buf;
+		size_t len, size;
+		size_t n;               /* number of instructions */
+		int line;               /* line of the last instruction */
+		size_t baselen, basen;  /* the same, at prog.base */
+		int baseline;
+		const char *file;       /* source file name */
+	} lines;
+
+	/* the statements of the whole program */
+	struct {
+		Stmt *head;
+		Stmt *tail;
+		Stmt *next;     /* next statement to be run */
+	} stmts;
+
+	/* the frame stack */
+	struct {
+		Frame *head;    /* beginning of frame stack */
+		Frame *tail;    /* current frame */
+		Frame *curr;    /* current frame */
+		Frame *next;    /* next available frame */
+	} frame;
+
+	/* the string list */
+	String *autostrings;            /* strings freed automatically after execution */
+	String *finalstrings;           /* strings that should be manually freed */
+	struct {
+		String **buf;
+		size_t n, size;
+	} literals;                     /* string literals of the code after prog.base */
+	Array *autoarrays;              /* arrays freed automatically after execution */
+	Array *finalarrays;             /* arrays assigned to variables */
+	String *argvstrings;            /* strings from command-line arguments */
+	int argc;                       /* number of command-line arguments */
+
+	/* the symbol table */
+	Symbol *global;                 /* global symbol table */
+	Symbol *currsymtab;             /* current symbol table */
+
+	/* the name table (for keywords and variable names) */
+	Name *nametab;
+
+	/* flags */
+	int breaking, continuing, returning;
+	int keepall;                    /* do not reuse program memory */
+	int counting;                   /* count instructions executed */
+	int memoall;                    /* memoize every pure function */
+	int optimizing;                 /* inline calls and optimize loops */
+	double loopepoch;               /* run of the innermost loop being run */
+	double nepochs;                 /* runs of loops so far */
+	unsigned long long maxinsts;    /* instruction budget */
+	int exceeded;                   /* a limit was exceeded */
+
+	/* interpreter statistics */
+	struct {
+		unsigned long long ninsts;      /* instructions executed, if counting */
+		size_t depth, maxdepth;         /* datum stack */
+		size_t frames, maxframes;       /* frame stack */
+		Strstats final, autos;
+		unsigned long long nmalloc;     /* calls to emalloc() and estrdup() */
+		unsigned long long mallocbytes;
+	} stats;
+
+	/* previously printed value */
+	Datum prev;
+
+	/* where calls from outside the machine return to */
+	Inst stop;
+
+	/* where errors jump to, and the last one */
+	Errors errors;
+
+	/* parallel code */
+	struct Hoc *parent;             /* the interpreter a worker runs parallel code for, or NULL */
+	struct Par *par;                /* the parallel loop it runs */
+	Symbol *parvar;                 /* its own loop variable */
+	struct Task **tasks;            /* tasks spawned, by handle - 1 - taskbase, or NULL once waited for */
+	size_t ntasks;
+	size_t maxtasks;
+	size_t taskbase;                /* tasks spawned before those in tasks, all waited for */
+	size_t nrunning;                /* tasks not waited for yet */
+	int nolines;                    /* the line table may change meanwhile, so errors get no line */
+} Hoc;
+
+static _Thread_local Hoc *hoc;          /* the interpreter run by this thread */
+
+/* requests of signal handlers */
+static volatile sig_atomic_t pending;   /* a request waits for a safe point */
+static volatile sig_atomic_t statsreq;  /* statistics were requested */
+static volatile sig_atomic_t intreq;    /* interrupt was requested */
+static volatile sig_atomic_t timeoutreq;        /* time limit expired */
 
 /* check return from malloc */
 static void *
@@ -170,9 +429,33 @@ emalloc(size_t n)
 
 	if ((p = malloc(n)) == NULL)
 		yyerror("out of memory");
+	hoc->stats.nmalloc++;
+	hoc->stats.mallocbytes += n;
 	return p;
 }
 
+/* account for string being added (n = 1) to or removed (n = -1) from its list */
+static void
+countstr(String *str, int n)
+{
+	Strstats *st;
+	size_t len;
+
+	if (str->orig == FINAL)
+		st = &hoc->stats.final;
+	else if (str->orig == AUTO)
+		st = &hoc->stats.autos;
+	else
+		return;
+	len = strlen(str->s) + 1;
+	st->n += n;
+	st->bytes += n * len;
+	if (st->n > st->maxn)
+		st->maxn = st->n;
+	if (st->bytes > st->maxbytes)
+		st->maxbytes = st->bytes;
+}
+
 /* free string list */
 static void
 freestrings(String **strings)
@@ -185,6 +468,7 @@ freestrings(String **strings)
 		p = p->next;
 		if (DEBUG)
 			fprintf(stderr, "FREED STRING: %s\n", tmp->s);
+		countstr(tmp, -1);
 		free(tmp->s);
 		free(tmp);
 	}
@@ -195,7 +479,7 @@ freestrings(String **strings)
 static void
 freestack(void)
 {
-	Datum *tmp, *p = stack;
+	Datum *tmp, *p = hoc->stack;
 
 	while(p) {
 		tmp = p;
@@ -204,7 +488,8 @@ freestack(void)
 			fprintf(stderr, "FREED STACK ENTRY (THIS SHOULD NOT OCCUR)\n");
 		free(tmp);
 	}
-	stack = NULL;
+	hoc->stack = NULL;
+	hoc->stats.depth = 0;
 }
 
 /* free symbol table */
@@ -219,11 +504,25 @@ freesymtab(Symbol **symtab)
 		p = p->next;
 		if (DEBUG)
 			fprintf(stderr, "FREED SYMBOL: %s\n", tmp->name);
+		if (tmp->isarr)
+			arrfree(tmp->u.arr);
 		free(tmp);
 	}
 	*symtab = NULL;
 }
 
+/* free cached results of function */
+static void
+freememo(Function *fun)
+{
+	if (fun->cache == NULL)
+		return;
+	free(fun->cache->slots);
+	free(fun->cache->used);
+	free(fun->cache);
+	fun->cache = NULL;
+}
+
 /* free name table */
 static void
 freenametab(Name **nametab)
@@ -236,8 +535,11 @@ freenametab(Name **nametab)
 		p = p->next;
 		if (DEBUG)
 			fprintf(stderr, "FREED NAME: %s\n", tmp->s);
-		if (tmp->type == FUNCTION || tmp->type == PROCEDURE)
+		if ((tmp->type == FUNCTION || tmp->type == PROCEDURE) && tmp->u.fun) {
 			freenametab(&(tmp->u.fun->params));
+			freememo(tmp->u.fun);
+			free(tmp->u.fun);
+		}
 		free(tmp->s);
 		free(tmp);
 	}
@@ -252,6 +554,8 @@ estrdup(const char *s)
 
 	if ((p = strdup(s)) == NULL)
 		yyerror("out of memory");
+	hoc->stats.nmalloc++;
+	hoc->stats.mallocbytes += strlen(s) + 1;
 	return p;
 }
 
@@ -263,7 +567,7 @@ eallocsym(char *s)
 
 	sym = emalloc(sizeof *sym);
 	sym->name = s;
-	sym->isstr = 0;
+	sym->isstr = sym->isarr = 0;
 	sym->u.val = 0.0;
 	return sym;
 }
@@ -274,8 +578,8 @@ getnamearg(void)
 {
 	Name *name;
 
-	name = prog.pc->u.name;
-	prog.pc = prog.pc->next;
+	name = hoc->prog.pc->u.name;
+	hoc->prog.pc = hoc->prog.pc->next;
 	return name;
 }
 
@@ -285,8 +589,8 @@ getintarg(void)
 {
 	int n;
 
-	n = prog.pc->u.narg;
-	prog.pc = prog.pc->next;
+	n = hoc->prog.pc->u.narg;
+	hoc->prog.pc = hoc->prog.pc->next;
 	return n;
 }
 
@@ -296,8 +600,8 @@ getvalarg(void)
 {
 	double v;
 
-	v = prog.pc->u.val;
-	prog.pc = prog.pc->next;
+	v = hoc->prog.pc->u.val;
+	hoc->prog.pc = hoc->prog.pc->next;
 	return v;
 }
 
@@ -307,8 +611,8 @@ getstrarg(void)
 {
 	String *str;
 
-	str = prog.pc->u.str;
-	prog.pc = prog.pc->next;
+	str = hoc->prog.pc->u.str;
+	hoc->prog.pc = hoc->prog.pc->next;
 	return str;
 }
 
@@ -331,8 +635,8 @@ installglobalsym(char *s)
 	Symbol *sym;
 
 	sym = eallocsym(s);
-	sym->next = global;
-	global = sym;
+	sym->next = hoc->global;
+	hoc->global = sym;
 	return sym;
 }
 
@@ -350,11 +654,18 @@ installlocalsym(char *s, Symbol *local)
 /* find name in global name table */
 Name *
 lookupname(const char *s)
+{
+	return lookupnamelen(s, strlen(s));
+}
+
+/* find name in global name table; s needs not to be nul-terminated */
+Name *
+lookupnamelen(const char *s, size_t len)
 {
 	Name *name;
 
-	for (name = nametab; name; name = name->next)
-		if (strcmp(name->s, s) == 0)
+	for (name = hoc->nametab; name; name = name->next)
+		if (strncmp(name->s, s, len) == 0 && name->s[len] == '\0')
 			return name;
 	return NULL;
 }
@@ -368,8 +679,8 @@ installglobalname(const char *s, int t)
 	name = emalloc(sizeof *name);
 	name->s = estrdup(s);
 	name->type = t;
-	name->next = nametab;
-	nametab = name;
+	name->next = hoc->nametab;
+	hoc->nametab = name;
 	return name;
 }
 
@@ -398,10 +709,10 @@ addstr(char *s, int final)
 		yyerror("out of memory");
 	}
 	if (final) {
-		list = &finalstrings;
+		list = &hoc->finalstrings;
 		p->orig = FINAL;
 	} else {
-		list = &autostrings;
+		list = &hoc->autostrings;
 		p->orig = AUTO;
 	}
 	p->s = s;
@@ -411,11 +722,12 @@ addstr(char *s, int final)
 	p->prev = NULL;
 	p->count = 1;
 	*list = p;
+	countstr(p, 1);
 	return p;
 }
 
 /* return pointer to operation name */
-static char *
+char *
 oprname(void (*opr)(void))
 {
 	int i;
@@ -428,6 +740,57 @@ oprname(void (*opr)(void))
 	return "unknown";
 }
 
+/* return index of operation in the table of operations, or -1 */
+int
+oprindex(void (*opr)(void))
+{
+	int i;
+
+	for (i = 0; oprs[i].f; i++)
+		if (opr == oprs[i].f)
+			return i;
+	return -1;
+}
+
+/* return operation at index of the table of operations, or NULL */
+void
+(*oprfunc(int i))(void)
+{
+	if (i < 0 || (size_t)i >= sizeof oprs / sizeof oprs[0])
+		return NULL;
+	return oprs[i].f;
+}
+
+/* allocate an interpreter and make it the current one of this thread; return NULL if out of memory */
+Hoc *
+newhoc(void)
+{
+	Hoc *h;
+
+	if ((h = calloc(1, sizeof *h)) == NULL)
+		return NULL;
+	h->lines.file = "-";
+	h->maxinsts = ULLONG_MAX;
+	h->stop.type = OPR;
+	h->stop.u.opr = NULL;
+	hoc = h;
+	return h;
+}
+
+/* make h the current interpreter of this thread */
+void
+sethoc(Hoc *h)
+{
+	hoc = h;
+}
+
+/* get the errors of the current interpreter */
+Errors *
+geterrors(void)
+{
+	return &hoc->errors;
+}
+
 /* initialize machine */
 void
 init(int c, char *v[])
@@ -435,23 +798,27 @@ init(int c, char *v[])
 	Name *name;
 	int i;
 
-	argc = c;
-	argvstrings = emalloc(argc * sizeof *argvstrings);
-	for (i = 0; i < argc; i++) {
-		argvstrings[i].s = v[i];
-		argvstrings[i].orig = ARGV;
+	hoc->argc = c;
+	hoc->argvstrings = emalloc(hoc->argc * sizeof *hoc->argvstrings);
+	for (i = 0; i < hoc->argc; i++) {
+		hoc->argvstrings[i].s = v[i];
+		hoc->argvstrings[i].orig = ARGV;
 	}
 
 	/* initialize program memory */
-	prog.head = emalloc(sizeof *prog.head);
-	prog.head->next = NULL;
-	prog.base = prog.progp = prog.head;
+	if (hoc->argc > 0)
+		hoc->lines.file = v[0];
+	hoc->prog.head = emalloc(sizeof *hoc->prog.head);
+	hoc->prog.head->next = NULL;
+	hoc->prog.base = hoc->prog.progp = hoc->prog.head;
 
 	/* initialize frame stack */
-	frame.head = emalloc(sizeof *frame.head);
-	frame.head->next = NULL;
-	frame.head->prev = NULL;
-	frame.next = frame.head;
+	hoc->frame.head = emalloc(sizeof *hoc->frame.head);
+	hoc->frame.head->next = NULL;
+	hoc->frame.head->prev = NULL;
+	hoc->frame.head->name = NULL;
+	hoc->frame.head->local = NULL;
+	hoc->frame.next = hoc->frame.head;
 
 	/* initialize random function */
 	srand(time(NULL));
@@ -471,39 +838,396 @@ prepare(void)
 {
 	Frame *fp;
 
-	continuing = breaking = returning = 0;
-	prog.tail = NULL;
-	prog.progp = prog.base;
-	currsymtab = NULL;
-	for (fp = frame.head; fp && fp != frame.tail; fp = fp->next)
+	hoc->continuing = hoc->breaking = hoc->returning = 0;
+	if (intreq)             /* tested first, so interpreters of other threads never write it */
+		intreq = 0;
+	hoc->loopepoch = 0.0;
+	if (hoc->keepall)
+		keepcode();
+	hoc->prog.tail = NULL;
+	hoc->prog.progp = hoc->prog.base;
+	hoc->prog.pc = NULL;
+	hoc->lines.len = hoc->lines.baselen;
+	hoc->lines.n = hoc->lines.basen;
+	hoc->lines.line = hoc->lines.baseline;
+	hoc->currsymtab = NULL;
+	for (fp = hoc->frame.head; fp && fp != hoc->frame.tail; fp = fp->next)
 		if (fp->local)
 			freesymtab(&(fp->local));
-	frame.tail = frame.next = frame.head;
-	frame.curr = NULL;
-	freestrings(&autostrings);
+	hoc->frame.tail = hoc->frame.next = hoc->frame.head;
+	hoc->frame.curr = NULL;
+	hoc->stats.frames = 0;
+	freearrays(&hoc->autoarrays);
+	freestrings(&hoc->autostrings);
+	while (hoc->literals.n > 0)
+		dfree(hoc->literals.buf[--hoc->literals.n]);
 	freestack();
+	profreset();
+	tracereset();
 }
 
-/* clean up machine */
+/* clean up machine, and free the current interpreter */
 void
 cleanup(void)
 {
-	freesymtab(&global);
-	freestrings(&autostrings);
-	freestrings(&finalstrings);
-	freenametab(&nametab);
+	Stmt *tmp;
+	Frame *fp;
+	Inst *ip;
+
+	waittasks();
+	while (hoc->frame.head) {
+		fp = hoc->frame.head;
+		hoc->frame.head = fp->next;
+		if (fp->local)
+			freesymtab(&(fp->local));
+		free(fp);
+	}
+	while (hoc->stmts.head) {
+		tmp = hoc->stmts.head;
+		hoc->stmts.head = hoc->stmts.head->next;
+		free(tmp);
+	}
+	hoc->stmts.tail = hoc->stmts.next = NULL;
+	freesymtab(&hoc->global);
+	freearrays(&hoc->autoarrays);
+	freearrays(&hoc->finalarrays);
+	freestrings(&hoc->autostrings);
+	freestrings(&hoc->finalstrings);
+	freenametab(&hoc->nametab);
 	freestack();
+	while (hoc->prog.head) {
+		ip = hoc->prog.head;
+		hoc->prog.head = ip->next;
+		free(ip);
+	}
+	free(hoc->lines.buf);
+	free(hoc->literals.buf);
+	free(hoc->argvstrings);
+	free(hoc);
+	hoc = NULL;
+}
+
+/* append line of the instruction just generated to the line table */
+static void
+addline(int line)
+{
+	unsigned int u;
+	int d;
+
+	d = line - hoc->lines.line;
+	u = d < 0 ? ~((unsigned)d << 1) : (unsigned)d << 1;
+	do {
+		if (hoc->lines.len == hoc->lines.size) {
+			hoc->lines.size = hoc->lines.size ? hoc->lines.size * 2 : BUFSIZ;
+			if ((hoc->lines.buf = realloc(hoc->lines.buf, hoc->lines.size)) == NULL)
+				yyerror("out of memory");
+		}
+		hoc->lines.buf[hoc->lines.len++] = (u & 0x7F) | (u > 0x7F ? 0x80 : 0);
+		u >>= 7;
+	} while (u);
+	hoc->lines.line = line;
+	hoc->lines.n++;
+}
+
+/* decode line following line from the line table at p; return next p */
+static const unsigned char *
+nextline(const unsigned char *p, int *line)
+{
+	unsigned int u, shift;
+
+	for (u = 0, shift = 0; *p & 0x80; p++, shift += 7)
+		u |= (unsigned)(*p & 0x7F) << shift;
+	u |= (unsigned)*p++ << shift;
+	*line += (u & 1) ? (int)~(u >> 1) : (int)(u >> 1);
+	return p;
+}
+
+/* call fn with each instruction, from the beginning of program memory or from prog.base, and its line */
+void
+maplines(int whole, void (*fn)(Inst *, int))
+{
+	const unsigned char *lp;
+	Inst *p;
+	int line;
+
+	if (whole) {
+		p = hoc->prog.head;
+		lp = hoc->lines.buf;
+		line = 0;
+	} else {
+		p = hoc->prog.base;
+		lp = hoc->lines.buf + hoc->lines.baselen;
+		line = hoc->lines.baseline;
+	}
+	for (; p != hoc->prog.progp; p = p->next) {
+		lp = nextline(lp, &line);
+		fn(p, line);
+	}
+}
+
+/* get line of the instruction executed before pc, or 0 */
+int
+pcline(Inst *pc)
+{
+	const unsigned char *lp;
+	Inst *p;
+	int line;
+
+	line = 0;
+	lp = hoc->lines.buf;
+	for (p = hoc->prog.head; p != hoc->prog.progp && p->next != pc; p = p->next)
+		lp = nextline(lp, &line);
+	if (p == hoc->prog.progp)
+		return 0;
+	(void)nextline(lp, &line);
+	return line;
+}
+
+/* a position in the line table: instruction p, its line, and where the line of the next one is */
+typedef struct Linepos {
+	Inst *p;
+	int line;
+	size_t off;
+} Linepos;
+
+/* set pos at instruction p, whose line is encoded at off from line */
+static void
+lineat(Linepos *pos, Inst *p, size_t off, int line)
+{
+	pos->p = p;
+	pos->line = line;
+	pos->off = nextline(hoc->lines.buf + off, &pos->line) - hoc->lines.buf;
+}
+
+/* move pos forward to instruction p, or to the last instruction with a line */
+static void
+lineseek(Linepos *pos, Inst *p)
+{
+	while (pos->p != p && pos->p->next != hoc->prog.progp) {
+		pos->p = pos->p->next;
+		pos->off = nextline(hoc->lines.buf + pos->off, &pos->line) - hoc->lines.buf;
+	}
+}
+
+/* get line of the code being run, or of the input being parsed, or 0 for a call from outside the machine or a task */
+int
+lineno(void)
+{
+	int line;
+
+	if (hoc->nolines || hoc->prog.pc == &hoc->stop)
+		return 0;
+	if (hoc->prog.pc && (line = pcline(hoc->prog.pc)) > 0)
+		return line;
+	return yylineno;
+}
+
+/* get line of the instruction at prog.base */
+static int
+baseline(void)
+{
+	int line;
+
+	line = hoc->lines.baseline;
+	if (hoc->lines.n > hoc->lines.basen)
+		(void)nextline(hoc->lines.buf + hoc->lines.baselen, &line);
+	return line;
+}
+
+/* get array of the lines of the instructions in program memory */
+int *
+getlines(void)
+{
+	const unsigned char *lp;
+	size_t i;
+	int *v, line;
+
+	v = emalloc((hoc->lines.n + 1) * sizeof *v);
+	for (lp = hoc->lines.buf, line = 0, i = 0; i < hoc->lines.n; i++) {
+		lp = nextline(lp, &line);
+		v[i] = line;
+	}
+	return v;
+}
+
+/* get source file name */
+const char *
+getfilename(void)
+{
+	return hoc->lines.file;
+}
+
+/* set source file name */
+void
+setfilename(const char *file)
+{
+	hoc->lines.file = file;
+}
+
+/* get the line table, and its length in bytes */
+const unsigned char *
+getlinetab(size_t *len)
+{
+	*len = hoc->lines.len;
+	return hoc->lines.buf;
+}
+
+/* replace the line table for the n instructions in program memory; return -1 if it is corrupt */
+int
+setlinetab(const unsigned char *buf, size_t len, size_t n)
+{
+	const unsigned char *p, *end;
+	size_t i;
+
+	end = buf + len;
+	for (p = buf, i = 0; i < n; i++) {
+		while (p < end && *p & 0x80)
+			p++;
+		if (p++ >= end)
+			return -1;
+	}
+	if (p != end)
+		return -1;
+	if (len > hoc->lines.size) {
+		hoc->lines.size = len;
+		if ((hoc->lines.buf = realloc(hoc->lines.buf, hoc->lines.size)) == NULL)
+			yyerror("out of memory");
+	}
+	memcpy(hoc->lines.buf, buf, len);
+	hoc->lines.len = len;
+	hoc->lines.n = n;
+	hoc->lines.line = 0;
+	for (p = hoc->lines.buf, i = 0; i < n; i++)
+		p = nextline(p, &hoc->lines.line);
+	return 0;
+}
+
+/* print interpreter statistics into fp */
+void
+printstats(FILE *fp)
+{
+	struct rusage ru;
+	Symbol *sym;
+	Name *name;
+	Inst *p;
+	size_t nused, nalloc, nsyms, nnames;
+
+	for (nused = 0, p = hoc->prog.head; p && p != hoc->prog.progp; p = p->next)
+		nused++;
+	for (nalloc = nused; p; p = p->next)
+		nalloc++;
+	for (nsyms = 0, sym = hoc->global; sym; sym = sym->next)
+		nsyms++;
+	for (nnames = 0, name = hoc->nametab; name; name = name->next)
+		nnames++;
+	if (hoc->counting)
+		fprintf(fp, "instructions executed: %llu\n", hoc->stats.ninsts);
+	fprintf(fp, "program memory: %zu instructions (%zu allocated, %zu bytes)\n",
+	        nused, nalloc, nalloc * sizeof *p);
+	fprintf(fp, "line table: %zu bytes\n", hoc->lines.len);
+	fprintf(fp, "datum stack: %zu (peak %zu)\n", hoc->stats.depth, hoc->stats.maxdepth);
+	fprintf(fp, "frame stack: %zu (peak %zu)\n", hoc->stats.frames, hoc->stats.maxframes);
+	fprintf(fp, "final strings: %zu, %zu bytes (peak %zu, %zu bytes)\n",
+	        hoc->stats.final.n, hoc->stats.final.bytes, hoc->stats.final.maxn, hoc->stats.final.maxbytes);
+	fprintf(fp, "auto strings: %zu, %zu bytes (peak %zu, %zu bytes)\n",
+	        hoc->stats.autos.n, hoc->stats.autos.bytes, hoc->stats.autos.maxn, hoc->stats.autos.maxbytes);
+	fprintf(fp, "symbols: %zu global, %zu names\n", nsyms, nnames);
+	fprintf(fp, "array kernels: %s\n", veckernels());
+	for (name = hoc->nametab; name; name = name->next)
+		if (name->type == FUNCTION && name->u.fun->cache)
+			fprintf(fp, "memo %s: %llu hits, %llu misses\n", name->s,
+			        name->u.fun->cache->hits, name->u.fun->cache->misses);
+	fprintf(fp, "allocations: %llu, %llu bytes\n", hoc->stats.nmalloc, hoc->stats.mallocbytes);
+	if (getrusage(RUSAGE_SELF, &ru) == 0)
+		fprintf(fp, "max resident set size: %ld KiB\n", ru.ru_maxrss);
+}
+
+/* count instructions executed, for the statistics */
+void
+countinsts(void)
+{
+	hoc->counting = 1;
+}
+
+/* ask for statistics to be printed at the next safe point; called by signal handlers */
+void
+requeststats(void)
+{
+	statsreq = 1;
+	pending = 1;
+}
+
+/* ask for the running program to be interrupted at the next safe point; called by signal handlers */
+void
+requestint(void)
+{
+	intreq = 1;
+	pending = 1;
+}
+
+/* stop the program at the next safe point, for it ran out of time; called by signal handlers */
+void
+requesttimeout(void)
+{
+	timeoutreq = 1;
+	pending = 1;
+}
+
+/* stop the program at the first safe point after n instructions */
+void
+setmaxinsts(unsigned long long n)
+{
+	hoc->maxinsts = n;
+	hoc->counting = 1;
+}
+
+/* tell whether the program was stopped for exceeding a limit */
+int
+limitexceeded(void)
+{
+	return hoc->exceeded;
+}
+
+/* serve requests made by signal handlers, and check the instruction budget; workers leave the requests to their parent */
+static void
+safepoint(void)
+{
+	if (!hoc->parent)
+		pending = 0;
+	if (statsreq && !hoc->parent) {
+		statsreq = 0;
+		fflush(stdout);
+		printstats(stderr);
+	}
+	if (timeoutreq) {
+		hoc->exceeded = 1;
+		yyerror("time limit exceeded");
+	}
+	if (hoc->stats.ninsts > hoc->maxinsts) {
+		hoc->exceeded = 1;
+		yyerror("instruction limit exceeded");
+	}
+	if (intreq) {
+		if (!hoc->parent)
+			intreq = 0;
+		yyerror("interrupted");
+	}
 }
 
 /* debug the machine */
 void
 debug(void)
 {
+	const unsigned char *lp;
 	Inst *p;
 	size_t n;
+	int line;
 
-	for (n = 0, p = prog.base; p && p != prog.progp; n++, p = p->next) {
-		fprintf(stderr, "CODE %03zu: ", n);
+	lp = hoc->lines.buf + hoc->lines.baselen;
+	line = hoc->lines.baseline;
+	for (n = 0, p = hoc->prog.base; p && p != hoc->prog.progp; n++, p = p->next) {
+		lp = nextline(lp, &line);
+		fprintf(stderr, "CODE %03zu: LINE %-4d ", n, line);
 		switch (p->type) {
 		case NARG:
 			fprintf(stderr, "NARG %d", p->u.narg);
@@ -537,41 +1261,197 @@ execute(Inst *ip)
 {
 	Inst *opc;
 
-	if (ip == NULL)
-		prog.pc = prog.base;
-	else
-		prog.pc = ip;
-	while (prog.pc->u.opr && !breaking && !continuing) {
-		opc = prog.pc;
-		prog.pc = prog.pc->next;
+	if (ip == NULL) {
+		/* a statement just parsed */
+		if (tracing)
+			tracebegin("statement", "statement", baseline());
+		execute(hoc->prog.base);
+		if (tracing)
+			traceend();
+		SAFEPOINT();
+		return;
+	}
+	hoc->prog.pc = ip;
+	if (profiling) {
+		while (hoc->prog.pc->u.opr && !hoc->breaking && !hoc->continuing && !hoc->returning) {
+			opc = hoc->prog.pc;
+			hoc->prog.pc = hoc->prog.pc->next;
+			hoc->stats.ninsts++;
+			profopr(opc);
+			opc->u.opr();
+			profoprend();
+		}
+		return;
+	}
+	if (hoc->counting) {
+		while (hoc->prog.pc->u.opr && !hoc->breaking && !hoc->continuing && !hoc->returning) {
+			opc = hoc->prog.pc;
+			hoc->prog.pc = hoc->prog.pc->next;
+			hoc->stats.ninsts++;
+			opc->u.opr();
+		}
+		return;
+	}
+	while (hoc->prog.pc->u.opr && !hoc->breaking && !hoc->continuing && !hoc->returning) {
+		opc = hoc->prog.pc;
+		hoc->prog.pc = hoc->prog.pc->next;
 		opc->u.opr();
 	}
 }
 
+/* append the statement just parsed to the whole program */
+void
+addstmt(void)
+{
+	if (DEBUG)
+		debug();
+	appendstmt(hoc->prog.base, baseline());      /* start of code */
+	keepcode();                     /* next code starts here, its literals stay */
+}
+
+/* append statement starting at code, at line, to the whole program */
+void
+appendstmt(Inst *code, int line)
+{
+	Stmt *stmt;
+
+	stmt = emalloc(sizeof *stmt);
+	stmt->code = code;
+	stmt->line = line;
+	stmt->next = NULL;
+	if (hoc->stmts.tail)
+		hoc->stmts.tail->next = stmt;
+	else
+		hoc->stmts.head = stmt;
+	hoc->stmts.tail = stmt;
+	if (!hoc->stmts.next)
+		hoc->stmts.next = stmt;
+}
+
+/* get the statements of the whole program */
+Stmt *
+getstmts(void)
+{
+	return hoc->stmts.head;
+}
+
+/* run the statements of the whole program not run yet */
+void
+run(void)
+{
+	Stmt *stmt;
+
+	while ((stmt = hoc->stmts.next) != NULL) {
+		hoc->stmts.next = stmt->next;
+		if (tracing) {
+			tracebegin("statement", "statement", stmt->line);
+			execute(stmt->code);
+			traceend();
+		} else {
+			execute(stmt->code);
+		}
+		freearrays(&hoc->autoarrays);
+		freestrings(&hoc->autostrings);
+		SAFEPOINT();
+	}
+}
+
 /* install one instruction or operand */
 Inst *
 code(Inst inst)
 {
 	Inst *ip;
 
-	ip = prog.progp->next;
-	prog.tail = prog.progp;
-	*prog.tail = inst;
-	prog.tail->next = ip;
-	if (!prog.tail->next) {
+	ip = hoc->prog.progp->next;
+	hoc->prog.tail = hoc->prog.progp;
+	*hoc->prog.tail = inst;
+	hoc->prog.tail->next = ip;
+	if (!hoc->prog.tail->next) {
 		ip = emalloc(sizeof *ip);
 		ip->next = NULL;
-		prog.tail->next = ip;
+		hoc->prog.tail->next = ip;
+	}
+	hoc->prog.progp = hoc->prog.tail->next;
+	addline(toklineno);
+	return hoc->prog.tail;
+}
+
+/*
+ * install a string literal in the next memory location; the code holds
+ * a reference to it, dropped by prepare() when it reuses the memory of
+ * the code, unless keepcode() keeps the code first.
+ */
+Inst *
+strcode(String *str)
+{
+	String **v;
+	size_t n;
+
+	movstr(str);
+	if (hoc->literals.n == hoc->literals.size) {
+		n = hoc->literals.size ? 2 * hoc->literals.size : 16;
+		if ((v = realloc(hoc->literals.buf, n * sizeof *v)) == NULL) {
+			dfree(str);
+			yyerror("out of memory");
+		}
+		hoc->literals.buf = v;
+		hoc->literals.size = n;
 	}
-	prog.progp = prog.tail->next;
-	return prog.tail;
+	hoc->literals.buf[hoc->literals.n++] = str;
+	return code((Inst){.type = STR, .u.str = str});
 }
 
 /* get prog.progp */
 Inst *
 getprogp(void)
 {
-	return prog.progp;
+	return hoc->prog.progp;
+}
+
+/* get beginning of program memory */
+Inst *
+getproghead(void)
+{
+	return hoc->prog.head;
+}
+
+/* get frame of the function being executed, or NULL at top level */
+Frame *
+getframe(void)
+{
+	return hoc ? hoc->frame.curr : NULL;
+}
+
+/* get program counter */
+Inst *
+getpc(void)
+{
+	return hoc ? hoc->prog.pc : NULL;
+}
+
+/* protect code generated so far from being overwritten */
+void
+keepcode(void)
+{
+	hoc->prog.base = hoc->prog.progp;
+	hoc->literals.n = 0;            /* their literals are kept with them */
+	hoc->lines.baselen = hoc->lines.len;
+	hoc->lines.basen = hoc->lines.n;
+	hoc->lines.baseline = hoc->lines.line;
+}
+
+/* keep the code of every statement, so it can be mapped to lines when the program ends */
+void
+keepallcode(void)
+{
+	hoc->keepall = 1;
+}
+
+/* get global name table */
+Name *
+getnametab(void)
+{
+	return hoc->nametab;
 }
 
 /* push d onto stack */
@@ -582,8 +1462,10 @@ push(Datum d)
 
 	p = emalloc(sizeof *p);
 	*p = d;
-	p->next = stack;
-	stack = p;
+	p->next = hoc->stack;
+	hoc->stack = p;
+	if (++hoc->stats.depth > hoc->stats.maxdepth)
+		hoc->stats.maxdepth = hoc->stats.depth;
 }
 
 /* pop and return top element from stack */
@@ -592,11 +1474,12 @@ pop(void)
 {
 	Datum *tmp, d;
 
-	if (stack == NULL)
+	if (hoc->stack == NULL)
 		yyerror("stack underflow");
-	tmp = stack;
-	d = *stack;
-	stack = stack->next;
+	tmp = hoc->stack;
+	d = *hoc->stack;
+	hoc->stack = hoc->stack->next;
+	hoc->stats.depth--;
 	free(tmp);
 	return d;
 }
@@ -615,7 +1498,7 @@ constpush(void)
 	Datum d;
 
 	d.u.val = getvalarg();
-	d.isstr = 0;
+	d.isstr = d.isarr = 0;
 	push(d);
 }
 
@@ -623,7 +1506,7 @@ constpush(void)
 void
 prevpush(void)
 {
-	push(prev);
+	push(hoc->prev);
 }
 
 /* push string onto stack */
@@ -634,29 +1517,58 @@ strpush(void)
 
 	d.u.str = getstrarg();
 	d.isstr = 1;
+	d.isarr = 0;
 	push(d);
 }
 
+/* tell whether other threads may share the strings and arrays of the current interpreter */
+static int
+concurrent(void)
+{
+	return hoc->parent || hoc->nrunning;
+}
+
+/*
+ * count one more reference to a string or array; workers and tasks,
+ * which share those of their parent, and parents of running tasks,
+ * count them atomically.  Those of a worker or task are never seen by
+ * its parent, nor by other workers or tasks, until it is freed.
+ */
+static void
+hold(size_t *count)
+{
+	if (concurrent())
+		__atomic_add_fetch(count, 1, __ATOMIC_RELAXED);
+	else
+		(*count)++;
+}
+
+/* count one less reference to a string or array, and tell whether it was the last one */
+static int
+release(size_t *count)
+{
+	if (concurrent())
+		return __atomic_sub_fetch(count, 1, __ATOMIC_ACQ_REL) == 0;
+	return --*count == 0;
+}
+
 /* free String from datum, String should be listed on finalstrings! */
 static void
 dfree(String *str)
 {
-	if (str->orig != FINAL)
+	if (str->orig != FINAL || !release(&str->count))
 		return;
-	if (str->count > 1) {
-		str->count--;
-	} else {
-		if (DEBUG)
-			printf("FREED STRING: %s\n", str->s);
-		free(str->s);
-		if (str->next)
-			str->next->prev = str->prev;
-		if (str->prev)
-			str->prev->next = str->next;
-		else
-			finalstrings = str->next;
-		free(str);
-	}
+	if (DEBUG)
+		printf("FREED STRING: %s\n", str->s);
+	countstr(str, -1);
+	free(str->s);
+	if (str->next)
+		str->next->prev = str->prev;
+	if (str->prev)
+		str->prev->next = str->next;
+	else
+		hoc->finalstrings = str->next;
+	free(str);
 }
 
 /* move string from autostrings to finalstrings */
@@ -664,32 +1576,177 @@ void
 movstr(String *str)
 {
 	if (str->orig == FINAL) {
-		str->count++;
+		hold(&str->count);
 	} else if (str->orig == AUTO) {
+		countstr(str, -1);
 		if (str->next)
 			str->next->prev = str->prev;
 		if (str->prev)
 			str->prev->next = str->next;
 		else
-			autostrings = str->next;
-		if (finalstrings)
-			finalstrings->prev = str;
-		str->next = finalstrings;
+			hoc->autostrings = str->next;
+		if (hoc->finalstrings)
+			hoc->finalstrings->prev = str;
+		str->next = hoc->finalstrings;
 		str->prev = NULL;
 		str->orig = FINAL;
 		str->count = 1;
-		finalstrings = str;
+		hoc->finalstrings = str;
+		countstr(str, 1);
 	}
 }
 
-/* pop numeric value from stack */
-static Datum
-popnum(void)
+/* allocate an array of n zeros, freed automatically after execution unless assigned */
+static Array *
+newarr(size_t n)
 {
-	Datum d;
-	double v;
+	Array *a;
+
+	a = emalloc(sizeof *a);
+	a->len = a->size = n;
+	a->cols = 0;
+	a->map = NULL;
+	a->sketch = NULL;
+	a->shared = 0;
+	a->elem = NULL;
+	a->val = NULL;
+	if (n > 0 && (a->val = calloc(n, sizeof *a->val)) == NULL) {
+		free(a);
+		yyerror("out of memory");
+	}
+	hoc->stats.nmalloc++;
+	hoc->stats.mallocbytes += n * sizeof *a->val;
+	a->orig = AUTO;
+	a->count = 1;
+	if (hoc->autoarrays)
+		hoc->autoarrays->prev = a;
+	a->next = hoc->autoarrays;
+	a->prev = NULL;
+	hoc->autoarrays = a;
+	return a;
+}
 
-	d = pop();
+/* free array and the strings it holds */
+static void
+freearr(Array *a)
+{
+	size_t i;
+
+	if (a->elem) {
+		for (i = 0; i < a->len; i++)
+			if (a->elem[i].isstr)
+				dfree(a->elem[i].u.str);
+		free(a->elem);
+	}
+	if (a->map) {
+		for (i = 0; i < a->map->len; i++)
+			if (a->map->keys[i].type == KEYSTR)
+				dfree(a->map->keys[i].u.str);
+		mapfree(a->map);
+	}
+	if (a->sketch)
+		skfree(a->sketch);
+	free(a->val);
+	free(a);
+}
+
+/* free array list */
+static void
+freearrays(Array **arrays)
+{
+	Array *tmp, *p;
+
+	p = *arrays;
+	while (p) {
+		tmp = p;
+		p = p->next;
+		freearr(tmp);
+	}
+	*arrays = NULL;
+}
+
+/* unlink array from its list */
+static void
+unlinkarr(Array *a)
+{
+	if (a->next)
+		a->next->prev = a->prev;
+	if (a->prev)
+		a->prev->next = a->next;
+	else if (a->orig == FINAL)
+		hoc->finalarrays = a->next;
+	else
+		hoc->autoarrays = a->next;
+}
+
+/* move array from autoarrays to finalarrays, or count one more reference to it */
+static void
+movarr(Array *a)
+{
+	if (a->orig == FINAL) {
+		hold(&a->count);
+		return;
+	}
+	unlinkarr(a);
+	if (hoc->finalarrays)
+		hoc->finalarrays->prev = a;
+	a->next = hoc->finalarrays;
+	a->prev = NULL;
+	a->orig = FINAL;
+	a->count = 1;
+	hoc->finalarrays = a;
+}
+
+/* drop a reference to array, freeing it after the last one */
+static void
+arrfree(Array *a)
+{
+	if (a->orig != FINAL || !release(&a->count))
+		return;
+	unlinkarr(a);
+	freearr(a);
+}
+
+/* drop a reference to array, making it automatic again after the last one */
+static void
+tmparr(Array *a)
+{
+	if (a->orig != FINAL || !release(&a->count))
+		return;
+	a->count = 1;
+	unlinkarr(a);
+	if (hoc->autoarrays)
+		hoc->autoarrays->prev = a;
+	a->next = hoc->autoarrays;
+	a->prev = NULL;
+	a->orig = AUTO;
+	hoc->autoarrays = a;
+}
+
+/* count one more (n = 1) or one less (n = -1) parallel loop or task reading array a */
+static void
+share(Array *a, int n)
+{
+	__atomic_add_fetch(&a->shared, n, __ATOMIC_RELAXED);
+}
+
+/* tell whether parallel loops or tasks read array a */
+static int
+isshared(Array *a)
+{
+	return __atomic_load_n(&a->shared, __ATOMIC_RELAXED) > 0;
+}
+
+/* pop numeric value from stack */
+static Datum
+popnum(void)
+{
+	Datum d;
+	double v;
+
+	d = pop();
+	if (d.isarr)
+		yyerror("array used as number");
 	if (d.isstr) {
 		v = atof(d.u.str->s);
 		d.u.val = v;
@@ -748,6 +1805,26 @@ divd(void)
 	push(d1);
 }
 
+#define MAXINT 9007199254740992.0       /* 2^53, up to which doubles hold every integer */
+
+/*
+ * compute the module of x by y; when both are integers that doubles
+ * hold exactly, as loop counters and indices are, use integer division,
+ * which is much faster than fmod() and gives the same result
+ */
+static double
+module(double x, double y)
+{
+	double r;
+
+	if (x >= -MAXINT && x <= MAXINT && y >= -MAXINT && y <= MAXINT && y != 0.0 &&
+	    x == (double)(int64_t)x && y == (double)(int64_t)y) {
+		r = (double)((int64_t)x % (int64_t)y);
+		return (r == 0.0) ? copysign(0.0, x) : r;
+	}
+	return fmod(x, y);
+}
+
 /* compute module of top two elements on stack */
 void
 mod(void)
@@ -758,7 +1835,7 @@ mod(void)
 	if (d2.u.val == 0.0)
 		yyerror("module by zero");
 	d1 = popnum();
-	d1.u.val = fmod(d1.u.val, d2.u.val);
+	d1.u.val = module(d1.u.val, d2.u.val);
 	push(d1);
 }
 
@@ -794,8 +1871,8 @@ cmdarg(void)
 
 	d = popnum();
 	i = (int)d.u.val;
-	if (i >= 0 && i < argc) {
-		d.u.str = &argvstrings[i];
+	if (i >= 0 && i < hoc->argc) {
+		d.u.str = &hoc->argvstrings[i];
 		d.isstr = 1;
 	} else {
 		d.u.val = 0.0;
@@ -813,38 +1890,48 @@ eval(void)
 	Datum d;
 
 	name = getnamearg();
-	if ((sym = lookupsym(currsymtab, name->s)) == NULL)
-		if ((sym = lookupsym(global, name->s)) == NULL)
+	if ((sym = lookupsym(hoc->currsymtab, name->s)) == NULL)
+		if ((sym = lookupsym(hoc->global, name->s)) == NULL)
 			yyerror("could not find variable %s", name->s);
 	d.isstr = sym->isstr;
+	d.isarr = sym->isarr;
 	d.u = sym->u;
 	push(d);
 }
 
-/* verify whether name is assignable and undefined */
-static void
+/* verify whether name is assignable and undefined; return its type */
+static int
 verifyassign(Name *name, int undef)
 {
-	if (undef && name->type == UNDEF)
+	int t;
+
+	t = __atomic_load_n(&name->type, __ATOMIC_RELAXED);    /* workers share names */
+	if (undef && t == UNDEF)
 		yyerror("undefined variable: %s", name->s);
-	if (name->type != VAR && name->type != UNDEF)
+	if (t != VAR && t != UNDEF)
 		yyerror("assignment to non-variable: %s", name->s);
+	return t;
 }
 
-/* get symbol from name for assignment; and convert to number if convtonum != 0 */
+/* get symbol of name for assignment; and convert to number if convtonum != 0 */
 static Symbol *
-getassign(int convtonum)
+assignsym(Name *name, int convtonum)
 {
-	Name *name;
 	Symbol *sym;
 	double v;
+	int t;
 
-	name = getnamearg();
-	verifyassign(name, convtonum);
-	if ((sym = lookupsym(currsymtab, name->s)) == NULL)
-		if ((sym = lookupsym(global, name->s)) == NULL)
+	t = verifyassign(name, convtonum);
+	if ((sym = lookupsym(hoc->currsymtab, name->s)) == NULL) {
+		if (hoc->parent)
+			yyerror("%s: parallel code assigns a global variable", name->s);
+		if ((sym = lookupsym(hoc->global, name->s)) == NULL)
 			sym = installglobalsym(name->s);
-	name->type = VAR;
+	}
+	if (t != VAR)
+		__atomic_store_n(&name->type, VAR, __ATOMIC_RELAXED);
+	if (convtonum && sym->isarr)
+		yyerror("array %s used as number", name->s);
 	if (convtonum && sym->isstr) {
 		v = atof(sym->u.str->s);
 		dfree(sym->u.str);
@@ -854,6 +1941,13 @@ getassign(int convtonum)
 	return sym;
 }
 
+/* get symbol from name as instruction argument for assignment; and convert to number if convtonum != 0 */
+static Symbol *
+getassign(int convtonum)
+{
+	return assignsym(getnamearg(), convtonum);
+}
+
 /* pre-increment variable */
 void
 preinc(void)
@@ -863,7 +1957,7 @@ preinc(void)
 
 	sym = getassign(1);
 	d.u.val = sym->u.val += 1.0;
-	d.isstr = 0;
+	d.isstr = d.isarr = 0;
 	push(d);
 }
 
@@ -876,7 +1970,7 @@ predec(void)
 
 	sym = getassign(1);
 	d.u.val = sym->u.val -= 1.0;
-	d.isstr = 0;
+	d.isstr = d.isarr = 0;
 	push(d);
 }
 
@@ -889,7 +1983,7 @@ postinc(void)
 
 	sym = getassign(1);
 	d.u.val = sym->u.val;
-	d.isstr = 0;
+	d.isstr = d.isarr = 0;
 	sym->u.val += 1.0;
 	push(d);
 }
@@ -903,7 +1997,7 @@ postdec(void)
 
 	sym = getassign(1);
 	d.u.val = sym->u.val;
-	d.isstr = 0;
+	d.isstr = d.isarr = 0;
 	sym->u.val -= 1.0;
 	push(d);
 }
@@ -917,12 +2011,17 @@ assign(void)
 
 	d = pop();
 	sym = getassign(0);
-	if (sym->isstr)
-		dfree(sym->u.str);
 	if (d.isstr)
 		movstr(d.u.str);
+	if (d.isarr)
+		movarr(d.u.arr);
+	if (sym->isstr)
+		dfree(sym->u.str);
+	if (sym->isarr)
+		arrfree(sym->u.arr);
 	sym->u = d.u;
 	sym->isstr = d.isstr;
+	sym->isarr = d.isarr;
 	push(d);
 }
 
@@ -988,19 +2087,348 @@ modeq(void)
 
 	d = popnum();
 	sym = getassign(1);
-	v = fmod(sym->u.val, d.u.val);
+	v = module(sym->u.val, d.u.val);
 	d.u.val = sym->u.val = v;
 	push(d);
 }
 
-/* print content of datum */
+/* get the array held by variable name */
+static Array *
+getarr(Name *name)
+{
+	Symbol *sym;
+
+	if ((sym = lookupsym(hoc->currsymtab, name->s)) == NULL)
+		if ((sym = lookupsym(hoc->global, name->s)) == NULL)
+			yyerror("could not find variable %s", name->s);
+	if (!sym->isarr || sym->u.arr->sketch)
+		yyerror("%s is not an array", name->s);
+	return sym->u.arr;
+}
+
+/* get the element of array name indexed by d; the one past the end, to append, if append != 0 and it is no matrix */
+static size_t
+getindex(Name *name, Array *a, Datum d, int append)
+{
+	if (d.u.val >= 0.0 && d.u.val < (double)a->len + (append != 0 && a->cols == 0))
+		return (size_t)d.u.val;
+	yyerror("%s[%.8g]: index out of bounds", name->s, d.u.val);
+	return 0;
+}
+
+/* get the element of map a keyed by d, adding it if add != 0; MAPNONE if it is not there */
+static size_t
+getkey(Name *name, Array *a, Datum d, int add)
+{
+	Key k;
+	size_t i;
+
+	if (d.isarr)
+		yyerror("%s: arrays cannot be keys", name->s);
+	if (d.isstr)
+		strkey(&k, d.u.str);
+	else
+		numkey(&k, d.u.val);
+	if ((i = mapfind(a->map, &k, add)) == MAPNONE && add)
+		yyerror("%s: out of memory", name->s);
+	if (i == a->len && k.type == KEYSTR)
+		movstr(k.u.str);        /* a new key */
+	return i;
+}
+
+/* make array hold elements of any type, to store a string in it */
+static void
+mixarr(Array *a)
+{
+	size_t i;
+
+	a->elem = emalloc((a->size ? a->size : 1) * sizeof *a->elem);
+	for (i = 0; i < a->len; i++) {
+		a->elem[i].u.val = a->val[i];
+		a->elem[i].isstr = 0;
+	}
+	free(a->val);
+	a->val = NULL;
+}
+
+/* append a zero to array */
+static void
+growarr(Array *a)
+{
+	size_t size;
+	void *p;
+
+	if (a->len == a->size) {
+		size = a->size ? 2 * a->size : 8;
+		if (a->elem)
+			p = realloc(a->elem, size * sizeof *a->elem);
+		else
+			p = realloc(a->val, size * sizeof *a->val);
+		if (p == NULL)
+			yyerror("out of memory");
+		if (a->elem)
+			a->elem = p;
+		else
+			a->val = p;
+		a->size = size;
+	}
+	if (a->elem) {
+		a->elem[a->len].u.val = 0.0;
+		a->elem[a->len].isstr = 0;
+	} else {
+		a->val[a->len] = 0.0;
+	}
+	a->len++;
+}
+
+/* push element of array onto stack */
+void
+elempush(void)
+{
+	Datum d;
+	Array *a;
+	Name *name;
+	size_t i;
+
+	name = getnamearg();
+	a = getarr(name);
+	if (a->map == NULL) {
+		d = popnum();
+		i = getindex(name, a, d, 0);
+	} else if ((i = getkey(name, a, pop(), 0)) == MAPNONE) {
+		d.u.val = 0.0;          /* a missing key is not added */
+		d.isstr = d.isarr = 0;
+		push(d);
+		return;
+	}
+	if (a->elem) {
+		d.u = a->elem[i].u;
+		d.isstr = a->elem[i].isstr;
+	} else {
+		d.u.val = a->val[i];
+		d.isstr = 0;
+	}
+	d.isarr = 0;
+	push(d);
+}
+
+/* replace the row and column on top of stack by the index of their element of matrix */
+void
+matindex(void)
+{
+	Datum i, j;
+	Array *a;
+	Name *name;
+
+	name = getnamearg();
+	j = popnum();
+	i = popnum();
+	a = getarr(name);
+	if (a->cols == 0)
+		yyerror("%s is not a matrix", name->s);
+	if (!(i.u.val >= 0.0 && i.u.val < (double)(a->len / a->cols) &&
+	      j.u.val >= 0.0 && j.u.val < (double)a->cols))
+		yyerror("%s[%.8g, %.8g]: index out of bounds", name->s, i.u.val, j.u.val);
+	i.u.val = (double)((size_t)i.u.val * a->cols + (size_t)j.u.val);
+	push(i);
+}
+
+/* replace the key or index on top of stack by whether the map or array name has it */
+void
+inmap(void)
+{
+	Datum d;
+	Array *a;
+	Name *name;
+
+	name = getnamearg();
+	a = getarr(name);
+	if (a->map) {
+		d = pop();
+		d.u.val = getkey(name, a, d, 0) != MAPNONE;
+	} else {
+		d = popnum();
+		d.u.val = d.u.val >= 0.0 && d.u.val < (double)a->len;
+	}
+	d.isstr = d.isarr = 0;
+	push(d);
+}
+
+/* tell whether array a is an output of the parallel loop of the current worker */
+static int
+isout(Array *a)
+{
+	size_t i;
+
+	for (i = 0; hoc->par && i < hoc->par->nouts; i++)
+		if (hoc->par->outs[i] == a)
+			return 1;
+	return 0;
+}
+
+/* error if array a, which is shared, changes but for assigning number v to an element of an output of the loop of a worker */
+static void
+verifyout(Name *name, Array *a, Datum v)
+{
+	if (!isout(a))
+		yyerror("%s: parallel code changes a shared array", name->s);
+	if (v.isstr || v.isarr)
+		yyerror("%s: parallel loop output holds only numbers", name->s);
+}
+
+/* error if bltin s changes array a while it is shared */
+static void
+verifychange(const char *s, Array *a)
+{
+	if (isshared(a))
+		yyerror("%s: parallel code changes a shared array", s);
+}
+
+/* assign top value to element of array, or operate on it */
+void
+elemassign(void)
+{
+	Datum d, v;
+	Array *a;
+	Name *name;
+	Elem *e;
+	double *x;
+	size_t i;
+	int op, post, shared;
+
+	name = getnamearg();
+	op = getintarg();
+	post = (op == ELEMINC || op == ELEMDEC);
+	if (post) {
+		v.u.val = 1.0;
+		v.isstr = v.isarr = 0;
+	} else {
+		v = pop();
+	}
+	a = getarr(name);
+	if ((shared = isshared(a)))
+		verifyout(name, a, v);
+	if (a->map == NULL) {
+		d = popnum();
+		i = getindex(name, a, d, op == ELEMSET && !shared);
+	} else {
+		i = getkey(name, a, pop(), 1);
+	}
+	if (i == a->len)
+		growarr(a);
+
+	/* store a value of any type */
+	if (op == ELEMSET) {
+		if (v.isarr)
+			yyerror("%s: arrays cannot hold arrays", name->s);
+		if (v.isstr && a->elem == NULL)
+			mixarr(a);
+		if (a->elem == NULL) {
+			a->val[i] = v.u.val;
+		} else {
+			e = &a->elem[i];
+			if (v.isstr)
+				movstr(v.u.str);
+			if (e->isstr)
+				dfree(e->u.str);
+			e->u = v.u;
+			e->isstr = v.isstr;
+		}
+		push(v);
+		return;
+	}
+
+	/* operate on the element as a number */
+	if (a->elem) {
+		e = &a->elem[i];
+		if (e->isstr) {
+			d.u.val = atof(e->u.str->s);
+			dfree(e->u.str);
+			e->u.val = d.u.val;
+			e->isstr = 0;
+		}
+		x = &e->u.val;
+	} else {
+		x = &a->val[i];
+	}
+	if (v.isarr)
+		yyerror("array used as number");
+	if (v.isstr)
+		v.u.val = atof(v.u.str->s);
+	d.u.val = *x;
+	switch (op) {
+	case ELEMADD:
+	case ELEMINC:
+		*x += v.u.val;
+		break;
+	case ELEMSUB:
+	case ELEMDEC:
+		*x -= v.u.val;
+		break;
+	case ELEMMUL:
+		*x *= v.u.val;
+		break;
+	case ELEMDIV:
+		*x /= v.u.val;
+		break;
+	case ELEMMOD:
+		*x = module(*x, v.u.val);
+		break;
+	}
+	if (!post)
+		d.u.val = *x;           /* a[i]++ and a[i]-- give the value before */
+	d.isstr = d.isarr = 0;
+	push(d);
+}
+
+/* print the kind and summary of a sketch */
+static void
+prsketch(Sketch *s)
+{
+	switch (s->kind) {
+	case SKWELFORD:
+		printf("welford(%zu values, mean %.8g, variance %.8g)", s->n, s->mean, skvariance(s));
+		break;
+	case SKHIST:
+		printf("histogram(%zu values, %zu bins from %.8g to %.8g)", s->n, s->nbins, s->lo, s->hi);
+		break;
+	case SKKLL:
+		printf("kll(%zu values, accuracy %zu)", s->n, s->k);
+		break;
+	}
+}
+
+/* print content of datum; a map as a line per key and value */
 static void
 pr(Datum d)
 {
-	if (d.isstr)
+	Array *a;
+	Key *k;
+	size_t i;
+
+	if (d.isarr && d.u.arr->sketch) {
+		prsketch(d.u.arr->sketch);
+	} else if (d.isarr) {
+		a = d.u.arr;
+		for (i = 0; i < a->len; i++) {
+			if (i > 0 && (a->map || (a->cols && i % a->cols == 0)))
+				printf("\n");
+			else if (i > 0)
+				printf(" ");
+			if (a->map && (k = &a->map->keys[i])->type == KEYNUM)
+				printf("%.8g: ", k->u.num);
+			else if (a->map)
+				printf("%s: ", (k->type == KEYSHORT) ? k->u.s : k->u.str->s);
+			if (a->elem && a->elem[i].isstr)
+				printf("%s", a->elem[i].u.str->s);
+			else
+				printf("%.8g", a->elem ? a->elem[i].u.val : a->val[i]);
+		}
+	} else if (d.isstr) {
 		printf("%s", d.u.str->s);
-	else
+	} else {
 		printf("%.8g", d.u.val);
+	}
 }
 
 void
@@ -1009,13 +2437,21 @@ println(void)
 	Datum d;
 
 	d = pop();
+	if (tracing)
+		tracebegin("print", "io", 0);
 	pr(d);
 	printf("\n");
-	if (prev.isstr)
-		dfree(prev.u.str);
+	if (tracing)
+		traceend();
 	if (d.isstr)
 		movstr(d.u.str);
-	prev = d;
+	if (d.isarr)
+		movarr(d.u.arr);
+	if (hoc->prev.isstr)
+		dfree(hoc->prev.u.str);
+	if (hoc->prev.isarr)
+		arrfree(hoc->prev.u.arr);
+	hoc->prev = d;
 }
 
 /* free list got by poplist */
@@ -1040,12 +2476,13 @@ poplist(void)
 
 	narg = getintarg();
 	while (narg-- > 0) {
-		if (stack == NULL) {
+		if (hoc->stack == NULL) {
 			freelist(beg);
 			yyerror("stack underflow");
 		}
-		beg = stack;
-		stack = stack->next;
+		beg = hoc->stack;
+		hoc->stack = hoc->stack->next;
+		hoc->stats.depth--;
 		beg->next = tmp;
 		tmp = beg;
 	}
@@ -1059,6 +2496,8 @@ _print(void)
 	Datum *beg, *p;
 
 	beg = poplist();
+	if (tracing)
+		tracebegin("print", "io", 0);
 	for (p = beg; p; p = p->next) {
 		pr(*p);
 		if (p->next)
@@ -1066,6 +2505,8 @@ _print(void)
 		else
 			printf("\n");
 	}
+	if (tracing)
+		traceend();
 	freelist(beg);
 }
 
@@ -1110,7 +2551,7 @@ format(char *s, Datum *p)
 		case 'X':
 		case 'x':
 			/* int */
-			if (!p || p->isstr)
+			if (!p || p->isstr || p->isarr)
 				goto wrong;
 			n = snprintf(t, BUFSIZ - (t - buf), fmt, (int)p->u.val);
 			break;
@@ -1123,7 +2564,7 @@ format(char *s, Datum *p)
 		case 'a':
 		case 'A':
 			/* double */
-			if (!p || p->isstr)
+			if (!p || p->isstr || p->isarr)
 				goto wrong;
 			n = snprintf(t, BUFSIZ - (t - buf), fmt, p->u.val);
 			break;
@@ -1141,7 +2582,7 @@ format(char *s, Datum *p)
 			break;
 		default:
 			if ((n = strlen(fmt)) < BUFSIZ - (t - buf))
-				strncpy(t, fmt, strlen(fmt));
+				memcpy(t, fmt, n);
 			else
 				goto error;
 			break;
@@ -1185,7 +2626,11 @@ _printf(void)
 	}
 	if ((s = format(beg->u.str->s, beg->next)) == NULL)
 		goto error;
+	if (tracing)
+		tracebegin("printf", "io", 0);
 	printf("%s", s);
+	if (tracing)
+		traceend();
 	free(s);
 	freelist(beg);
 	return;
@@ -1217,6 +2662,7 @@ _sprintf(void)
 	}
 	freelist(beg);
 	d.isstr = 1;
+	d.isarr = 0;
 	d.u.str = str;
 	push(d);
 	return;
@@ -1226,447 +2672,2850 @@ error:
 	longjump();
 }
 
-/* read number into variable */
-void
-readnum(void)
+/* push report of statistics onto stack */
+static void
+_stats(void)
 {
 	Datum d;
-	Symbol *sym;
-	double v;
+	FILE *fp;
+	char *s;
+	size_t len;
 
-	sym = getassign(0);
-	switch (scanf("%lf", &v)) {
-	case EOF:
-		d.u.val = 0.0;
-		break;
-	case 0:
-		yyerror("non-number read into %s", sym->name);
-		break;
-	default:
-		d.u.val = 1.0;
-		sym->isstr = 0;
-		sym->u.val = v;
-		break;
-	}
-	d.isstr = 0;
+	if (getintarg() != 0)
+		yyerror("stats: wrong arity");
+	s = NULL;
+	if ((fp = open_memstream(&s, &len)) == NULL)
+		yyerror("out of memory");
+	printstats(fp);
+	if (fclose(fp) == EOF)
+		yyerror("out of memory");
+	if (len > 0 && s[len - 1] == '\n')
+		s[len - 1] = '\0';
+	d.isstr = 1;
+	d.isarr = 0;
+	d.u.str = addstr(s, 0);
 	push(d);
 }
 
-/* read into variable */
-void
-readline(void)
+/* push a new array of as many zeros as the argument, or an empty one */
+static void
+_array(void)
 {
 	Datum d;
-	Symbol *sym;
-	char buf[BUFSIZ];
-	char *s;
+	int narg;
 
-	sym = getassign(0);
-	if (fgets(buf, sizeof buf, stdin)) {
-		d.u.val = 1.0;
-		if ((s = strdup(buf)) == NULL)
-			yyerror("out of memory");
-		sym->isstr = 1;
-		sym->u.str = addstr(s, 1);
-	} else {
-		d.u.val = 0.0;
-	}
+	if ((narg = getintarg()) > 1)
+		yyerror("array: wrong arity");
+	d.u.val = 0.0;
+	if (narg == 1)
+		d = popnum();
+	if (!(d.u.val >= 0.0 && d.u.val <= (double)(SIZE_MAX / sizeof(Elem))))
+		yyerror("array: invalid length %.8g", d.u.val);
+	d.u.arr = newarr((size_t)d.u.val);
 	d.isstr = 0;
+	d.isarr = 1;
 	push(d);
 }
 
-void
-gt(void)
+/* push the number of elements of an array, of values added to a sketch, or of characters of a string */
+static void
+_len(void)
 {
-	Datum d1, d2;
+	Datum d;
 
-	d2 = popnum();
-	d1 = popnum();
-	d1.u.val = (double)(d1.u.val > d2.u.val);
-	push(d1);
+	if (getintarg() != 1)
+		yyerror("len: wrong arity");
+	d = pop();
+	if (d.isarr && d.u.arr->sketch)
+		d.u.val = d.u.arr->sketch->n;
+	else if (d.isarr)
+		d.u.val = d.u.arr->len;
+	else if (d.isstr)
+		d.u.val = strlen(d.u.str->s);
+	else
+		yyerror("len: not an array nor a string");
+	d.isstr = d.isarr = 0;
+	push(d);
 }
 
+/* check the number of arguments of bltin s */
+static void
+arity(const char *s, int n)
+{
+	if (getintarg() != n)
+		yyerror("%s: wrong arity", s);
+}
+
+/* make array a contiguous again if it holds only numbers; return 0 if it holds strings */
+static int
+packarr(Array *a)
+{
+	size_t i;
+
+	if (a->elem == NULL)
+		return 1;
+	for (i = 0; i < a->len; i++)
+		if (a->elem[i].isstr)
+			return 0;
+	a->val = emalloc((a->size ? a->size : 1) * sizeof *a->val);
+	for (i = 0; i < a->len; i++)
+		a->val[i] = a->elem[i].u.val;
+	free(a->elem);
+	a->elem = NULL;
+	return 1;
+}
+
+/* pop the array argument of bltin s, which must hold only numbers */
+static Array *
+popnumarr(const char *s)
+{
+	Datum d;
+	Array *a;
+
+	d = pop();
+	if (!d.isarr || d.u.arr->sketch)
+		yyerror("%s: not an array", s);
+	a = d.u.arr;
+	if (!packarr(a))
+		yyerror("%s: array holds strings", s);
+	return a;
+}
+
+/* pop two arrays of the same length, the arguments of bltin s */
+static void
+poparrs(const char *s, Array **a, Array **b)
+{
+	*b = popnumarr(s);
+	*a = popnumarr(s);
+	if ((*a)->len != (*b)->len)
+		yyerror("%s: arrays of different lengths", s);
+}
+
+/* push number */
+static void
+pushval(double v)
+{
+	Datum d;
+
+	d.u.val = v;
+	d.isstr = d.isarr = 0;
+	push(d);
+}
+
+/* push array */
+static void
+pusharr(Array *a)
+{
+	Datum d;
+
+	d.u.arr = a;
+	d.isstr = 0;
+	d.isarr = 1;
+	push(d);
+}
+
+/* push a new empty map */
+static void
+_map(void)
+{
+	Array *a;
+
+	arity("map", 0);
+	a = newarr(0);
+	if ((a->map = mapnew()) == NULL)
+		yyerror("out of memory");
+	pusharr(a);
+}
+
+/* push the sum of the elements of an array */
+static void
+_sum(void)
+{
+	Array *a;
+
+	arity("sum", 1);
+	a = popnumarr("sum");
+	pushval(vecsum(a->val, a->len));
+}
+
+/* tell whether the datum on top of stack is a sketch */
+static int
+topsketch(void)
+{
+	return hoc->stack != NULL && hoc->stack->isarr && hoc->stack->u.arr->sketch != NULL;
+}
+
+/* pop the sketch argument of bltin s */
+static Sketch *
+popsketch(const char *s)
+{
+	Datum d;
+
+	d = pop();
+	if (!d.isarr || d.u.arr->sketch == NULL)
+		yyerror("%s: not a sketch", s);
+	return d.u.arr->sketch;
+}
+
+/* pop the sketch argument of bltin s, which must not be empty */
+static Sketch *
+popstream(const char *s)
+{
+	Sketch *sk;
+
+	if ((sk = popsketch(s))->n == 0)
+		yyerror("%s: empty sketch", s);
+	return sk;
+}
+
+/* push the mean of the elements of an array, or of the values added to a sketch */
+static void
+_mean(void)
+{
+	Array *a;
+
+	arity("mean", 1);
+	if (topsketch()) {
+		pushval(popstream("mean")->mean);
+		return;
+	}
+	a = popnumarr("mean");
+	if (a->len == 0)
+		yyerror("mean: empty array");
+	pushval(vecsum(a->val, a->len) / a->len);
+}
+
+/* push the least element of an array, or value added to a sketch */
+static void
+_min(void)
+{
+	Array *a;
+
+	arity("min", 1);
+	if (topsketch()) {
+		pushval(popstream("min")->min);
+		return;
+	}
+	a = popnumarr("min");
+	if (a->len == 0)
+		yyerror("min: empty array");
+	pushval(vecmin(a->val, a->len));
+}
+
+/* push the greatest element of an array, or value added to a sketch */
+static void
+_max(void)
+{
+	Array *a;
+
+	arity("max", 1);
+	if (topsketch()) {
+		pushval(popstream("max")->max);
+		return;
+	}
+	a = popnumarr("max");
+	if (a->len == 0)
+		yyerror("max: empty array");
+	pushval(vecmax(a->val, a->len));
+}
+
+/* push the dot product of two arrays */
+static void
+_dot(void)
+{
+	Array *a, *b;
+
+	arity("dot", 2);
+	poparrs("dot", &a, &b);
+	pushval(vecdot(a->val, b->val, a->len));
+}
+
+/* push the number of elements of an array that compare with a value as the operator given as a string */
+static void
+_count(void)
+{
+	static const char *ops[] = {"<", "<=", ">", ">=", "==", "!="};
+	Datum op, v;
+	Array *a;
+	int i;
+
+	arity("count", 3);
+	v = popnum();
+	op = pop();
+	a = popnumarr("count");
+	for (i = 0; op.isstr && i < (int)(sizeof ops / sizeof ops[0]); i++)
+		if (strcmp(op.u.str->s, ops[i]) == 0)
+			break;
+	if (!op.isstr || i == (int)(sizeof ops / sizeof ops[0]))
+		yyerror("count: unknown comparison");
+	pushval(veccount(a->val, a->len, VECLT + i, v.u.val));
+}
+
+/* add a number times an array to another array, and push the latter */
+static void
+_axpy(void)
+{
+	Array *x, *y;
+	Datum k;
+
+	arity("axpy", 3);
+	poparrs("axpy", &x, &y);
+	verifychange("axpy", y);
+	k = popnum();
+	vecaxpy(k.u.val, x->val, y->val, x->len);
+	pusharr(y);
+}
+
+/* push the sums of the elements of two arrays */
+static void
+_vadd(void)
+{
+	Array *a, *b, *c;
+
+	arity("vadd", 2);
+	poparrs("vadd", &a, &b);
+	c = newarr(a->len);
+	c->cols = a->cols;
+	vecadd(a->val, b->val, c->val, a->len);
+	pusharr(c);
+}
+
+/* push the products of the elements of two arrays */
+static void
+_vmul(void)
+{
+	Array *a, *b, *c;
+
+	arity("vmul", 2);
+	poparrs("vmul", &a, &b);
+	c = newarr(a->len);
+	c->cols = a->cols;
+	vecmul(a->val, b->val, c->val, a->len);
+	pusharr(c);
+}
+
+/* push the elements of an array times a number */
+static void
+_vscale(void)
+{
+	Array *a, *c;
+	Datum k;
+
+	arity("vscale", 2);
+	k = popnum();
+	a = popnumarr("vscale");
+	c = newarr(a->len);
+	c->cols = a->cols;
+	vecscale(a->val, k.u.val, c->val, a->len);
+	pusharr(c);
+}
+
+/* push the running sums of the elements of an array */
+static void
+_cumsum(void)
+{
+	Array *a, *c;
+
+	arity("cumsum", 1);
+	a = popnumarr("cumsum");
+	c = newarr(a->len);
+	veccumsum(a->val, c->val, a->len);
+	pusharr(c);
+}
+
+/* pop the matrix argument of bltin s, and get its rows */
+static Array *
+popmat(const char *s, size_t *rows)
+{
+	Array *a;
+
+	a = popnumarr(s);
+	if (a->cols == 0)
+		yyerror("%s: not a matrix", s);
+	*rows = a->len / a->cols;
+	return a;
+}
+
+/* push a new matrix of zeros of the given rows and columns, or of the elements of an array in the given columns */
+static void
+_matrix(void)
+{
+	Datum r, c;
+	Array *a, *m;
+
+	arity("matrix", 2);
+	c = popnum();
+	if (!(c.u.val >= 1.0 && c.u.val <= (double)(SIZE_MAX / sizeof(Elem))))
+		yyerror("matrix: invalid columns %.8g", c.u.val);
+	if (hoc->stack != NULL && hoc->stack->isarr) {
+		a = popnumarr("matrix");
+		if (a->len % (size_t)c.u.val != 0)
+			yyerror("matrix: %zu elements in %.8g columns", a->len, c.u.val);
+		m = newarr(a->len);
+		memcpy(m->val, a->val, a->len * sizeof *a->val);
+	} else {
+		r = popnum();
+		if (!(r.u.val >= 0.0 && r.u.val * (size_t)c.u.val <= (double)(SIZE_MAX / sizeof(Elem))))
+			yyerror("matrix: invalid rows %.8g", r.u.val);
+		m = newarr((size_t)r.u.val * (size_t)c.u.val);
+	}
+	m->cols = (size_t)c.u.val;
+	pusharr(m);
+}
+
+/* push the number of rows of a matrix */
+static void
+_rows(void)
+{
+	size_t n;
+
+	arity("rows", 1);
+	(void)popmat("rows", &n);
+	pushval(n);
+}
+
+/* push the number of columns of a matrix */
+static void
+_cols(void)
+{
+	size_t n;
+
+	arity("cols", 1);
+	pushval(popmat("cols", &n)->cols);
+}
+
+/* push the product of two matrices */
+static void
+_matmul(void)
+{
+	Array *a, *b, *c;
+	size_t n, k;
+
+	arity("matmul", 2);
+	b = popmat("matmul", &k);
+	a = popmat("matmul", &n);
+	if (a->cols != k)
+		yyerror("matmul: %zux%zu and %zux%zu matrices", n, a->cols, k, b->cols);
+	c = newarr(n * b->cols);
+	c->cols = b->cols;
+	if (matmul(a->val, b->val, c->val, n, k, b->cols) != 0)
+		yyerror("out of memory");
+	pusharr(c);
+}
+
+/* push the product of a matrix and a vector */
+static void
+_matvec(void)
+{
+	Array *a, *x, *y;
+	size_t n;
+
+	arity("matvec", 2);
+	x = popnumarr("matvec");
+	a = popmat("matvec", &n);
+	if (a->cols != x->len)
+		yyerror("matvec: %zux%zu matrix and %zu elements", n, a->cols, x->len);
+	y = newarr(n);
+	matvec(a->val, x->val, y->val, n, a->cols);
+	pusharr(y);
+}
+
+/* push the transpose of a matrix */
+static void
+_transpose(void)
+{
+	Array *a, *t;
+	size_t n;
+
+	arity("transpose", 1);
+	a = popmat("transpose", &n);
+	t = newarr(a->len);
+	t->cols = n;
+	mattrans(a->val, t->val, n, a->cols);
+	if (n == 0)
+		t->cols = 0;    /* the transpose of no rows is no matrix */
+	pusharr(t);
+}
+
+/* push the solution x of a x = b, for a square matrix a, and a vector or matrix b */
+static void
+_solve(void)
+{
+	Array *a, *b, *lu, *x;
+	size_t n, m;
+
+	arity("solve", 2);
+	b = popnumarr("solve");
+	a = popmat("solve", &n);
+	if (a->cols != n)
+		yyerror("solve: %zux%zu matrix is not square", n, a->cols);
+	m = b->cols ? b->cols : 1;
+	if (b->len != n * m)
+		yyerror("solve: %zu rows and %zu elements", n, b->len);
+	lu = newarr(a->len);
+	x = newarr(b->len);
+	x->cols = b->cols;
+	memcpy(lu->val, a->val, a->len * sizeof *a->val);
+	memcpy(x->val, b->val, b->len * sizeof *b->val);
+	if (matsolve(lu->val, x->val, n, m) != 0)
+		yyerror("solve: singular matrix");
+	pusharr(x);
+}
+
+/* tell whether array a, the argument of bltin s, holds strings, which must then be all it holds */
+static int
+strarr(const char *s, Array *a)
+{
+	size_t i, n;
+
+	for (n = i = 0; i < a->len; i++)
+		n += a->elem[i].isstr;
+	if (n > 0 && n < a->len)
+		yyerror("%s: array holds numbers and strings", s);
+	return n > 0;
+}
+
+/* push a new array of the elements of an array sorted, decreasing if desc != 0, or of their indices in that order if arg != 0 */
+static void
+sortarr(const char *s, int desc, int arg)
+{
+	Array *a, *c;
+	const char **strs;
+	size_t i, n, *idx;
+	int e;
+
+	arity(s, 1);
+	if (hoc->stack != NULL && hoc->stack->isarr && (a = hoc->stack->u.arr)->elem && strarr(s, a)) {
+		(void)pop();
+		n = a->len;
+		c = newarr(n);
+		strs = emalloc((n ? n : 1) * sizeof *strs);
+		idx = emalloc((n ? n : 1) * sizeof *idx);
+		for (i = 0; i < n; i++)
+			strs[i] = a->elem[i].u.str->s;
+		e = argsortstr(strs, idx, n, desc);
+		free(strs);
+		if (e == 0 && !arg) {
+			mixarr(c);
+			for (i = 0; i < n; i++) {
+				c->elem[i] = a->elem[idx[i]];
+				movstr(c->elem[i].u.str);
+			}
+		}
+	} else {
+		a = popnumarr(s);
+		n = a->len;
+		c = newarr(n);
+		idx = NULL;
+		if (arg) {
+			idx = emalloc((n ? n : 1) * sizeof *idx);
+			e = argsortnum(a->val, idx, n, desc);
+		} else {
+			e = sortnum(a->val, c->val, n, desc);
+		}
+	}
+	if (e == 0 && arg)
+		for (i = 0; i < n; i++)
+			c->val[i] = (double)idx[i];
+	free(idx);
+	if (e != 0)
+		yyerror("out of memory");
+	pusharr(c);
+}
+
+/* push a new array of the elements of an array in increasing order */
+static void
+_sort(void)
+{
+	sortarr("sort", 0, 0);
+}
+
+/* push a new array of the elements of an array in decreasing order */
+static void
+_sortdesc(void)
+{
+	sortarr("sortdesc", 1, 0);
+}
+
+/* push a new array of the indices of the elements of an array in increasing order */
+static void
+_argsort(void)
+{
+	sortarr("argsort", 0, 1);
+}
+
+/* push a new sketch of the given kind; a histogram has n bins from lo to hi, a KLL sketch accuracy n */
+static void
+pushsketch(int kind, double lo, double hi, size_t n)
+{
+	Array *a;
+
+	a = newarr(0);
+	if ((a->sketch = sknew(kind, lo, hi, n)) == NULL)
+		yyerror("out of memory");
+	pusharr(a);
+}
+
+/* push a new sketch of the mean and variance */
+static void
+_welford(void)
+{
+	arity("welford", 0);
+	pushsketch(SKWELFORD, 0.0, 0.0, 0);
+}
+
+/* push a new histogram of a range in a number of bins */
+static void
+_histogram(void)
+{
+	Datum lo, hi, n;
+
+	arity("histogram", 3);
+	n = popnum();
+	hi = popnum();
+	lo = popnum();
+	if (!(n.u.val >= 1.0 && n.u.val <= (double)(SIZE_MAX / sizeof(double))))
+		yyerror("histogram: invalid bins %.8g", n.u.val);
+	if (!(lo.u.val < hi.u.val) || !isfinite(lo.u.val) || !isfinite(hi.u.val))
+		yyerror("histogram: invalid range %.8g to %.8g", lo.u.val, hi.u.val);
+	pushsketch(SKHIST, lo.u.val, hi.u.val, (size_t)n.u.val);
+}
+
+/* push a new KLL sketch of quantiles, of the given accuracy or KLLK */
+static void
+_kll(void)
+{
+	Datum k;
+	int narg;
+
+	if ((narg = getintarg()) > 1)
+		yyerror("kll: wrong arity");
+	k.u.val = KLLK;
+	if (narg == 1)
+		k = popnum();
+	if (!(k.u.val >= 8.0 && k.u.val <= 1e6))
+		yyerror("kll: invalid accuracy %.8g", k.u.val);
+	pushsketch(SKKLL, 0.0, 0.0, (size_t)k.u.val);
+}
+
+/* add a number, or the elements of an array, to a sketch, and push the sketch */
+static void
+_add(void)
+{
+	Datum d, s;
+	Array *a;
+	int e;
+
+	arity("add", 2);
+	if (hoc->stack != NULL && hoc->stack->isarr) {
+		a = popnumarr("add");
+		s = pop();
+		if (!s.isarr || s.u.arr->sketch == NULL)
+			yyerror("add: not a sketch");
+		verifychange("add", s.u.arr);
+		e = skadd(s.u.arr->sketch, a->val, a->len);
+	} else {
+		d = popnum();
+		s = pop();
+		if (!s.isarr || s.u.arr->sketch == NULL)
+			yyerror("add: not a sketch");
+		verifychange("add", s.u.arr);
+		e = skadd(s.u.arr->sketch, &d.u.val, 1);
+	}
+	if (e == EDOM)
+		yyerror("add: NaN value");
+	if (e != 0)
+		yyerror("out of memory");
+	push(s);
+}
+
+/* add the values of a sketch to another of the same kind, and push the latter */
+static void
+_merge(void)
+{
+	Sketch *t;
+	Datum s;
+	int e;
+
+	arity("merge", 2);
+	t = popsketch("merge");
+	s = pop();
+	if (!s.isarr || s.u.arr->sketch == NULL)
+		yyerror("merge: not a sketch");
+	verifychange("merge", s.u.arr);
+	if ((e = skmerge(s.u.arr->sketch, t)) == EINVAL)
+		yyerror("merge: sketches of different kinds or ranges");
+	if (e != 0)
+		yyerror("out of memory");
+	push(s);
+}
+
+/* push the quantile of a fraction, or a new array of those of an array of fractions, of a histogram or KLL sketch */
+static void
+_quantile(void)
+{
+	Sketch *s;
+	Array *q, *z;
+	Datum d;
+	size_t i;
+
+	arity("quantile", 2);
+	q = NULL;
+	if (hoc->stack != NULL && hoc->stack->isarr)
+		q = popnumarr("quantile");
+	else
+		d = popnum();
+	s = popstream("quantile");
+	if (s->kind == SKWELFORD)
+		yyerror("quantile: not a histogram nor a KLL sketch");
+	for (i = 0; i < (q ? q->len : 1); i++)
+		if (!((q ? q->val[i] : d.u.val) >= 0.0 && (q ? q->val[i] : d.u.val) <= 1.0))
+			yyerror("quantile: invalid fraction %.8g", q ? q->val[i] : d.u.val);
+	if (q == NULL) {
+		if (skquantile(s, &d.u.val, &d.u.val, 1) != 0)
+			yyerror("out of memory");
+		pushval(d.u.val);
+		return;
+	}
+	z = newarr(q->len);
+	if (skquantile(s, q->val, z->val, q->len) != 0)
+		yyerror("out of memory");
+	pusharr(z);
+}
+
+/* push the sample variance of the elements of an array, or of the values added to a sketch */
+static void
+_variance(void)
+{
+	Array *a;
+	double mean, d, ss;
+	size_t i;
+
+	arity("variance", 1);
+	if (topsketch()) {
+		pushval(skvariance(popstream("variance")));
+		return;
+	}
+	a = popnumarr("variance");
+	if (a->len == 0)
+		yyerror("variance: empty array");
+	mean = vecsum(a->val, a->len) / a->len;
+	for (ss = 0.0, i = 0; i < a->len; i++) {
+		d = a->val[i] - mean;
+		ss += d * d;
+	}
+	pushval((a->len > 1) ? ss / (a->len - 1) : 0.0);
+}
+
+/* push a new array of the counts of the bins of a histogram */
+static void
+_bins(void)
+{
+	Sketch *s;
+	Array *a;
+
+	arity("bins", 1);
+	if ((s = popsketch("bins"))->kind != SKHIST)
+		yyerror("bins: not a histogram");
+	a = newarr(s->nbins);
+	memcpy(a->val, s->bins, s->nbins * sizeof *a->val);
+	pusharr(a);
+}
+
+/* read number into variable */
+void
+readnum(void)
+{
+	Datum d;
+	Symbol *sym;
+	double v;
+	int n;
+
+	sym = getassign(0);
+	if (tracing)
+		tracebegin("read", "io", 0);
+	n = scanf("%lf", &v);
+	if (tracing)
+		traceend();
+	switch (n) {
+	case EOF:
+		d.u.val = 0.0;
+		break;
+	case 0:
+		yyerror("non-number read into %s", sym->name);
+		break;
+	default:
+		d.u.val = 1.0;
+		if (sym->isarr)
+			arrfree(sym->u.arr);
+		sym->isstr = sym->isarr = 0;
+		sym->u.val = v;
+		break;
+	}
+	d.isstr = d.isarr = 0;
+	push(d);
+}
+
+/* read into variable */
+void
+readline(void)
+{
+	Datum d;
+	Symbol *sym;
+	char buf[BUFSIZ];
+	char *s;
+
+	sym = getassign(0);
+	if (tracing)
+		tracebegin("getline", "io", 0);
+	s = fgets(buf, sizeof buf, stdin);
+	if (tracing)
+		traceend();
+	if (s) {
+		d.u.val = 1.0;
+		if ((s = strdup(buf)) == NULL)
+			yyerror("out of memory");
+		if (sym->isarr)
+			arrfree(sym->u.arr);
+		sym->isstr = 1;
+		sym->isarr = 0;
+		sym->u.str = addstr(s, 1);
+	} else {
+		d.u.val = 0.0;
+	}
+	d.isstr = d.isarr = 0;
+	push(d);
+}
+
+void
+gt(void)
+{
+	Datum d1, d2;
+
+	d2 = popnum();
+	d1 = popnum();
+	d1.u.val = (double)(d1.u.val > d2.u.val);
+	push(d1);
+}
+
+void
+ge(void)
+{
+	Datum d1, d2;
+
+	d2 = popnum();
+	d1 = popnum();
+	d1.u.val = (double)(d1.u.val >= d2.u.val);
+	push(d1);
+}
+
+void
+lt(void)
+{
+	Datum d1, d2;
+
+	d2 = popnum();
+	d1 = popnum();
+	d1.u.val = (double)(d1.u.val < d2.u.val);
+	push(d1);
+}
+
+void
+le(void)
+{
+	Datum d1, d2;
+
+	d2 = popnum();
+	d1 = popnum();
+	d1.u.val = (double)(d1.u.val <= d2.u.val);
+	push(d1);
+}
+
+void
+eq(void)
+{
+	Datum d1, d2;
+
+	d2 = popnum();
+	d1 = popnum();
+	d1.u.val = (double)(d1.u.val == d2.u.val);
+	push(d1);
+}
+
+void
+ne(void)
+{
+	Datum d1, d2;
+
+	d2 = popnum();
+	d1 = popnum();
+	d1.u.val = (double)(d1.u.val != d2.u.val);
+	push(d1);
+}
+
+void
+not(void)
+{
+	Datum d;
+
+	d = popnum();
+	d.u.val = (double)(!d.u.val);
+	push(d);
+}
+
+void
+and(void)
+{
+	Datum d;
+	Inst *savepc;
+
+	savepc = hoc->prog.pc;
+	d = popnum();
+	if (d.u.val) {
+		execute(savepc->u.ip);
+		d = popnum();
+	}
+	d.u.val = d.u.val ? 1.0 : 0.0;
+	push(d);
+	hoc->prog.pc = N1(savepc)->u.ip;
+}
+
+void
+or(void)
+{
+	Datum d;
+	Inst *savepc;
+
+	savepc = hoc->prog.pc;
+	d = popnum();
+	if (!d.u.val) {
+		execute(savepc->u.ip);
+		d = popnum();
+	}
+	d.u.val = d.u.val ? 1.0 : 0.0;
+	push(d);
+	hoc->prog.pc = N1(savepc)->u.ip;
+}
+
+static double
+cond(Inst *pc)
+{
+	Datum d;
+
+	if (pc == NULL)
+		return 1.0;
+	execute(pc);
+	d = popnum();
+	return d.u.val;
+}
+
+static Datum
+execpop(Inst *pc)
+{
+	Datum d;
+
+	if (pc && pc->u.opr) {
+		execute(pc);
+		d = popnum();
+	} else {
+		d.u.val = 0.0;
+	}
+	return d;
+}
+
+void
+ifcode(void)
+{
+	Datum d;
+	Inst *savepc;
+
+	savepc = hoc->prog.pc;                       /* then part */
+	d = execpop(N3(savepc));
+	if (d.u.val)
+		execute(savepc->u.ip);
+	else if (N1(savepc)->u.ip)              /* else part? */
+		execute(N1(savepc)->u.ip);
+	if (!hoc->returning)
+		hoc->prog.pc = N2(savepc)->u.ip;     /* next statement */
+}
+
+void
+docode(void)
+{
+	Inst *savepc;
+	double saveepoch;
+
+	savepc = hoc->prog.pc;
+	saveepoch = hoc->loopepoch;
+	hoc->loopepoch = ++hoc->nepochs;
+	do {
+		execute(N2(savepc));
+		SAFEPOINT();
+		if (hoc->returning) {
+			break;
+		}
+		if (hoc->continuing) {
+			hoc->continuing = 0;
+			continue;
+		}
+		if (hoc->breaking) {
+			hoc->breaking = 0;
+			break;
+		}
+	} while (cond(savepc->u.ip));
+	hoc->loopepoch = saveepoch;
+	if (!hoc->returning)
+		hoc->prog.pc = N1(savepc)->u.ip;
+}
+
+void
+whilecode(void)
+{
+	Inst *savepc;
+	double saveepoch;
+
+	savepc = hoc->prog.pc;
+	saveepoch = hoc->loopepoch;
+	hoc->loopepoch = ++hoc->nepochs;
+	while (cond(N2(savepc))) {
+		execute(savepc->u.ip);
+		SAFEPOINT();
+		if (hoc->returning) {
+			break;
+		}
+		if (hoc->continuing) {
+			hoc->continuing = 0;
+			continue;
+		}
+		if (hoc->breaking) {
+			hoc->breaking = 0;
+			break;
+		}
+	}
+	hoc->loopepoch = saveepoch;
+	if (!hoc->returning)
+		hoc->prog.pc = N1(savepc)->u.ip;
+}
+
+void
+forcode(void)
+{
+	Inst *savepc;
+	double saveepoch;
+
+	savepc = hoc->prog.pc;
+	saveepoch = hoc->loopepoch;
+	hoc->loopepoch = ++hoc->nepochs;
+	for ((void)execpop(N4(savepc)); cond(savepc->u.ip); (void)execpop(N1(savepc)->u.ip)) {
+		execute(N2(savepc)->u.ip);
+		SAFEPOINT();
+		if (hoc->returning) {
+			break;
+		}
+		if (hoc->continuing) {
+			hoc->continuing = 0;
+			continue;
+		}
+		if (hoc->breaking) {
+			hoc->breaking = 0;
+			break;
+		}
+	}
+	hoc->loopepoch = saveepoch;
+	if (!hoc->returning)
+		hoc->prog.pc = N3(savepc)->u.ip;
+}
+
+/*
+ * run a loop over the keys of a map, in the order they were added, or
+ * over the indices of an array, assigning each to a variable; the keys
+ * added while the loop runs are not visited
+ */
+void
+forincode(void)
+{
+	Inst *savepc;
+	Symbol *sym;
+	Array *a;
+	Key *k;
+	Datum d;
+	double saveepoch;
+	size_t i, n;
+
+	savepc = hoc->prog.pc;
+	sym = getassign(0);
+	a = getarr(N1(savepc)->u.name);
+	movarr(a);                      /* the loop holds it, if the variable is reassigned */
+	saveepoch = hoc->loopepoch;
+	hoc->loopepoch = ++hoc->nepochs;
+	for (i = 0, n = a->len; i < n; i++) {
+		d.isstr = d.isarr = 0;
+		if (a->map == NULL) {
+			d.u.val = (double)i;
+		} else if ((k = &a->map->keys[i])->type == KEYNUM) {
+			d.u.val = k->u.num;
+		} else if (k->type == KEYSHORT) {
+			d.u.str = addstr(estrdup(k->u.s), 1);
+			d.isstr = 1;
+		} else {
+			movstr(k->u.str);
+			d.u.str = k->u.str;
+			d.isstr = 1;
+		}
+		if (sym->isstr)
+			dfree(sym->u.str);
+		if (sym->isarr)
+			arrfree(sym->u.arr);
+		sym->u = d.u;
+		sym->isstr = d.isstr;
+		sym->isarr = 0;
+		execute(N2(savepc)->u.ip);
+		SAFEPOINT();
+		if (hoc->returning) {
+			break;
+		}
+		if (hoc->continuing) {
+			hoc->continuing = 0;
+			continue;
+		}
+		if (hoc->breaking) {
+			hoc->breaking = 0;
+			break;
+		}
+	}
+	hoc->loopepoch = saveepoch;
+	arrfree(a);
+	if (!hoc->returning)
+		hoc->prog.pc = N3(savepc)->u.ip;
+}
+
+/* compare a and b with the comparison operation f */
+static int
+compare(void (*f)(void), double a, double b)
+{
+	if (f == lt)
+		return a < b;
+	if (f == le)
+		return a <= b;
+	if (f == gt)
+		return a > b;
+	if (f == ge)
+		return a >= b;
+	return a != b;
+}
+
+/*
+ * run a for loop counting a variable up or down to a bound, which
+ * optloops() made from one whose condition is the comparison of the
+ * variable with a value that does not change in the loop.  The
+ * condition is rewritten as the comparison, the variable and the code
+ * of the bound, which is computed once.
+ */
+void
+countcode(void)
+{
+	Symbol *sym;
+	Name *name;
+	Inst *savepc, *c, *s;
+	double bound, saveepoch, step;
+
+	savepc = hoc->prog.pc;
+	saveepoch = hoc->loopepoch;
+	hoc->loopepoch = ++hoc->nepochs;
+	(void)execpop(N4(savepc));
+	c = savepc->u.ip;
+	s = N1(savepc)->u.ip;
+	name = N1(c)->u.name;
+	if ((sym = lookupsym(hoc->currsymtab, name->s)) == NULL)
+		if ((sym = lookupsym(hoc->global, name->s)) == NULL)
+			yyerror("could not find variable %s", name->s);
+	if (sym->isarr)
+		yyerror("array used as number");
+	bound = execpop(N2(c)).u.val;
+	step = (s->u.opr == postinc || s->u.opr == preinc) ? 1.0 : -1.0;
+	while (compare(c->u.opr, sym->isstr ? atof(sym->u.str->s) : sym->u.val, bound)) {
+		execute(N2(savepc)->u.ip);
+		SAFEPOINT();
+		if (hoc->returning) {
+			break;
+		}
+		if (hoc->continuing) {
+			hoc->continuing = 0;
+		} else if (hoc->breaking) {
+			hoc->breaking = 0;
+			break;
+		}
+		if (sym->isstr)
+			(void)execpop(s);
+		else
+			sym->u.val += step;
+	}
+	hoc->loopepoch = saveepoch;
+	if (!hoc->returning)
+		hoc->prog.pc = N3(savepc)->u.ip;
+}
+
+/*
+ * push the value of an expression that does not change in the loop
+ * being run, computing it only the first time in each run of the loop
+ */
+void
+invpush(void)
+{
+	Inst *savepc;
+	Datum d;
+
+	savepc = hoc->prog.pc;
+	if (hoc->parent) {
+		d.u.val = execpop(savepc->u.ip).u.val;  /* workers share the code, so they do not cache */
+	} else {
+		if (N2(savepc)->u.val != hoc->loopepoch) {
+			N1(savepc)->u.val = execpop(savepc->u.ip).u.val;
+			N2(savepc)->u.val = hoc->loopepoch;
+		}
+		d.u.val = N1(savepc)->u.val;
+	}
+	d.isstr = d.isarr = 0;
+	push(d);
+	hoc->prog.pc = N3(savepc)->u.ip;
+}
+
+/* count the arrays of the current interpreter as read by one more parallel loop, or by one less */
+static void
+sharearrays(int shared)
+{
+	Array *lists[2], *a;
+	int i;
+
+	lists[0] = hoc->finalarrays;
+	lists[1] = hoc->autoarrays;
+	if (shared)             /* reading them must not change them */
+		for (i = 0; i < 2; i++)
+			for (a = lists[i]; a; a = a->next)
+				(void)packarr(a);
+	for (i = 0; i < 2; i++)
+		for (a = lists[i]; a; a = a->next)
+			share(a, shared ? 1 : -1);
+}
+
+/* get the value a reduction variable of a worker starts from */
+static double
+identity(int kind)
+{
+	if (kind == PARMIN)
+		return HUGE_VAL;
+	if (kind == PARMAX)
+		return -HUGE_VAL;
+	return 0.0;
+}
+
+/* combine x with the value y of a reduction variable of a worker */
+static double
+reduce(int kind, double x, double y)
+{
+	if (kind == PARMIN)
+		return (y < x) ? y : x;
+	if (kind == PARMAX)
+		return (y > x) ? y : x;
+	return x + y;
+}
+
+/*
+ * make a worker of the current interpreter for the parallel loop par,
+ * whose variable is var and whose clauses start at p.  Its symbol table
+ * holds its own loop variable and reduction variables, then copies of
+ * the locals of the current frame, each holding a reference to its
+ * value, as its previous value does.
+ */
+static Hoc *
+newworker(Par *par, Name *var, Inst *p)
+{
+	Symbol *sym, *s, **tail;
+	Frame *f;
+	Hoc *w;
+
+	w = emalloc(sizeof *w);
+	memset(w, 0, sizeof *w);
+	w->prog = hoc->prog;
+	w->lines = hoc->lines;
+	w->global = hoc->global;
+	w->nametab = hoc->nametab;
+	w->argc = hoc->argc;
+	w->argvstrings = hoc->argvstrings;
+	w->counting = hoc->counting;
+	w->memoall = hoc->memoall;
+	w->maxinsts = (hoc->maxinsts > hoc->stats.ninsts) ? hoc->maxinsts - hoc->stats.ninsts : 0;
+	w->stop.type = OPR;
+	w->stop.u.opr = NULL;
+	w->errors.quiet = 1;            /* the parent reports the errors */
+	w->nolines = hoc->nolines;
+	w->parent = hoc;
+	w->par = par;
+
+	f = w->frame.head = emalloc(sizeof *f);
+	f->next = f->prev = NULL;
+	f->name = NULL;
+	f->local = NULL;
+	w->frame.tail = w->frame.next = f;
+
+	tail = &w->currsymtab;
+	for (sym = hoc->currsymtab; sym; sym = sym->next) {
+		s = *tail = eallocsym(sym->name);
+		s->u = sym->u;
+		s->isstr = sym->isstr;
+		s->isarr = sym->isarr;
+		if (s->isstr && s->u.str->orig == FINAL)
+			hold(&s->u.str->count);
+		if (s->isarr && s->u.arr->orig == FINAL)
+			hold(&s->u.arr->count);
+		tail = &s->next;
+	}
+	*tail = NULL;
+	w->prev = hoc->prev;
+	if (w->prev.isstr && w->prev.u.str->orig == FINAL)
+		hold(&w->prev.u.str->count);
+	if (w->prev.isarr && w->prev.u.arr->orig == FINAL)
+		hold(&w->prev.u.arr->count);
+
+	for (; p != par->body; p = N2(p)) {
+		if (N1(p)->u.narg == PAROUT)
+			continue;
+		w->currsymtab = installlocalsym(p->u.name->s, w->currsymtab);
+		w->currsymtab->u.val = identity(N1(p)->u.narg);
+	}
+	w->currsymtab = w->parvar = installlocalsym(var->s, w->currsymtab);
+	return w;
+}
+
+/* free worker w and drop the references it holds; called by its parent */
+static void
+freeworker(Hoc *w)
+{
+	Hoc *parent;
+	Symbol *sym;
+	Frame *f;
+
+	parent = hoc;
+	hoc = w;
+	waittasks();
+	while ((f = w->frame.head) != NULL) {
+		w->frame.head = f->next;
+		if (f->local)
+			freesymtab(&f->local);
+		free(f);
+	}
+	for (sym = w->parvar; sym; sym = sym->next)
+		if (sym->isstr)
+			dfree(sym->u.str);
+	freesymtab(&w->parvar);
+	if (w->prev.isstr)
+		dfree(w->prev.u.str);
+	if (w->prev.isarr)
+		arrfree(w->prev.u.arr);
+	freearrays(&w->autoarrays);
+	freearrays(&w->finalarrays);
+	freestrings(&w->autostrings);
+	freestrings(&w->finalstrings);
+	freestack();
+	hoc = parent;
+	hoc->stats.ninsts += w->stats.ninsts;
+	hoc->stats.nmalloc += w->stats.nmalloc;
+	hoc->stats.mallocbytes += w->stats.mallocbytes;
+	if (w->exceeded)
+		hoc->exceeded = 1;
+	free(w);
+}
+
+/* run the iterations from i to j - 1 of parallel loop par in the current worker */
+static void
+runiters(Par *par, size_t i, size_t j)
+{
+	for (; i < j; i++) {
+		hoc->parvar->u.val = par->lo + (double)i;
+		execute(par->body);
+		hoc->continuing = 0;
+		freearrays(&hoc->autoarrays);
+		freestrings(&hoc->autostrings);
+		SAFEPOINT();
+	}
+}
+
+/* run the iterations from i to j - 1 of parallel loop arg in its worker k, in a thread of the pool; return 1 on error */
+static int
+runpar(void *arg, size_t k, size_t i, size_t j)
+{
+	Par *par;
+	Hoc *save;
+
+	par = arg;
+	save = hoc;
+	hoc = par->workers[k];
+	if (setjmp(hoc->errors.begin)) {
+		hoc = save;
+		return 1;
+	}
+	runiters(par, i, j);
+	hoc = save;
+	return 0;
+}
+
+/*
+ * run a parallel loop.  Its iterations are split among workers (see
+ * newworker()), each run by a thread of the pool, which have datum and
+ * frame stacks and locals of their own, but share the program, names
+ * and globals of the parent, which waits for them.  The compiler made
+ * sure the body assigns no variable but the reduction variables and
+ * the parameters of its function, and no element but those of the
+ * outputs; the functions it calls are checked as they run.  While the
+ * loop runs, the arrays of the parent are marked shared, so workers
+ * only read them, but for assigning numbers to elements of the outputs.
+ * At the end, the loop variable is left as a serial loop leaves it, and
+ * each reduction variable is combined with those of the workers.
+ */
+void
+parforcode(void)
+{
+	Inst *savepc, *p, *clauses;
+	Symbol *sym;
+	Array *a;
+	Datum lo, hi;
+	Par par;
+	Hoc *w;
+	double n;
+	size_t i, nw;
+	int e, failed;
+
+	savepc = hoc->prog.pc;
+	hi = popnum();
+	lo = popnum();
+	n = hi.u.val - lo.u.val;
+	n = N1(savepc)->u.narg ? floor(n) + 1.0 : ceil(n);
+	if (!(n > 0.0))
+		n = 0.0;
+	if (n > 9007199254740992.0)
+		yyerror("parallel loop of too many iterations");
+	par.body = N2(savepc)->u.ip;
+	par.lo = lo.u.val;
+	par.nouts = 0;
+	clauses = N4(savepc);
+
+	/* the variable holds lo until the loop is done, as after a failed one */
+	sym = assignsym(savepc->u.name, 0);
+	if (sym->isstr)
+		dfree(sym->u.str);
+	if (sym->isarr)
+		arrfree(sym->u.arr);
+	sym->u.val = lo.u.val;
+	sym->isstr = sym->isarr = 0;
+
+	/* the outputs must be arrays of numbers, and the reduction variables numbers */
+	for (p = clauses; p != par.body; p = N2(p))
+		if (N1(p)->u.narg == PAROUT)
+			par.nouts++;
+		else
+			(void)assignsym(p->u.name, 1);
+	par.outs = emalloc((par.nouts ? par.nouts : 1) * sizeof *par.outs);
+	for (i = 0, p = clauses; p != par.body; p = N2(p)) {
+		if (N1(p)->u.narg != PAROUT)
+			continue;
+		a = par.outs[i++] = getarr(p->u.name);
+		if (a->map || !packarr(a)) {
+			free(par.outs);
+			yyerror("%s: parallel loop output is no array of numbers", p->u.name->s);
+		}
+		if (isshared(a) && !isout(a)) {
+			free(par.outs);
+			yyerror("%s: parallel code changes a shared array", p->u.name->s);
+		}
+	}
+
+	/* profiles and traces are made by a single thread, as are nested loops */
+	nw = (hoc->parent || profiling || tracing) ? 1 : poolsize() + 1;
+	if (nw > n)
+		nw = (size_t)n;
+	par.workers = emalloc((nw ? nw : 1) * sizeof *par.workers);
+	for (i = 0; i < nw; i++)
+		par.workers[i] = newworker(&par, savepc->u.name, clauses);
+	sharearrays(1);
+	e = poolfor((size_t)n, nw, runpar, &par);
+	sharearrays(0);
+
+	/* the error of the first worker that failed is that of the loop */
+	for (failed = 0, i = 0; i < nw && !failed; i++) {
+		if ((failed = par.workers[i]->errors.n > 0))
+			memcpy(hoc->errors.msg, par.workers[i]->errors.msg, sizeof hoc->errors.msg);
+	}
+	for (i = 0; i < nw; i++) {
+		w = par.workers[i];
+		for (p = clauses; !failed && p != par.body; p = N2(p)) {
+			if (N1(p)->u.narg == PAROUT)
+				continue;
+			sym = assignsym(p->u.name, 1);
+			sym->u.val = reduce(N1(p)->u.narg, sym->u.val,
+			                    lookupsym(w->currsymtab, p->u.name->s)->u.val);
+		}
+		freeworker(w);
+	}
+	free(par.workers);
+	free(par.outs);
+	if (failed)
+		passerror(hoc->errors.msg);
+	if (e == ENOMEM)
+		yyerror("out of memory");
+	assignsym(savepc->u.name, 1)->u.val = lo.u.val + n;
+	hoc->prog.pc = N3(savepc)->u.ip;
+}
+
+void
+breakcode(void)
+{
+	hoc->breaking = 1;
+}
+
+void
+continuecode(void)
+{
+	hoc->continuing = 1;
+}
+
+/* get random from 0 to 1 */
+static double
+Random(void)
+{
+	return (double)rand() / RAND_MAX;
+}
+
+/* get integer part of double */
+static double
+Integer(double n)
+{
+	return (double)(long)n;
+}
+
+/* check result of library call */
+static double
+errcheck(double d, const char *s)
+{
+	if (errno == EDOM) {
+		errno = 0;
+		yyerror("%s: argument out of domain", s);
+	}
+	if (errno == ERANGE) {
+		errno = 0;
+		yyerror("%s: result out of range", s);
+	}
+	return d;
+}
+
+/* push a new array of the bltin i of each element of the array on top of stack */
+static void
+mapbltin(int i)
+{
+	Array *a, *c;
+
+	a = popnumarr(bltins[i].s);
+	c = newarr(a->len);
+	c->cols = a->cols;
+	errno = vecmath(bltins[i].vec, a->val, c->val, a->len);
+	(void)errcheck(0.0, bltins[i].s);
+	pusharr(c);
+}
+
+/* evaluate built-in on top of stack */
+void
+bltin(void)
+{
+	Datum d1, d2;
+	Name *name;
+	int narg, i;
+
+	name = getnamearg();
+	i = name->u.bltin;
+	if (bltins[i].n == -2) {
+		(*bltins[i].u.fs)();
+		return;
+	}
+	narg = getintarg();
+	if (narg == 0 && bltins[i].n == -1)
+		narg = -1;
+	if (narg != bltins[i].n)
+		yyerror("%s: wrong arity", bltins[i].s);
+	errno = 0;
+	switch (narg) {
+	case -1:
+		d1.u.val = bltins[i].u.d;
+		break;
+	case 0:
+		d1.u.val = (*bltins[i].u.f0)();
+		break;
+	case 1:
+		if (hoc->stack != NULL && hoc->stack->isarr) {
+			mapbltin(i);
+			return;
+		}
+		d1 = popnum();
+		d1.u.val = (*bltins[i].u.f1)(d1.u.val);
+		break;
+	case 2:
+		d2 = popnum();
+		d1 = popnum();
+		d1.u.val = (*bltins[i].u.f2)(d1.u.val, d2.u.val);
+		break;
+	}
+	d1.u.val = errcheck(d1.u.val, bltins[i].s);
+	d1.isstr = d1.isarr = 0;
+	push(d1);
+}
+
+/* check if function or procedure is definable */
 void
-ge(void)
+verifydef(Name *name, int type)
 {
-	Datum d1, d2;
-
-	d2 = popnum();
-	d1 = popnum();
-	d1.u.val = (double)(d1.u.val >= d2.u.val);
-	push(d1);
+	if (name->type != UNDEF)
+		yyerror("assigning %s to an already used name: %d",
+		        (type == FUNCTION) ? "function" : "procedure",
+		        name->type);
+	name->type = type;
+	name->u.fun = NULL;     /* not defined until its whole code is parsed */
 }
 
+/* put function or procedure in symbol table */
 void
-lt(void)
+define(Name *name, Name *params)
 {
-	Datum d1, d2;
+	if (DEBUG)
+		debug();
+	defineat(name, params, hoc->prog.base);      /* start of code */
+	name->u.fun->lineoff = hoc->lines.baselen;
+	name->u.fun->prevline = hoc->lines.baseline;
+	name->u.fun->pure = ispure(name, hoc->prog.base, hoc->prog.progp);
+	name->u.fun->inlen = inlinelen(name, hoc->prog.base, hoc->prog.progp);
+	if (hoc->optimizing)
+		optloops(hoc->prog.base, hoc->prog.progp);
+	keepcode();                             /* next code starts here */
+}
 
-	d2 = popnum();
-	d1 = popnum();
-	d1.u.val = (double)(d1.u.val < d2.u.val);
-	push(d1);
+/* tell whether s is the name of one of params */
+static int
+isparam(Name *params, const char *s)
+{
+	for (; params; params = params->next)
+		if (strcmp(params->s, s) == 0)
+			return 1;
+	return 0;
+}
+
+/*
+ * tell whether the code of function name, from p to end, is pure: it
+ * reads and writes only its parameters, does no I/O, does not call
+ * rand(), stats(), a function making an array or sketch, nor axpy(),
+ * add() or merge(), does not assign array elements, and calls only
+ * pure functions and itself
+ */
+static int
+ispure(Name *name, Inst *p, Inst *end)
+{
+	void (*f)(void);
+	Name *n;
+	int i;
+
+	for (; p && p != end; p = p->next) {
+		if (p->type != OPR || (f = p->u.opr) == NULL)
+			continue;
+		if (f == println || f == _print || f == _printf ||
+		    f == readnum || f == readline || f == prevpush)
+			return 0;
+		if (f == forincode && !isparam(name->u.fun->params, N2(p)->u.name->s))
+			return 0;
+		if (p->next == end || p->next->type != NAME)
+			continue;
+		n = p->next->u.name;
+		if (f == call) {
+			if (n != name && !n->u.fun->pure)
+				return 0;
+		} else if (f == bltin) {
+			i = n->u.bltin;
+			if (bltins[i].n == 0 || (bltins[i].n == -2 &&
+			    (bltins[i].u.fs == _stats || bltins[i].u.fs == _array ||
+			     bltins[i].u.fs == _map || bltins[i].u.fs == _matrix ||
+			     bltins[i].u.fs == _axpy || bltins[i].u.fs == _welford ||
+			     bltins[i].u.fs == _histogram || bltins[i].u.fs == _kll ||
+			     bltins[i].u.fs == _add || bltins[i].u.fs == _merge ||
+			     bltins[i].u.fs == _wait)))
+				return 0;       /* rand, stats, makers of arrays, those changing them, and wait */
+		} else if (f == elemassign || !isparam(name->u.fun->params, n->s)) {
+			return 0;
+		}
+	}
+	return 1;
 }
 
+/* cache the results of function name, which must be pure */
 void
-le(void)
+memoize(Name *name)
 {
-	Datum d1, d2;
+	if (!name->u.fun->pure)
+		yyerror("%s: memo function is not pure", name->s);
+	if (name->u.fun->nparams > MEMOARGS)
+		yyerror("%s: memo function has more than %d parameters", name->s, MEMOARGS);
+	name->u.fun->memo = 1;
+}
 
-	d2 = popnum();
-	d1 = popnum();
-	d1.u.val = (double)(d1.u.val <= d2.u.val);
-	push(d1);
+/* cache the results of every pure function */
+void
+memoizeall(void)
+{
+	hoc->memoall = 1;
 }
 
+/* inline calls of small functions and procedures, and optimize loops */
 void
-eq(void)
+optimize(void)
 {
-	Datum d1, d2;
+	hoc->optimizing = 1;
+}
 
-	d2 = popnum();
-	d1 = popnum();
-	d1.u.val = (double)(d1.u.val == d2.u.val);
-	push(d1);
+/* tell whether calls are inlined and loops optimized */
+int
+getoptimize(void)
+{
+	return hoc->optimizing;
+}
+
+/* get the depth on the stack of the argument for parameter s, at the top of the arguments */
+static int
+paramdepth(Name *params, const char *s)
+{
+	int i, depth;
+
+	/* the last of a repeated parameter hides the others */
+	for (depth = -1, i = 0; params; params = params->next, i++)
+		if (strcmp(params->s, s) == 0)
+			depth = i;
+	return depth;
+}
+
+/* get how many values the operation at p in the code of name pushes (or pops, if negative); NOINLINE if it cannot be inlined */
+static int
+stackeffect(Name *name, Inst *p)
+{
+	void (*f)(void);
+
+	f = p->u.opr;
+	if (f == constpush || f == strpush || f == prevpush || f == argpush)
+		return 1;
+	if (f == cmdarg || f == negate || f == not)
+		return 0;
+	if (f == add || f == sub || f == mul || f == divd || f == mod ||
+	    f == power || f == gt || f == ge || f == lt || f == le ||
+	    f == eq || f == ne || f == oprpop || f == println)
+		return -1;
+	if (f == _print || f == _printf || f == argret || f == argpop)
+		return -N1(p)->u.narg;
+	if (f == bltin)
+		return 1 - N2(p)->u.narg;
+	if (f == call && N1(p)->u.name != name)
+		return (N1(p)->u.name->type == FUNCTION) - N2(p)->u.narg;
+	if (f == eval && paramdepth(name->u.fun->params, N1(p)->u.name->s) >= 0)
+		return 1;
+	return NOINLINE;
+}
+
+/*
+ * get the number of instructions of the code of name, from p to end,
+ * that are copied when a call to it is inlined, or 0 if it cannot be
+ * inlined: the code must be straight, be at most INLINEMAX instructions
+ * long, use no variable but reading its parameters, not call itself,
+ * and end in a single return.
+ */
+static int
+inlinelen(Name *name, Inst *p, Inst *end)
+{
+	int n, d, e;
+
+	for (n = d = 0; p && p != end; p = p->next, n++) {
+		if (n > INLINEMAX)
+			return 0;
+		if (p->type != OPR)
+			continue;
+		if (p->u.opr == funcret || p->u.opr == procret)
+			break;
+		if (p->u.opr == NULL || (e = stackeffect(name, p)) == NOINLINE)
+			return 0;
+		d += e;
+	}
+	if (p == NULL || p == end)
+		return 0;
+	if (name->type == FUNCTION && p->u.opr == funcret && d == 1 && N2(p) == end)
+		return n;
+	if (name->type == PROCEDURE && d == 0 && (N1(p) == end || N2(p) == end))
+		return n;
+	return 0;
 }
 
+/* generate a call of name with narg arguments; copy its code instead if it can be inlined */
 void
-ne(void)
+callcode(Name *name, int narg)
 {
-	Datum d1, d2;
+	Function *fun;
+	Linepos pos;
+	Inst *p;
+	int i, d, saveline;
 
-	d2 = popnum();
-	d1 = popnum();
-	d1.u.val = (double)(d1.u.val != d2.u.val);
-	push(d1);
+	fun = name->u.fun;
+	if (!hoc->optimizing || fun == NULL || fun->inlen == 0 || fun->memo || narg != fun->nparams) {
+		code((Inst){.type = OPR, .u.opr = call});
+		code((Inst){.type = NAME, .u.name = name});
+		code((Inst){.type = NARG, .u.narg = narg});
+		return;
+	}
+
+	/* the copies keep the lines of the code of the function */
+	if (fun->lineoff == SIZE_MAX) {
+		lineat(&pos, hoc->prog.head, 0, 0);
+		lineseek(&pos, fun->code);
+	} else {
+		lineat(&pos, fun->code, fun->lineoff, fun->prevline);
+	}
+	saveline = toklineno;
+
+	/* the arguments stay on the stack, where parameters are read from */
+	for (d = i = 0, p = fun->code; i < fun->inlen; i++, p = p->next) {
+		lineseek(&pos, p);
+		toklineno = pos.line;
+		if (p->type == OPR && p->u.opr == eval) {
+			code((Inst){.type = OPR, .u.opr = argpush});
+			code((Inst){.type = NARG, .u.narg = d + paramdepth(fun->params, N1(p)->u.name->s)});
+			d++;
+			p = p->next;
+			i++;
+			continue;
+		}
+		if (p->type == OPR)
+			d += stackeffect(name, p);
+		code(*p);
+	}
+	toklineno = saveline;
+	code((Inst){.type = OPR, .u.opr = (name->type == FUNCTION) ? argret : argpop});
+	code((Inst){.type = NARG, .u.narg = narg});
+}
+
+/* get the instruction n instructions after p */
+static Inst *
+skip(Inst *p, int n)
+{
+	while (p && n-- > 0)
+		p = p->next;
+	return p;
+}
+
+/* tell whether the operation f assigns the variable given as its operand */
+static int
+assigns(void (*f)(void))
+{
+	return f == assign || f == addeq || f == subeq || f == muleq ||
+	       f == diveq || f == modeq || f == preinc || f == predec ||
+	       f == postinc || f == postdec || f == readnum || f == readline ||
+	       f == forincode || f == parforcode;
+}
+
+/* the variables assigned in a loop */
+typedef struct Varset {
+	Name **v;
+	size_t n, size;
+	int all;                /* an impure call may assign any variable */
+} Varset;
+
+/* tell whether the variable name is in set */
+static int
+inset(Varset *set, Name *name)
+{
+	size_t i;
+
+	if (set->all)
+		return 1;
+	for (i = 0; i < set->n; i++)
+		if (set->v[i] == name)
+			return 1;
+	return 0;
+}
+
+/* add the variable name to set */
+static void
+addname(Varset *set, Name *name)
+{
+	if (set->n == set->size) {
+		set->size = set->size ? 2 * set->size : 16;
+		if ((set->v = realloc(set->v, set->size * sizeof *set->v)) == NULL)
+			yyerror("out of memory");
+	}
+	set->v[set->n++] = name;
+}
+
+/* collect the variables assigned by the code from p to end, and count the assignments of var */
+static int
+assigned(Varset *set, Inst *p, Inst *end, Name *var)
+{
+	Name *n;
+	int count;
+
+	for (count = 0; p && p != end; p = p->next) {
+		if (p->type != OPR || p->u.opr == NULL)
+			continue;
+		if (p->u.opr == call) {
+			n = N1(p)->u.name;
+			if (n->u.fun == NULL || !n->u.fun->pure)
+				set->all = 1;
+			continue;
+		}
+		if (!assigns(p->u.opr))
+			continue;
+		n = N1(p)->u.name;
+		if (n == var)
+			count++;
+		if (!inset(set, n))
+			addname(set, n);
+	}
+	return count;
+}
+
+/* an expression in a loop, while looking for invariant ones */
+typedef struct Expr {
+	Inst *start;
+	int size;               /* number of instructions */
+	int inv;                /* does not change in the loop */
+	int ops;                /* computes something, not just pushes a value */
+	int num;                /* its value is a number */
+	int line;               /* line of its first instruction */
+} Expr;
+
+/*
+ * replace the invariant expression e by an invpush operation, which
+ * runs a copy of e, generated at the end of program memory, only the
+ * first time it is reached in each run of the loop
+ */
+static void
+hoist(Expr *e)
+{
+	Inst *p, *copy, *cont;
+	int i, saveline;
+
+	if (!e->inv || !e->ops || !e->num || e->size < 5)
+		return;
+	saveline = toklineno;
+	toklineno = e->line;
+	copy = getprogp();
+	for (i = 0, p = e->start; i < e->size; i++, p = p->next)
+		code(*p);
+	code((Inst){.type = OPR, .u.opr = NULL});
+	toklineno = saveline;
+	cont = skip(e->start, e->size);
+	p = e->start;
+	p->type = OPR;
+	p->u.opr = invpush;
+	p = p->next;
+	p->type = IP;
+	p->u.ip = copy;
+	p = p->next;
+	p->type = VAL;          /* the value */
+	p->u.val = 0.0;
+	p = p->next;
+	p->type = VAL;          /* the run of the loop it was computed in */
+	p->u.val = -1.0;
+	p = p->next;
+	p->type = IP;
+	p->u.ip = cont;
+}
+
+/* combine the n expressions on top of stack, of depth d, with the operation at p, of the given line, of size operands */
+static int
+combine(Expr *stack, int d, int n, Inst *p, int line, int size, int inv)
+{
+	Expr e;
+	int i;
+
+	e.start = p;
+	e.line = line;
+	e.size = size;
+	e.inv = inv;
+	e.ops = 1;
+	e.num = 1;
+	for (i = d - n; i < d; i++) {
+		if (i == d - n) {
+			e.start = stack[i].start;
+			e.line = stack[i].line;
+		}
+		e.size += stack[i].size;
+		e.inv = e.inv && stack[i].inv;
+	}
+	if (!e.inv)
+		for (i = d - n; i < d; i++)
+			hoist(&stack[i]);
+	stack[d - n] = e;
+	return d - n + 1;
+}
+
+/*
+ * hoist the maximal invariant expressions in the code from p to end out
+ * of the loop whose assigned variables are set; pos is the position of
+ * p in the line table, moved along with p for the lines of the copies
+ */
+static void
+hoistloop(Varset *set, Inst *p, Inst *end, Linepos pos)
+{
+	Expr stack[NEXPRS];
+	void (*f)(void);
+	Name *n;
+	int d, i, narg, num;
+
+	for (d = 0; p && p != end; ) {
+		lineseek(&pos, p);
+		f = (p->type == OPR) ? p->u.opr : NULL;
+		if (d == NEXPRS)
+			f = NULL;
+		if (f == constpush || f == eval) {
+			stack[d].start = p;
+			stack[d].size = 2;
+			stack[d].inv = f == constpush || !inset(set, N1(p)->u.name);
+			stack[d].ops = 0;
+			stack[d].num = 0;
+			stack[d].line = pos.line;
+			d++;
+			p = N2(p);
+		} else if (d >= 2 && (f == add || f == sub || f == mul || f == divd ||
+		           f == mod || f == power || f == gt || f == ge || f == lt ||
+		           f == le || f == eq || f == ne)) {
+			d = combine(stack, d, 2, p, pos.line, 1, 1);
+			p = p->next;
+		} else if (d >= 1 && (f == negate || f == not)) {
+			d = combine(stack, d, 1, p, pos.line, 1, 1);
+			p = p->next;
+		} else if (f == bltin && (narg = N2(p)->u.narg) <= d) {
+			i = N1(p)->u.name->u.bltin;
+			num = narg != 1 || stack[d - 1].num;
+			d = combine(stack, d, narg, p, pos.line, 3, bltins[i].n != 0 && bltins[i].n != -2);
+			stack[d - 1].num = num; /* of an array, it is an array */
+			p = N3(p);      /* not rand, nor the special ones */
+		} else if (f == call && (narg = N2(p)->u.narg) <= d &&
+		           (n = N1(p)->u.name)->type == FUNCTION && n->u.fun && n->u.fun->pure) {
+			d = combine(stack, d, narg, p, pos.line, 3, 1);
+			stack[d - 1].num = 0;   /* it may return a string */
+			p = N3(p);
+		} else {
+			/* anything else ends the expressions being built */
+			while (d > 0)
+				hoist(&stack[--d]);
+			p = (f == invpush) ? N4(p)->u.ip : p->next;
+		}
+	}
+	while (d > 0)
+		hoist(&stack[--d]);
+}
+
+/*
+ * turn the for loop at p into a counted loop, if its condition
+ * compares a variable with a bound that does not change in the loop,
+ * its step increments or decrements the variable, and nothing else
+ * in the loop assigns the variable
+ */
+static void
+countloop(Inst *p, Inst *end)
+{
+	Varset set = {NULL, 0, 0, 0};
+	Inst *c, *s, *b, *cmp;
+	Name *var;
+	void (*f)(void);
+
+	c = N1(p)->u.ip;
+	s = N2(p)->u.ip;
+	if (c == NULL || s == NULL || c->u.opr != eval)
+		return;
+	var = N1(c)->u.name;
+	b = N2(c);
+	if (assigned(&set, c, end, var) != 1 || set.all)
+		goto done;
+	if (b->u.opr == constpush)
+		cmp = N2(b);
+	else if (b->u.opr == eval && N1(b)->u.name != var && !inset(&set, N1(b)->u.name))
+		cmp = N2(b);
+	else if (b->u.opr == invpush)
+		cmp = N4(b)->u.ip;
+	else
+		goto done;
+	f = cmp->u.opr;
+	if (cmp->type != OPR || (f != lt && f != le && f != gt && f != ge && f != ne) ||
+	    cmp->next->type != OPR || cmp->next->u.opr != NULL)
+		goto done;
+	f = s->u.opr;
+	if (s->type != OPR || (f != postinc && f != preinc && f != postdec && f != predec) ||
+	    N1(s)->u.name != var || N2(s)->type != OPR || N2(s)->u.opr != NULL)
+		goto done;
+
+	/* the condition becomes: comparison, variable, bound, end */
+	c->u.opr = cmp->u.opr;
+	cmp->u.opr = NULL;
+	p->u.opr = countcode;
+done:
+	free(set.v);
 }
 
+/* optimize the loops in the code from p, at or after prog.base, to end: hoist invariant expressions, and count simple for loops */
+static void
+optloops(Inst *p, Inst *end)
+{
+	Varset set;
+	Linepos pos, *loops;
+	Inst *q, *e;
+	size_t n, size;
+
+	if (p == NULL || p == end || hoc->prog.base == hoc->prog.progp)
+		return;
+	lineat(&pos, hoc->prog.base, hoc->lines.baselen, hoc->lines.baseline);
+	loops = NULL;
+	for (n = size = 0, q = p; q && q != end; q = q->next) {
+		if (q->type != OPR || (q->u.opr != forcode && q->u.opr != whilecode &&
+		    q->u.opr != docode && q->u.opr != forincode))
+			continue;
+		if (n == size) {
+			size = size ? 2 * size : 16;
+			if ((loops = realloc(loops, size * sizeof *loops)) == NULL)
+				yyerror("out of memory");
+		}
+		lineseek(&pos, q);
+		loops[n++] = pos;
+	}
+
+	/* inner loops, which come after the outer ones, first */
+	while (n-- > 0) {
+		q = loops[n].p;
+		set.v = NULL;
+		set.n = set.size = set.all = 0;
+		if (q->u.opr == forcode) {
+			e = N4(q)->u.ip;
+			/* the condition, step and body, whichever comes first */
+			if ((p = N1(q)->u.ip) == NULL && (p = N2(q)->u.ip) == NULL)
+				p = N3(q)->u.ip;
+			(void)assigned(&set, p, e, NULL);
+		} else if (q->u.opr == forincode) {
+			e = N4(q)->u.ip;
+			(void)assigned(&set, q, e, NULL);
+		} else {
+			e = N2(q)->u.ip;
+			(void)assigned(&set, q, e, NULL);
+		}
+		hoistloop(&set, q, e, loops[n]);
+		free(set.v);
+		if (q->u.opr == forcode)
+			countloop(q, e);
+	}
+	free(loops);
+}
+
+/* get the kind of the clause of the parallel loop at p naming name, or -1 */
+static int
+parclause(Inst *p, Name *name)
+{
+	Inst *c;
+
+	for (c = N4(p)->next; c != N3(p)->u.ip; c = N2(c))
+		if (c->u.name == name)
+			return N1(c)->u.narg;
+	return -1;
+}
+
+/*
+ * error if the parallel loop at p, in the definition of a function of
+ * parameters params, has a clause naming its variable or a name named
+ * before, or if its body assigns variables other than the reduction
+ * variables and the parameters, or elements of arrays other than the
+ * outputs and the parameters.  The parameters it assigns are made
+ * variables now, so the workers do not change names.
+ */
 void
-not(void)
+verifypar(Inst *p, Name *params)
 {
-	Datum d;
+	Inst *q, *c, *end;
+	Name *name;
+	int kind;
+
+	for (q = N4(p)->next; q != N3(p)->u.ip; q = N2(q)) {
+		if (q->u.name == N1(p)->u.name)
+			yyerror("%s: variable of parallel loop in its clauses", q->u.name->s);
+		for (c = N4(p)->next; c != q; c = N2(c))
+			if (c->u.name == q->u.name)
+				yyerror("%s: repeated in parallel loop clauses", q->u.name->s);
+	}
+	end = N4(p)->u.ip;
+	for (q = N3(p)->u.ip; q && q != end; q = q->next) {
+		if (q->type != OPR || q->u.opr == NULL)
+			continue;
+		if (q->u.opr != elemassign && !assigns(q->u.opr))
+			continue;
+		name = N1(q)->u.name;
+		if (isparam(params, name->s)) {
+			if (name->type == UNDEF)
+				name->type = VAR;
+			continue;
+		}
+		kind = parclause(p, name);
+		if (q->u.opr == elemassign && kind != PAROUT)
+			yyerror("parallel loop assigns elements of %s", name->s);
+		if (q->u.opr != elemassign && (kind < 0 || kind == PAROUT))
+			yyerror("parallel loop assigns %s", name->s);
+	}
+}
 
-	d = popnum();
-	d.u.val = (double)(!d.u.val);
-	push(d);
+/* optimize the code just generated, from prog.base */
+void
+optcode(void)
+{
+	if (hoc->optimizing)
+		optloops(hoc->prog.base, hoc->prog.progp);
 }
 
+/* put function or procedure whose code starts at code in symbol table */
 void
-and(void)
+defineat(Name *name, Name *params, Inst *code)
+{
+	Function *fun;
+	int n;
+
+	fun = emalloc(sizeof *fun);
+	fun->code = code;
+	fun->params = params;
+	for (n = 0; params; params = params->next)
+		n++;
+	fun->nparams = n;
+	fun->pure = fun->memo = 0;
+	fun->inlen = 0;
+	fun->lineoff = SIZE_MAX;
+	fun->prevline = 0;
+	fun->cache = NULL;
+	name->u.fun = fun;
+}
+
+/* call function name, whose nargs arguments are on the stack */
+static void
+invoke(Name *name, int nargs)
 {
+	Symbol *local;
+	Frame *f;
 	Datum d;
-	Inst *savepc;
+	Name *tmp;
 
-	savepc = prog.pc;
-	d = popnum();
-	if (d.u.val) {
-		execute(savepc->u.ip);
-		d = popnum();
+	if (!hoc->frame.next->next) {
+		f = emalloc(sizeof *f);
+		f->next = NULL;
+		f->name = NULL;
+		f->local = NULL;
+		hoc->frame.next->next = f;
 	}
-	d.u.val = d.u.val ? 1.0 : 0.0;
-	push(d);
-	prog.pc = N1(savepc)->u.ip;
+	f = hoc->frame.next;
+	f->name = name;
+	f->retpc = hoc->prog.pc;
+	hoc->frame.tail = hoc->frame.next = hoc->frame.next->next;
+	hoc->frame.next->prev = f;
+	if (nargs > name->u.fun->nparams)
+		yyerror("function %s called with wrong number of parameters", name->s);
+	nargs = name->u.fun->nparams - nargs;
+	local = NULL;
+	for (tmp = name->u.fun->params; tmp; tmp = tmp->next) {
+		if (nargs > 0) {
+			d.u.val = 0.0;
+			d.isstr = d.isarr = 0;
+			nargs--;
+		} else {
+			d = pop();
+		}
+		local = installlocalsym(tmp->s, local);
+		local->u = d.u;
+		local->isstr = d.isstr;
+		local->isarr = d.isarr;         /* arrays are passed by reference */
+		if (d.isarr)
+			movarr(d.u.arr);
+	}
+	f->retsymtab = hoc->currsymtab;
+	hoc->currsymtab = f->local = local;
+	hoc->frame.curr = f;                 /* the sampler may read it at any time */
+	if (++hoc->stats.frames > hoc->stats.maxframes)
+		hoc->stats.maxframes = hoc->stats.frames;
+	SAFEPOINT();
+	if (profiling || tracing) {
+		if (profiling)
+			profcall(name);
+		if (tracing)
+			tracebegin(name->s, name->type == FUNCTION ? "func" : "proc", 0);
+		execute(name->u.fun->code);
+		if (tracing)
+			traceend();
+		if (profiling)
+			profret();
+	} else {
+		execute(name->u.fun->code);
+	}
+	hoc->returning = 0;
 }
 
-void
-or(void)
+/* get the arguments of a call of fun as a key for its cache, in the order call() pops them */
+static int
+memokey(Function *fun, int nargs, double *key)
 {
-	Datum d;
-	Inst *savepc;
+	Datum *p;
+	int i;
 
-	savepc = prog.pc;
-	d = popnum();
-	if (!d.u.val) {
-		execute(savepc->u.ip);
-		d = popnum();
+	if (nargs > fun->nparams)
+		return 0;
+	for (i = 0; i < fun->nparams - nargs; i++)
+		key[i] = 0.0;
+	for (p = hoc->stack; i < fun->nparams; i++, p = p->next) {
+		if (p == NULL || p->isstr || p->isarr)
+			return 0;
+		key[i] = p->u.val;
 	}
-	d.u.val = d.u.val ? 1.0 : 0.0;
-	push(d);
-	prog.pc = N1(savepc)->u.ip;
+	return 1;
 }
 
-static double
-cond(Inst *pc)
+/* allocate the cache of fun; return NULL if out of memory */
+static Memo *
+newmemo(Function *fun)
+{
+	Memo *m;
+
+	if ((m = malloc(sizeof *m)) == NULL)
+		return NULL;
+	m->slots = malloc(MEMOSIZE * (fun->nparams + 1) * sizeof *m->slots);
+	m->used = calloc(MEMOSIZE, 1);
+	if (m->slots == NULL || m->used == NULL) {
+		free(m->slots);
+		free(m->used);
+		free(m);
+		return NULL;
+	}
+	m->hits = m->misses = 0;
+	hoc->stats.nmalloc += 2;
+	hoc->stats.mallocbytes += sizeof *m + MEMOSIZE * (fun->nparams + 1) * sizeof *m->slots;
+	return fun->cache = m;
+}
+
+/* lock the caches of memo functions, if other threads may use them */
+static void
+lockmemo(void)
 {
-	Datum d;
+	if (concurrent())
+		pthread_mutex_lock(&memolock);
+}
 
-	if (pc == NULL)
-		return 1.0;
-	execute(pc);
-	d = popnum();
-	return d.u.val;
+/* unlock the caches of memo functions, if other threads may use them */
+static void
+unlockmemo(void)
+{
+	if (concurrent())
+		pthread_mutex_unlock(&memolock);
 }
 
-static Datum
-execpop(Inst *pc)
+/* call memo function name, taking its value from the cache if possible */
+static void
+memocall(Name *name, int nargs)
 {
+	Function *fun;
+	Memo *m;
 	Datum d;
+	double key[MEMOARGS], *slot;
+	uint64_t h;
+	size_t i, n, len;
 
-	if (pc && pc->u.opr) {
-		execute(pc);
-		d = popnum();
-	} else {
-		d.u.val = 0.0;
+	fun = name->u.fun;
+	if (!memokey(fun, nargs, key)) {
+		invoke(name, nargs);
+		return;
+	}
+	lockmemo();
+	if ((m = fun->cache) == NULL && (m = newmemo(fun)) == NULL) {
+		unlockmemo();
+		yyerror("out of memory");
+	}
+	n = fun->nparams;
+	len = n * sizeof *key;
+	h = 14695981039346656037ULL;            /* FNV-1a */
+	for (i = 0; i < len; i++)
+		h = (h ^ ((unsigned char *)key)[i]) * 1099511628211ULL;
+	i = h & (MEMOSIZE - 1);
+	slot = m->slots + i * (n + 1);
+	if (m->used[i] && memcmp(slot, key, len) == 0) {
+		m->hits++;
+		d.u.val = slot[n];
+		unlockmemo();
+		while (nargs-- > 0)
+			(void)pop();
+		d.isstr = d.isarr = 0;
+		push(d);
+		return;
+	}
+	m->misses++;
+	unlockmemo();
+	invoke(name, nargs);
+	if (hoc->stack && !hoc->stack->isstr && !hoc->stack->isarr) {
+		lockmemo();
+		memcpy(slot, key, len);
+		slot[n] = hoc->stack->u.val;
+		m->used[i] = 1;
+		unlockmemo();
 	}
-	return d;
 }
 
-void
-ifcode(void)
+/* call function or procedure name, whose nargs arguments are on the stack */
+static void
+callname(Name *name, int nargs)
 {
-	Datum d;
-	Inst *savepc;
-
-	savepc = prog.pc;                       /* then part */
-	d = execpop(N3(savepc));
-	if (d.u.val)
-		execute(savepc->u.ip);
-	else if (N1(savepc)->u.ip)              /* else part? */
-		execute(N1(savepc)->u.ip);
-	if (!returning)
-		prog.pc = N2(savepc)->u.ip;     /* next statement */
+	if (name->type != FUNCTION && name->type != PROCEDURE)
+		yyerror("%s is not function nor procedure", name->s);
+	if (name->u.fun == NULL)
+		yyerror("%s is not defined", name->s);
+	if (name->type == FUNCTION && name->u.fun->nparams <= MEMOARGS &&
+	    (name->u.fun->memo || (hoc->memoall && name->u.fun->pure)))
+		memocall(name, nargs);
+	else
+		invoke(name, nargs);
 }
 
+/* call a function */
 void
-docode(void)
+call(void)
 {
-	Inst *savepc;
+	Name *name;
 
-	savepc = prog.pc;
-	do {
-		execute(N2(savepc));
-		if (returning) {
-			break;
-		}
-		if (continuing) {
-			continuing = 0;
-			continue;
-		}
-		if (breaking) {
-			breaking = 0;
-			break;
-		}
-	} while (cond(savepc->u.ip));
-	if (!returning)
-		prog.pc = N1(savepc)->u.ip;
+	name = getnamearg();
+	callname(name, getintarg());
 }
 
+/* call function or procedure s with the n numbers args, from outside the machine, and store the value of a function into v */
 void
-whilecode(void)
+callbyname(const char *s, const double *args, int n, double *v)
 {
-	Inst *savepc;
+	Name *name;
+	Datum d;
+	int i;
 
-	savepc = prog.pc;
-	while (cond(N2(savepc))) {
-		execute(savepc->u.ip);
-		if (returning) {
-			break;
-		}
-		if (continuing) {
-			continuing = 0;
-			continue;
-		}
-		if (breaking) {
-			breaking = 0;
-			break;
-		}
+	hoc->prog.pc = &hoc->stop;      /* where the call returns to */
+	if ((name = lookupname(s)) == NULL)
+		yyerror("%s is not function nor procedure", s);
+	d.isstr = d.isarr = 0;
+	for (i = 0; i < n; i++) {
+		d.u.val = args[i];
+		push(d);
+	}
+	callname(name, n);
+	*v = 0.0;
+	if (name->type == FUNCTION) {
+		d = pop();
+		if (d.isstr || d.isarr)
+			yyerror("%s returns no number", s);
+		*v = d.u.val;
 	}
-	if (!returning)
-		prog.pc = N1(savepc)->u.ip;
 }
 
-void
-forcode(void)
+/* find global variable s, or return NULL */
+Symbol *
+lookupvar(const char *s)
 {
-	Inst *savepc;
-
-	savepc = prog.pc;
-	for ((void)execpop(N4(savepc)); cond(savepc->u.ip); (void)execpop(N1(savepc)->u.ip)) {
-		execute(N2(savepc)->u.ip);
-		if (returning) {
-			break;
-		}
-		if (continuing) {
-			continuing = 0;
-			continue;
-		}
-		if (breaking) {
-			breaking = 0;
-			break;
-		}
-	}
-	if (!returning)
-		prog.pc = N3(savepc)->u.ip;
+	return lookupsym(hoc->global, s);
 }
 
-void
-breakcode(void)
+/* keep datum d, an argument or global read by a task, until the task is freed; arrays are shared meanwhile */
+static void
+pin(Datum d)
 {
-	breaking = 1;
+	if (d.isstr) {
+		movstr(d.u.str);
+	} else if (d.isarr) {
+		movarr(d.u.arr);
+		(void)packarr(d.u.arr);         /* reading it must not change it */
+		share(d.u.arr, 1);
+	}
 }
 
-void
-continuecode(void)
+/* drop datum d, kept by pin() */
+static void
+unpin(Datum d)
 {
-	continuing = 1;
+	if (d.isstr) {
+		dfree(d.u.str);
+	} else if (d.isarr) {
+		share(d.u.arr, -1);
+		arrfree(d.u.arr);
+	}
 }
 
-/* get random from 0 to 1 */
-static double
-Random(void)
+/*
+ * collect into vars the globals the code of function fun may read, and
+ * that of the functions it calls, which are collected into funs.  The
+ * parameters it assigns are made variables now, as the task would make
+ * them, so it does not change names while its parent parses.
+ */
+static void
+readglobals(Varset *vars, Varset *funs, Name *fun)
 {
-	return (double)rand() / RAND_MAX;
+	Inst **starts, **v, *p;
+	Name *n;
+	size_t i, j, nstarts, size;
+	int t;
+
+	addname(funs, fun);
+	starts = NULL;
+	nstarts = size = 0;
+	p = fun->u.fun->code;
+	for (i = 0; ; p = starts[i++]) {
+		/* the code from p to the next STOP or return, and that it jumps to */
+		for (; p && !(p->type == OPR && (p->u.opr == NULL ||
+		     p->u.opr == funcret || p->u.opr == procret)); p = p->next) {
+			if (p->type == IP && p->u.ip) {
+				for (j = 0; j < nstarts && starts[j] != p->u.ip; j++)
+					;
+				if (j < nstarts)
+					continue;
+				if (nstarts == size) {
+					size = size ? 2 * size : 16;
+					if ((v = realloc(starts, size * sizeof *v)) == NULL) {
+						free(starts);
+						yyerror("out of memory");
+					}
+					starts = v;
+				}
+				starts[nstarts++] = p->u.ip;
+			}
+			if (p->type == OPR && p->u.opr && assigns(p->u.opr) &&
+			    __atomic_load_n(&N1(p)->u.name->type, __ATOMIC_RELAXED) == UNDEF &&
+			    isparam(fun->u.fun->params, N1(p)->u.name->s))
+				__atomic_store_n(&N1(p)->u.name->type, VAR, __ATOMIC_RELAXED);
+			if (p->type != NAME)
+				continue;
+			n = p->u.name;
+			t = __atomic_load_n(&n->type, __ATOMIC_RELAXED);        /* workers share names */
+			if ((t == FUNCTION || t == PROCEDURE) && n->u.fun && !inset(funs, n))
+				readglobals(vars, funs, n);
+			else if ((t == VAR || t == UNDEF) && !isparam(fun->u.fun->params, n->s) && !inset(vars, n))
+				addname(vars, n);
+		}
+		if (i == nstarts)
+			break;
+	}
+	free(starts);
 }
 
-/* get integer part of double */
-static double
-Integer(double n)
+/* tell whether global sym is one of vars */
+static int
+isread(Varset *vars, Symbol *sym)
 {
-	return (double)(long)n;
+	size_t i;
+
+	for (i = 0; i < vars->n; i++)
+		if (strcmp(vars->v[i]->s, sym->name) == 0)
+			return 1;
+	return 0;
 }
 
-/* check result of library call */
-static double
-errcheck(double d, const char *s)
+/*
+ * make a task of the current interpreter, its parent, for a call of
+ * function name with the nargs arguments on the stack.  It has datum
+ * and frame stacks of its own, and shares the program and names of its
+ * parent, but not its globals: it has copies of those the function may
+ * read, as they are now.  These and the arguments are pinned, so the
+ * parent may assign its variables while the task runs, but not change
+ * the arrays it reads, until the task is waited for.
+ */
+static Task *
+newtask(Name *name, int nargs)
 {
-	if (errno == EDOM) {
-		errno = 0;
-		yyerror("%s: argument out of domain", s);
+	Varset vars = {NULL, 0, 0, 0}, funs = {NULL, 0, 0, 0};
+	Symbol *sym, *s;
+	Datum *p, d;
+	Frame *f;
+	Task *t;
+	Hoc *w;
+	int i;
+
+	/* the outputs of the loop of a worker change meanwhile */
+	readglobals(&vars, &funs, name);
+	free(funs.v);
+	for (i = 0, p = hoc->stack; i < nargs && p; i++, p = p->next)
+		if (p->isarr && isout(p->u.arr))
+			break;
+	for (sym = hoc->global; i == nargs && sym; sym = sym->next)
+		if (sym->isarr && isout(sym->u.arr) && isread(&vars, sym))
+			break;
+	if (i < nargs || sym) {
+		free(vars.v);
+		yyerror("%s: task reads a parallel loop output", name->s);
 	}
-	if (errno == ERANGE) {
-		errno = 0;
-		yyerror("%s: result out of range", s);
+
+	t = emalloc(sizeof *t);
+	memset(t, 0, sizeof *t);
+	t->name = name;
+	t->nargs = nargs;
+	t->args = emalloc((nargs ? nargs : 1) * sizeof *t->args);
+	for (i = 0; i < nargs; i++) {
+		t->args[i] = pop();
+		pin(t->args[i]);
 	}
-	return d;
+
+	w = t->hoc = emalloc(sizeof *w);
+	memset(w, 0, sizeof *w);
+	w->prog = hoc->prog;
+	w->lines = hoc->lines;
+	w->nametab = hoc->nametab;
+	w->argc = hoc->argc;
+	w->argvstrings = hoc->argvstrings;
+	w->counting = hoc->counting;
+	w->memoall = hoc->memoall;
+	w->maxinsts = (hoc->maxinsts > hoc->stats.ninsts) ? hoc->maxinsts - hoc->stats.ninsts : 0;
+	w->stop.type = OPR;
+	w->stop.u.opr = NULL;
+	w->errors.quiet = 1;            /* the parent reports the errors */
+	w->nolines = 1;                 /* the parent may go on parsing */
+	w->parent = hoc;
+
+	f = w->frame.head = emalloc(sizeof *f);
+	f->next = f->prev = NULL;
+	f->name = NULL;
+	f->local = NULL;
+	w->frame.tail = w->frame.next = f;
+
+	for (sym = hoc->global; sym; sym = sym->next) {
+		if (!isread(&vars, sym))
+			continue;
+		s = eallocsym(sym->name);
+		s->u = sym->u;
+		s->isstr = sym->isstr;
+		s->isarr = sym->isarr;
+		s->next = w->global;
+		w->global = s;
+		d.u = s->u;
+		d.isstr = s->isstr;
+		d.isarr = s->isarr;
+		pin(d);
+	}
+	free(vars.v);
+	return t;
 }
 
-/* evaluate built-in on top of stack */
-void
-bltin(void)
+/* run task arg, in a thread of the pool or in the one waiting for it */
+static void
+runtask(void *arg)
 {
-	Datum d1, d2;
-	Name *name;
-	int narg, i;
+	Task *t;
+	Hoc *save;
+	int i;
 
-	name = getnamearg();
-	i = name->u.bltin;
-	if (i == 0) {   /* sprintf */
-		_sprintf();
+	t = arg;
+	save = hoc;
+	hoc = t->hoc;
+	if (setjmp(hoc->errors.begin)) {
+		t->failed = 1;
+		t->errpc = hoc->prog.pc;
+		hoc = save;
 		return;
 	}
-	narg = getintarg();
-	if (narg == 0 && bltins[i].n == -1)
-		narg = -1;
-	if (narg != bltins[i].n)
-		yyerror("%s: wrong arity", bltins[i].s);
-	errno = 0;
-	switch (narg) {
-	case -1:
-		d1.u.val = bltins[i].u.d;
-		break;
-	case 0:
-		d1.u.val = (*bltins[i].u.f0)();
-		break;
-	case 1:
-		d1 = popnum();
-		d1.u.val = (*bltins[i].u.f1)(d1.u.val);
-		break;
-	case 2:
-		d2 = popnum();
-		d1 = popnum();
-		d1.u.val = (*bltins[i].u.f2)(d1.u.val, d2.u.val);
-		break;
-	}
-	d1.u.val = errcheck(d1.u.val, bltins[i].s);
-	d1.isstr = 0;
-	push(d1);
+	hoc->prog.pc = &hoc->stop;      /* where the call returns to */
+	for (i = t->nargs - 1; i >= 0; i--)
+		push(t->args[i]);
+	callname(t->name, t->nargs);
+	t->val = pop();
+	if (t->val.isarr)
+		movarr(t->val.u.arr);   /* keep it until it is waited for */
+	hoc = save;
 }
 
-/* check if function or procedure is definable */
-void
-verifydef(Name *name, int type)
+/* free task t, which is done, and drop the references it holds; called by its parent, to which an array it made as its value moves */
+static void
+freetask(Task *t)
 {
-	if (name->type != UNDEF)
-		yyerror("assigning %s to an already used name: %d",
-		        (type == FUNCTION) ? "function" : "procedure",
-		        name->type);
-	name->type = type;
+	Hoc *parent, *w;
+	Symbol *sym;
+	String *str;
+	Array *a;
+	Frame *f;
+	Datum d;
+	int i;
+
+	parent = hoc;
+	w = hoc = t->hoc;
+	waittasks();
+	a = NULL;
+	if (t->val.isarr && t->val.u.arr->orig == FINAL)
+		for (a = w->finalarrays; a && a != t->val.u.arr; a = a->next)
+			;
+	if (a)
+		unlinkarr(a);
+	while ((f = w->frame.head) != NULL) {
+		w->frame.head = f->next;
+		if (f->local)
+			freesymtab(&f->local);
+		free(f);
+	}
+	freearrays(&w->autoarrays);
+	freearrays(&w->finalarrays);
+	freestrings(&w->autostrings);
+	if (a == NULL)
+		freestrings(&w->finalstrings);
+	freestack();
+	hoc = parent;
+
+	/* the strings the array may hold move with it */
+	if (a) {
+		if (hoc->finalarrays)
+			hoc->finalarrays->prev = a;
+		a->next = hoc->finalarrays;
+		a->prev = NULL;
+		hoc->finalarrays = a;
+		while ((str = w->finalstrings) != NULL) {
+			w->finalstrings = str->next;
+			if (hoc->finalstrings)
+				hoc->finalstrings->prev = str;
+			str->next = hoc->finalstrings;
+			str->prev = NULL;
+			hoc->finalstrings = str;
+			countstr(str, 1);
+		}
+	}
+	while ((sym = w->global) != NULL) {
+		w->global = sym->next;
+		d.u = sym->u;
+		d.isstr = sym->isstr;
+		d.isarr = sym->isarr;
+		unpin(d);
+		free(sym);
+	}
+	for (i = 0; i < t->nargs; i++)
+		unpin(t->args[i]);
+	hoc->stats.ninsts += w->stats.ninsts;
+	hoc->stats.nmalloc += w->stats.nmalloc;
+	hoc->stats.mallocbytes += w->stats.mallocbytes;
+	if (w->exceeded)
+		hoc->exceeded = 1;
+	hoc->nrunning--;
+	free(w);
+	free(t->args);
+	free(t);
 }
 
-/* put function or procedure in symbol table */
-void
-define(Name *name, Name *params)
+/* wait for the tasks of the current interpreter that were not waited for, and free them */
+static void
+waittasks(void)
 {
-	Function *fun;
-	int n;
+	Task *t;
+	size_t i;
 
-	if (DEBUG)
-		debug();
-	fun = emalloc(sizeof *fun);
-	fun->code = prog.base;          /* start of code */
-	prog.base = prog.progp;         /* next code starts here */
-	fun->params = params;
-	for (n = 0; params; params = params->next)
-		n++;
-	fun->nparams = n;
-	name->u.fun = fun;
+	for (i = 0; i < hoc->ntasks; i++) {
+		if ((t = hoc->tasks[i]) == NULL)
+			continue;
+		hoc->tasks[i] = NULL;
+		poolwait(&t->job);
+		freetask(t);
+	}
+	free(hoc->tasks);
+	hoc->tasks = NULL;
+	hoc->taskbase += hoc->ntasks;
+	hoc->ntasks = hoc->maxtasks = 0;
 }
 
-/* call a function */
+/*
+ * spawn a call of a function, run by a task (see newtask()) in a thread
+ * of the pool, and push its handle, the number wait() takes to get its
+ * value.  Handles count the tasks spawned, so none is used twice; when
+ * the table of tasks is full, the tasks at its start that were waited
+ * for are dropped from it, or it grows.  Profiles and traces are made
+ * by a single thread, so then the call is run at once.
+ */
 void
-call(void)
+spawncode(void)
 {
-	Symbol *local;
-	Frame *f;
-	Datum d;
-	Name *name, *tmp;
+	Name *name;
+	Task *t, **v;
+	size_t i, n;
 	int nargs;
 
 	name = getnamearg();
-	if (name->type != FUNCTION && name->type != PROCEDURE)
-		yyerror("%s is not function nor procedure", name->s);
 	nargs = getintarg();
-	if (!frame.next->next) {
-		f = emalloc(sizeof *f);
-		f->next = NULL;
-		frame.next->next = f;
-	}
-	frame.curr = f = frame.next;
-	frame.tail = frame.next = frame.next->next;
-	frame.next->prev = frame.curr;
+	if (name->u.fun == NULL)
+		yyerror("%s is not defined", name->s);
 	if (nargs > name->u.fun->nparams)
 		yyerror("function %s called with wrong number of parameters", name->s);
-	nargs = name->u.fun->nparams - nargs;
-	local = NULL;
-	for (tmp = name->u.fun->params; tmp; tmp = tmp->next) {
-		if (nargs > 0) {
-			d.u.val = 0.0;
-			d.isstr = 0;
-			nargs--;
-		} else {
-			d = pop();
+	if (hoc->ntasks == hoc->maxtasks) {
+		for (i = 0; i < hoc->ntasks && hoc->tasks[i] == NULL; i++)
+			;
+		if (i > 0) {
+			memmove(hoc->tasks, hoc->tasks + i, (hoc->ntasks - i) * sizeof *hoc->tasks);
+			hoc->ntasks -= i;
+			hoc->taskbase += i;
+		}
+		if (2 * hoc->ntasks >= hoc->maxtasks) {
+			n = hoc->maxtasks ? 2 * hoc->maxtasks : 16;
+			if ((v = realloc(hoc->tasks, n * sizeof *v)) == NULL)
+				yyerror("out of memory");
+			hoc->tasks = v;
+			hoc->maxtasks = n;
 		}
-		local = installlocalsym(tmp->s, local);
-		local->u = d.u;
-		local->isstr = d.isstr;
 	}
-	f->name = name;
-	f->retsymtab = currsymtab;
-	currsymtab = f->local = local;
-	f->retpc = prog.pc;
-	execute(name->u.fun->code);
-	returning = 0;
+	t = newtask(name, nargs);
+	hoc->tasks[hoc->ntasks++] = t;
+	hoc->nrunning++;
+	if (profiling || tracing) {
+		runtask(t);
+		t->job.state = JOBDONE;
+	} else {
+		poolsubmit(&t->job, runtask, t);
+	}
+	pushval((double)(hoc->taskbase + hoc->ntasks));
+}
+
+/* wait for the task whose handle is on the stack, and push its value; a string is copied */
+static void
+_wait(void)
+{
+	Task *t;
+	Datum d;
+	size_t i;
+	int line, n;
+
+	arity("wait", 1);
+	d = popnum();
+	if (!(d.u.val > (double)hoc->taskbase && d.u.val <= (double)(hoc->taskbase + hoc->ntasks)) ||
+	    d.u.val != floor(d.u.val) || hoc->tasks[(size_t)d.u.val - 1 - hoc->taskbase] == NULL)
+		yyerror("wait: %.8g is no task", d.u.val);
+	i = (size_t)d.u.val - 1 - hoc->taskbase;
+	t = hoc->tasks[i];
+	hoc->tasks[i] = NULL;
+	poolwait(&t->job);
+	if (t->failed) {
+		n = 0;
+		if (!hoc->nolines && (line = pcline(t->errpc)) > 0)
+			n = snprintf(hoc->errors.msg, sizeof hoc->errors.msg, "line %d: ", line);
+		if (n < 0 || (size_t)n >= sizeof hoc->errors.msg)
+			n = 0;
+		(void)snprintf(hoc->errors.msg + n, sizeof hoc->errors.msg - n, "%s", t->hoc->errors.msg);
+		freetask(t);
+		passerror(hoc->errors.msg);
+	}
+	d = t->val;
+	if (d.isstr)
+		d.u.str = addstr(estrdup(d.u.str->s), 0);
+	freetask(t);
+	if (d.isarr)
+		tmparr(d.u.arr);
+	push(d);
 }
 
 /* common return from func or proc */
 static void
 ret(void)
 {
-	currsymtab = frame.curr->retsymtab;
-	prog.pc = frame.curr->retpc;
-	frame.next = frame.curr;
-	frame.curr = frame.curr->prev;
-	returning = 1;
+	freesymtab(&hoc->frame.curr->local);
+	hoc->currsymtab = hoc->frame.curr->retsymtab;
+	hoc->prog.pc = hoc->frame.curr->retpc;
+	hoc->frame.next = hoc->frame.curr;
+	hoc->frame.curr = hoc->frame.curr->prev;
+	hoc->stats.frames--;
+	hoc->returning = 1;
 }
 
 /* return from a function */
@@ -1675,10 +5524,14 @@ funcret(void)
 {
 	Datum d;
 
-	if (frame.curr->name->type == PROCEDURE)
-		yyerror("%s (proc) returns value", frame.curr->name->s);
+	if (hoc->frame.curr->name->type == PROCEDURE)
+		yyerror("%s (proc) returns value", hoc->frame.curr->name->s);
 	d = pop();
+	if (d.isarr)
+		movarr(d.u.arr);        /* keep it while the locals are freed */
 	ret();
+	if (d.isarr)
+		tmparr(d.u.arr);
 	push(d);
 }
 
@@ -1686,7 +5539,47 @@ funcret(void)
 void
 procret(void)
 {
-	if (frame.curr->name->type == FUNCTION)
-		yyerror("%s (func) returns no value", frame.curr->name->s);
+	if (hoc->frame.curr->name->type == FUNCTION)
+		yyerror("%s (func) returns no value", hoc->frame.curr->name->s);
 	ret();
 }
+
+/* push the argument of an inlined call at the given depth in the stack */
+void
+argpush(void)
+{
+	Datum *p;
+	int n;
+
+	n = getintarg();
+	for (p = hoc->stack; p && n > 0; n--)
+		p = p->next;
+	if (p == NULL)
+		yyerror("stack underflow");
+	push(*p);
+}
+
+/* return from an inlined function: pop its arguments from under its value */
+void
+argret(void)
+{
+	Datum d;
+	int n;
+
+	n = getintarg();
+	d = pop();
+	while (n-- > 0)
+		(void)pop();
+	push(d);
+}
+
+/* return from an inlined procedure: pop its arguments */
+void
+argpop(void)
+{
+	int n;
+
+	n = getintarg();
+	while (n-- > 0)
+		(void)pop();
+}
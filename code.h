@@ -8,24 +8,79 @@
 #define N3(p) ((p)->next->next->next)
 #define N4(p) ((p)->next->next->next->next)
 
+/* operations of elemassign */
+enum {ELEMSET, ELEMADD, ELEMSUB, ELEMMUL, ELEMDIV, ELEMMOD, ELEMINC, ELEMDEC};
+
+/* clauses of parforcode: output array, and reduction variables */
+enum {PAROUT, PARSUM, PARMIN, PARMAX};
+
 /* routines called by main.o */
+struct Hoc *newhoc(void);
+void sethoc(struct Hoc *h);
 void init(int argc, char *argv[]);
 void prepare(void);
 void cleanup(void);
 void debug(void);
 void execute(Inst *);
+void addstmt(void);
+void run(void);
+void printstats(FILE *fp);
+void countinsts(void);
+void requeststats(void);
+void requestint(void);
+void requesttimeout(void);
+void setmaxinsts(unsigned long long n);
+int limitexceeded(void);
+void memoizeall(void);
+void optimize(void);
+
+/* routines called by libhoc.o */
+void callbyname(const char *s, const double *args, int n, double *v);
+Symbol *lookupvar(const char *s);
+
+/* routines called by image.o */
+char *oprname(void (*opr)(void));
+int oprindex(void (*opr)(void));
+void (*oprfunc(int i))(void);
+Inst *getproghead(void);
+Stmt *getstmts(void);
+Name *getnametab(void);
+void keepcode(void);
+void appendstmt(Inst *code, int line);
+int *getlines(void);
+void defineat(Name *name, Name *params, Inst *code);
+const unsigned char *getlinetab(size_t *len);
+int setlinetab(const unsigned char *buf, size_t len, size_t n);
+void setfilename(const char *file);
+int getoptimize(void);
+
+/* routines called by prof.o */
+Frame *getframe(void);
+Inst *getpc(void);
+void keepallcode(void);
+void maplines(int whole, void (*fn)(Inst *, int));
+const char *getfilename(void);
+
+/* routines called by error.o */
+int lineno(void);
 
 /* routines called by lex.o */
 Name *lookupname(const char *s);
+Name *lookupnamelen(const char *s, size_t len);
 Name *installglobalname(const char *s, int t);
 
 /* routines called by gramm.o */
 String *addstr(char *, int);
 Name *installlocalname(const char *s, Name *nametab);
 Inst *code(Inst inst);
+Inst *strcode(String *str);
 Inst *getprogp(void);
 void verifydef(Name *, int);
 void define(Name *, Name *);
+void memoize(Name *);
+void callcode(Name *, int);
+void verifypar(Inst *, Name *);
+void optcode(void);
 void movstr(String *str);
 
 /* instruction operation routines */
@@ -77,3 +132,15 @@ void bltin(void);
 void call(void);
 void procret(void);
 void funcret(void);
+void argpush(void);
+void argret(void);
+void argpop(void);
+void invpush(void);
+void countcode(void);
+void elempush(void);
+void elemassign(void);
+void matindex(void);
+void inmap(void);
+void forincode(void);
+void parforcode(void);
+void spawncode(void);
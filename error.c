@@ -3,16 +3,32 @@
 #include <setjmp.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include "error.h"
 
-static char buf[BUFSIZ];
-extern jmp_buf begin;
-extern int yylineno;
+int lineno(void);
 
 /* jump to main loop */
 void
 longjump(void)
 {
-	longjmp(begin, 1);
+	longjmp(geterrors()->begin, 1);
+}
+
+/* keep the message of an error at the current line, if any, and print it unless quiet */
+static void
+report(Errors *e, const char *fmt, va_list ap)
+{
+	int n, line;
+
+	n = 0;
+	if ((line = lineno()) > 0)
+		n = snprintf(e->msg, sizeof e->msg, "line %d: ", line);
+	if (n < 0 || (size_t)n >= sizeof e->msg)
+		n = 0;
+	(void)vsnprintf(e->msg + n, sizeof e->msg - n, fmt, ap);
+	if (!e->quiet)
+		warnx("%s", e->msg);
+	errno = 0;
 }
 
 /* warn an execution error */
@@ -22,22 +38,43 @@ warning(const char *fmt, ...)
 	va_list ap;
 
 	va_start(ap, fmt);
-	(void)vsnprintf(buf, sizeof buf - 1, fmt, ap);
-	warnx("line %d: %s", yylineno, buf);
+	report(geterrors(), fmt, ap);
 	va_end(ap);
-	errno = 0;
 }
 
 /* warn an execution error and jump to main loop */
 void
 yyerror(const char *fmt, ...)
 {
+	Errors *e;
 	va_list ap;
 
+	e = geterrors();
 	va_start(ap, fmt);
-	(void)vsnprintf(buf, sizeof buf - 1, fmt, ap);
-	warnx("line %d: %s", yylineno, buf);
+	report(e, fmt, ap);
 	va_end(ap);
-	errno = 0;
-	longjmp(begin, 1);
+	e->n++;
+	longjmp(e->begin, 1);
+}
+
+/* jump to main loop with an error of another interpreter, whose message msg is kept as it is */
+void
+passerror(const char *msg)
+{
+	Errors *e;
+
+	e = geterrors();
+	if (msg != e->msg)
+		(void)snprintf(e->msg, sizeof e->msg, "%s", msg);
+	if (!e->quiet)
+		warnx("%s", e->msg);
+	e->n++;
+	longjmp(e->begin, 1);
+}
+
+/* get number of errors that jumped to main loop */
+int
+errorcount(void)
+{
+	return geterrors()->n;
 }
@@ -1,3 +1,14 @@
+/* where errors jump to, and the last message, of an interpreter */
+typedef struct Errors {
+	jmp_buf begin;
+	int n;                  /* errors that jumped to begin */
+	int quiet;              /* keep messages in msg instead of printing them */
+	char msg[BUFSIZ];
+} Errors;
+
+Errors *geterrors(void);
 void longjump(void);
 void warning(const char *fmt, ...);
 void yyerror(const char *fmt, ...);
+void passerror(const char *msg);
+int errorcount(void);
@@ -0,0 +1,2329 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison implementation for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* C LALR(1) parser skeleton written by Richard Stallman, by
+   simplifying the original so-called "semantic" parser.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+/* All symbols defined below should begin with yy or YY, to avoid
+   infringing on user name space.  This should be done even for local
+   variables, as they might otherwise be expanded by user macros.
+   There are some unavoidable exceptions within include files to
+   define necessary library symbols; they are noted "INFRINGES ON
+   USER NAME SPACE" below.  */
+
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
+
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
+
+/* Skeleton name.  */
+#define YYSKELETON_NAME "yacc.c"
+
+/* Pure parsers.  */
+#define YYPURE 0
+
+/* Push parsers.  */
+#define YYPUSH 0
+
+/* Pull parsers.  */
+#define YYPULL 1
+
+
+
+
+/* First part of user prologue.  */
+#line 1 "gramm.y"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <setjmp.h>
+#include <string.h>
+#include "hoc.h"
+#include "code.h"
+#include "error.h"
+
+#define ipcode(i)  code((Inst){.type = IP, .u.ip = (i)})
+#define valcode(v) code((Inst){.type = VAL, .u.val = (v)})
+#define argcode(a) code((Inst){.type = NARG, .u.narg = (a)})
+#define oprcode(o) code((Inst){.type = OPR, .u.opr = (o)})
+#define namecode(n) code((Inst){.type = NAME, .u.name = (n)})
+#define elemcode(n, op) oprcode(elemassign), namecode(n), argcode(op)
+#define fill1(x, a) \
+	N1((x))->type = IP, \
+	N1((x))->u.ip = (a)
+#define fill2(x, a, b) \
+	N1((x))->type = N2((x))->type = IP, \
+	N1((x))->u.ip = (a), \
+	N2((x))->u.ip = (b)
+#define fill3(x, a, b, c) \
+	N1((x))->type = N2((x))->type = N3((x))->type = IP, \
+	N1((x))->u.ip = (a), \
+	N2((x))->u.ip = (b), \
+	N3((x))->u.ip = (c)
+#define fill4(x, a, b, c, d) \
+	N1((x))->type = N2((x))->type = N3((x))->type = N4((x))->type = IP, \
+	N1((x))->u.ip = (a), \
+	N2((x))->u.ip = (b), \
+	N3((x))->u.ip = (c), \
+	N4((x))->u.ip = (d)
+#define fillin(x, v, a, b, c) \
+	N1((x))->type = N2((x))->type = NAME, \
+	N3((x))->type = N4((x))->type = IP, \
+	N1((x))->u.name = (v), \
+	N2((x))->u.name = (a), \
+	N3((x))->u.ip = (b), \
+	N4((x))->u.ip = (c)
+#define fillpar(x, v, le, b, e) \
+	N1((x))->type = NAME, \
+	N2((x))->type = NARG, \
+	N3((x))->type = N4((x))->type = IP, \
+	N1((x))->u.name = (v), \
+	N2((x))->u.narg = (le), \
+	N3((x))->u.ip = (b), \
+	N4((x))->u.ip = (e)
+
+int yylex(void);
+static void looponly(const char *);
+static void serialonly(const char *);
+static void defnonly(void);
+static int reduction(const char *);
+
+static int indef;
+static size_t inloop;
+static size_t parloop;          /* inloop in the body of the innermost parallel loop, or 0 */
+static Name *defparams;         /* parameters of the function being defined */
+
+#line 134 "gramm.c"
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
+
+#include "gramm.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_STRING = 3,                     /* STRING  */
+  YYSYMBOL_NUMBER = 4,                     /* NUMBER  */
+  YYSYMBOL_PREVIOUS = 5,                   /* PREVIOUS  */
+  YYSYMBOL_VAR = 6,                        /* VAR  */
+  YYSYMBOL_BLTIN = 7,                      /* BLTIN  */
+  YYSYMBOL_UNDEF = 8,                      /* UNDEF  */
+  YYSYMBOL_PRINT = 9,                      /* PRINT  */
+  YYSYMBOL_PRINTF = 10,                    /* PRINTF  */
+  YYSYMBOL_READ = 11,                      /* READ  */
+  YYSYMBOL_GETLINE = 12,                   /* GETLINE  */
+  YYSYMBOL_WHILE = 13,                     /* WHILE  */
+  YYSYMBOL_DO = 14,                        /* DO  */
+  YYSYMBOL_IF = 15,                        /* IF  */
+  YYSYMBOL_ELSE = 16,                      /* ELSE  */
+  YYSYMBOL_FOR = 17,                       /* FOR  */
+  YYSYMBOL_IN = 18,                        /* IN  */
+  YYSYMBOL_BREAK = 19,                     /* BREAK  */
+  YYSYMBOL_CONTINUE = 20,                  /* CONTINUE  */
+  YYSYMBOL_PARALLEL = 21,                  /* PARALLEL  */
+  YYSYMBOL_FUNC = 22,                      /* FUNC  */
+  YYSYMBOL_PROC = 23,                      /* PROC  */
+  YYSYMBOL_FUNCTION = 24,                  /* FUNCTION  */
+  YYSYMBOL_PROCEDURE = 25,                 /* PROCEDURE  */
+  YYSYMBOL_RETURN = 26,                    /* RETURN  */
+  YYSYMBOL_MEMO = 27,                      /* MEMO  */
+  YYSYMBOL_SPAWN = 28,                     /* SPAWN  */
+  YYSYMBOL_LOWEST = 29,                    /* LOWEST  */
+  YYSYMBOL_30_ = 30,                       /* ','  */
+  YYSYMBOL_31_ = 31,                       /* '='  */
+  YYSYMBOL_ADDEQ = 32,                     /* ADDEQ  */
+  YYSYMBOL_SUBEQ = 33,                     /* SUBEQ  */
+  YYSYMBOL_MULEQ = 34,                     /* MULEQ  */
+  YYSYMBOL_DIVEQ = 35,                     /* DIVEQ  */
+  YYSYMBOL_MODEQ = 36,                     /* MODEQ  */
+  YYSYMBOL_OR = 37,                        /* OR  */
+  YYSYMBOL_AND = 38,                       /* AND  */
+  YYSYMBOL_EQ = 39,                        /* EQ  */
+  YYSYMBOL_NE = 40,                        /* NE  */
+  YYSYMBOL_GT = 41,                        /* GT  */
+  YYSYMBOL_GE = 42,                        /* GE  */
+  YYSYMBOL_LT = 43,                        /* LT  */
+  YYSYMBOL_LE = 44,                        /* LE  */
+  YYSYMBOL_45_ = 45,                       /* '+'  */
+  YYSYMBOL_46_ = 46,                       /* '-'  */
+  YYSYMBOL_47_ = 47,                       /* '*'  */
+  YYSYMBOL_48_ = 48,                       /* '/'  */
+  YYSYMBOL_49_ = 49,                       /* '%'  */
+  YYSYMBOL_UNARYSIGN = 50,                 /* UNARYSIGN  */
+  YYSYMBOL_NOT = 51,                       /* NOT  */
+  YYSYMBOL_INC = 52,                       /* INC  */
+  YYSYMBOL_DEC = 53,                       /* DEC  */
+  YYSYMBOL_54_ = 54,                       /* '^'  */
+  YYSYMBOL_55_ = 55,                       /* '$'  */
+  YYSYMBOL_56_ = 56,                       /* '['  */
+  YYSYMBOL_57_ = 57,                       /* ']'  */
+  YYSYMBOL_58_n_ = 58,                     /* '\n'  */
+  YYSYMBOL_59_ = 59,                       /* '{'  */
+  YYSYMBOL_60_ = 60,                       /* '}'  */
+  YYSYMBOL_61_ = 61,                       /* '('  */
+  YYSYMBOL_62_ = 62,                       /* ')'  */
+  YYSYMBOL_63_ = 63,                       /* ';'  */
+  YYSYMBOL_YYACCEPT = 64,                  /* $accept  */
+  YYSYMBOL_list = 65,                      /* list  */
+  YYSYMBOL_asgn = 66,                      /* asgn  */
+  YYSYMBOL_stmtnl = 67,                    /* stmtnl  */
+  YYSYMBOL_stmt = 68,                      /* stmt  */
+  YYSYMBOL_exprlist = 69,                  /* exprlist  */
+  YYSYMBOL_index = 70,                     /* index  */
+  YYSYMBOL_expr = 71,                      /* expr  */
+  YYSYMBOL_defn = 72,                      /* defn  */
+  YYSYMBOL_73_1 = 73,                      /* $@1  */
+  YYSYMBOL_74_2 = 74,                      /* $@2  */
+  YYSYMBOL_75_3 = 75,                      /* $@3  */
+  YYSYMBOL_procname = 76,                  /* procname  */
+  YYSYMBOL_args = 77,                      /* args  */
+  YYSYMBOL_arglist = 78,                   /* arglist  */
+  YYSYMBOL_params = 79,                    /* params  */
+  YYSYMBOL_paramlist = 80,                 /* paramlist  */
+  YYSYMBOL_forcond = 81,                   /* forcond  */
+  YYSYMBOL_cond = 82,                      /* cond  */
+  YYSYMBOL_if = 83,                        /* if  */
+  YYSYMBOL_do = 84,                        /* do  */
+  YYSYMBOL_while = 85,                     /* while  */
+  YYSYMBOL_forloop = 86,                   /* forloop  */
+  YYSYMBOL_parfor = 87,                    /* parfor  */
+  YYSYMBOL_parcmp = 88,                    /* parcmp  */
+  YYSYMBOL_parstep = 89,                   /* parstep  */
+  YYSYMBOL_parhead = 90,                   /* parhead  */
+  YYSYMBOL_parclauses = 91,                /* parclauses  */
+  YYSYMBOL_parclauselist = 92,             /* parclauselist  */
+  YYSYMBOL_parclause = 93,                 /* parclause  */
+  YYSYMBOL_stmtlist = 94,                  /* stmtlist  */
+  YYSYMBOL_term = 95,                      /* term  */
+  YYSYMBOL_and = 96,                       /* and  */
+  YYSYMBOL_or = 97,                        /* or  */
+  YYSYMBOL_begin = 98,                     /* begin  */
+  YYSYMBOL_end = 99                        /* end  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
+
+
+
+#ifdef short
+# undef short
+#endif
+
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
+
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
+#else
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
+#else
+typedef short yytype_uint8;
+#endif
+
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
+#else
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
+#endif
+
+#ifndef YYSIZE_T
+# ifdef __SIZE_TYPE__
+#  define YYSIZE_T __SIZE_TYPE__
+# elif defined size_t
+#  define YYSIZE_T size_t
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYSIZE_T size_t
+# else
+#  define YYSIZE_T unsigned
+# endif
+#endif
+
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_int16 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
+
+#ifndef YY_
+# if defined YYENABLE_NLS && YYENABLE_NLS
+#  if ENABLE_NLS
+#   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
+#  endif
+# endif
+# ifndef YY_
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
+#endif
+
+/* Suppress unused-variable warnings by "using" E.  */
+#if ! defined lint || defined __GNUC__
+# define YY_USE(E) ((void) (E))
+#else
+# define YY_USE(E) /* empty */
+#endif
+
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
+#else
+# define YY_INITIAL_VALUE(Value) Value
+#endif
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
+
+/* The parser invokes alloca or malloc; define the necessary symbols.  */
+
+# ifdef YYSTACK_USE_ALLOCA
+#  if YYSTACK_USE_ALLOCA
+#   ifdef __GNUC__
+#    define YYSTACK_ALLOC __builtin_alloca
+#   elif defined __BUILTIN_VA_ARG_INCR
+#    include <alloca.h> /* INFRINGES ON USER NAME SPACE */
+#   elif defined _AIX
+#    define YYSTACK_ALLOC __alloca
+#   elif defined _MSC_VER
+#    include <malloc.h> /* INFRINGES ON USER NAME SPACE */
+#    define alloca _alloca
+#   else
+#    define YYSTACK_ALLOC alloca
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
+#     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
+#     endif
+#    endif
+#   endif
+#  endif
+# endif
+
+# ifdef YYSTACK_ALLOC
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+    /* The OS might guarantee only one guard page at the bottom of the stack,
+       and a page size can be as small as 4096 bytes.  So we cannot safely
+       invoke alloca (N) if N exceeds 4096.  Use a slightly smaller number
+       to allow for a few compiler-allocated temporary stack slots.  */
+#   define YYSTACK_ALLOC_MAXIMUM 4032 /* reasonable circa 2006 */
+#  endif
+# else
+#  define YYSTACK_ALLOC YYMALLOC
+#  define YYSTACK_FREE YYFREE
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+#   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
+#  endif
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
+       && ! ((defined YYMALLOC || defined malloc) \
+             && (defined YYFREE || defined free)))
+#   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
+#   endif
+#  endif
+#  ifndef YYMALLOC
+#   define YYMALLOC malloc
+#   if ! defined malloc && ! defined EXIT_SUCCESS
+void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+#  ifndef YYFREE
+#   define YYFREE free
+#   if ! defined free && ! defined EXIT_SUCCESS
+void free (void *); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+# endif
+#endif /* !defined yyoverflow */
+
+#if (! defined yyoverflow \
+     && (! defined __cplusplus \
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+
+/* A type that is properly aligned for any stack member.  */
+union yyalloc
+{
+  yy_state_t yyss_alloc;
+  YYSTYPE yyvs_alloc;
+};
+
+/* The size of the maximum gap between one aligned stack and the next.  */
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
+
+/* The size of an array large to enough to hold all stacks, each with
+   N elements.  */
+# define YYSTACK_BYTES(N) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
+      + YYSTACK_GAP_MAXIMUM)
+
+# define YYCOPY_NEEDED 1
+
+/* Relocate STACK from its old location to the new one.  The
+   local variables YYSIZE and YYSTACKSIZE give the old and new number of
+   elements in the stack, and YYPTR gives the new location of the
+   stack.  Advance YYPTR to a properly aligned location for the next
+   stack.  */
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
+
+#endif
+
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
+/* YYFINAL -- State number of the termination state.  */
+#define YYFINAL  2
+/* YYLAST -- Last index in YYTABLE.  */
+#define YYLAST   535
+
+/* YYNTOKENS -- Number of terminals.  */
+#define YYNTOKENS  64
+/* YYNNTS -- Number of nonterminals.  */
+#define YYNNTS  36
+/* YYNRULES -- Number of rules.  */
+#define YYNRULES  124
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  265
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   301
+
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
+{
+       0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+      58,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,    55,    49,     2,     2,
+      61,    62,    47,    45,    30,    46,     2,    48,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,    63,
+       2,    31,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,    56,     2,    57,    54,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,    59,     2,    60,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
+       5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
+      15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
+      25,    26,    27,    28,    29,    32,    33,    34,    35,    36,
+      37,    38,    39,    40,    41,    42,    43,    44,    50,    51,
+      52,    53
+};
+
+#if YYDEBUG
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
+{
+       0,   102,   102,   103,   104,   105,   106,   107,   108,   112,
+     113,   114,   115,   116,   117,   118,   119,   120,   121,   122,
+     123,   124,   125,   126,   127,   128,   129,   130,   131,   136,
+     137,   141,   142,   143,   144,   145,   146,   147,   148,   149,
+     150,   151,   152,   153,   154,   155,   156,   169,   170,   174,
+     175,   179,   180,   181,   182,   183,   184,   185,   186,   187,
+     188,   189,   190,   191,   192,   193,   194,   195,   196,   197,
+     198,   199,   200,   201,   202,   203,   204,   205,   206,   207,
+     208,   209,   213,   213,   215,   215,   217,   217,   222,   226,
+     227,   231,   232,   240,   241,   245,   246,   250,   251,   255,
+     259,   263,   267,   271,   276,   281,   282,   286,   287,   292,
+     295,   297,   301,   302,   307,   308,   312,   313,   314,   318,
+     319,   323,   327,   331,   335
+};
+#endif
+
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
+/* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
+   First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
+static const char *const yytname[] =
+{
+  "\"end of file\"", "error", "\"invalid token\"", "STRING", "NUMBER",
+  "PREVIOUS", "VAR", "BLTIN", "UNDEF", "PRINT", "PRINTF", "READ",
+  "GETLINE", "WHILE", "DO", "IF", "ELSE", "FOR", "IN", "BREAK", "CONTINUE",
+  "PARALLEL", "FUNC", "PROC", "FUNCTION", "PROCEDURE", "RETURN", "MEMO",
+  "SPAWN", "LOWEST", "','", "'='", "ADDEQ", "SUBEQ", "MULEQ", "DIVEQ",
+  "MODEQ", "OR", "AND", "EQ", "NE", "GT", "GE", "LT", "LE", "'+'", "'-'",
+  "'*'", "'/'", "'%'", "UNARYSIGN", "NOT", "INC", "DEC", "'^'", "'$'",
+  "'['", "']'", "'\\n'", "'{'", "'}'", "'('", "')'", "';'", "$accept",
+  "list", "asgn", "stmtnl", "stmt", "exprlist", "index", "expr", "defn",
+  "$@1", "$@2", "$@3", "procname", "args", "arglist", "params",
+  "paramlist", "forcond", "cond", "if", "do", "while", "forloop", "parfor",
+  "parcmp", "parstep", "parhead", "parclauses", "parclauselist",
+  "parclause", "stmtlist", "term", "and", "or", "begin", "end", YY_NULLPTR
+};
+
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
+{
+  return yytname[yysymbol];
+}
+#endif
+
+#define YYPACT_NINF (-174)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-1)
+
+#define yytable_value_is_error(Yyn) \
+  0
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int16 yypact[] =
+{
+    -174,   183,  -174,   -52,  -174,  -174,  -174,   420,  -174,  -174,
+    -174,     3,    12,  -174,  -174,  -174,  -174,  -174,  -174,     4,
+      20,    20,  -174,  -174,   331,    22,    37,   331,   331,   331,
+      40,    58,   331,  -174,  -174,   331,  -174,   -52,   -52,    32,
+     481,   -52,     5,   305,     5,     7,     9,  -174,  -174,   331,
+     331,   331,   331,   331,   331,  -174,  -174,   331,    11,   331,
+     331,  -174,  -174,  -174,  -174,  -174,  -174,    30,    39,  -174,
+     481,    20,  -174,    15,    15,    15,    17,    46,  -174,   244,
+      -7,  -174,  -174,   331,  -174,    59,  -174,  -174,   331,   331,
+     331,   331,   331,   331,   331,   331,   331,   331,   331,   331,
+     331,   331,  -174,   331,   305,   305,    88,  -174,    76,   305,
+     367,   101,   481,   481,   481,   481,   481,   481,    52,   449,
+     331,   481,    80,  -174,  -174,    51,    60,   331,   331,  -174,
+      61,   331,   331,  -174,  -174,  -174,  -174,   481,  -174,    85,
+      85,   115,   115,   115,   115,    45,    45,    15,    15,    15,
+      15,   481,   481,    -3,  -174,  -174,     5,  -174,   429,    76,
+      50,    92,   248,   331,    63,   331,   129,   129,    78,    81,
+      83,   331,    89,    91,  -174,  -174,  -174,   126,  -174,  -174,
+     139,   331,   331,   331,   331,   331,   331,   331,   331,  -174,
+    -174,   481,  -174,   481,  -174,   119,    90,    93,  -174,  -174,
+     129,    94,  -174,  -174,   305,  -174,    95,    87,   362,   481,
+     481,   481,   481,   481,   481,   152,   305,   305,   103,  -174,
+    -174,   305,   331,   160,  -174,  -174,  -174,   305,  -174,  -174,
+     105,     8,  -174,  -174,   305,  -174,  -174,   331,  -174,   396,
+    -174,    -2,   116,   171,  -174,  -174,  -174,   117,    25,   123,
+     125,   118,   161,  -174,  -174,   142,   195,    25,   305,  -174,
+     150,  -174,  -174,  -174,  -174
+};
+
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
+{
+       2,     0,     1,     0,    52,    51,    53,    54,   123,   123,
+     123,     0,     0,   102,   101,   100,   103,    32,    33,     0,
+       0,     0,   123,   123,    34,     0,     0,     0,     0,     0,
+       0,     0,     0,   120,   116,     0,   119,    81,     0,     0,
+      47,     0,     0,     0,     0,     0,     0,     3,     8,     0,
+       0,     0,     0,     0,     0,    17,    18,     0,     0,    91,
+      91,    56,    57,   104,    88,    82,    84,     0,     0,    81,
+      35,     0,   123,    78,    77,    74,    15,    16,    60,     0,
+       0,     6,     5,     0,     7,     0,   122,   121,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     4,     0,     0,     0,     0,    29,    39,     0,
+      97,     0,     9,    10,    11,    12,    13,    14,     0,    49,
+      91,    89,    92,    37,    38,     0,     0,    91,    91,    86,
+       0,     0,     0,    31,   118,   117,    79,    48,    73,    71,
+      72,    67,    68,    69,    70,    61,    62,    63,    64,    65,
+      66,   124,   124,     0,   124,    30,     0,   124,    54,    98,
+       0,     0,    55,     0,     0,     0,    95,    95,     0,     0,
+       0,    91,     0,     0,    75,    76,    99,    40,   124,    42,
+       0,    97,     0,     0,     0,     0,     0,     0,     0,    27,
+      28,    50,    80,    90,    93,    96,     0,     0,    58,    36,
+      95,     0,    25,    26,     0,    43,     0,     0,     0,    19,
+      20,    21,    22,    23,    24,     0,     0,     0,     0,    59,
+     124,     0,    97,     0,    94,    83,    85,     0,    41,   124,
+       0,     0,    87,    45,     0,   105,   106,     0,   124,     0,
+      44,     0,     0,     0,   109,   107,   108,   110,     0,     0,
+       0,     0,   111,   112,   123,     0,     0,     0,     0,   114,
+       0,   113,   124,   115,    46
+};
+
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int16 yypgoto[] =
+{
+    -174,  -174,   212,   -80,    18,     1,   -97,   -12,  -174,  -174,
+    -174,  -174,   -18,  -174,   -53,  -174,  -157,  -173,   -39,  -174,
+    -174,  -174,  -174,  -174,  -174,  -174,  -174,  -174,  -174,   -43,
+    -174,    19,  -174,  -174,    -9,  -124
+};
+
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_uint8 yydefgoto[] =
+{
+       0,     1,    69,   106,   107,   108,   118,    40,    41,   125,
+     126,   170,    65,   122,   123,   195,   196,   160,   104,    42,
+      43,    44,    45,    46,   237,   244,   247,   249,   252,   253,
+      79,    47,   100,   101,    58,   174
+};
+
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int16 yytable[] =
+{
+      59,    60,    39,    66,   242,   109,    33,   124,   207,    61,
+     197,    36,    70,    67,    68,    73,    74,    75,    62,    38,
+      78,    63,    48,    83,   154,   155,    64,    83,   175,   157,
+     177,   250,   251,   179,   172,   173,    80,   112,   113,   114,
+     115,   116,   117,   218,    71,   119,    76,   121,   121,   230,
+     243,   235,   236,   129,   205,   136,    81,    82,    84,   176,
+     102,    72,    83,   130,    77,   138,   103,   164,   110,    99,
+     111,   137,   120,   131,   168,   169,   139,   140,   141,   142,
+     143,   144,   145,   146,   147,   148,   149,   150,   151,   152,
+      33,   127,    96,    97,    98,    36,   228,   134,   135,    99,
+     128,   156,   132,    85,   153,   233,    83,   161,   121,   162,
+     165,   159,   166,   181,   240,   121,   121,   178,   201,   119,
+     119,   167,   171,   182,   220,   192,    90,    91,    92,    93,
+      94,    95,    96,    97,    98,   194,   225,   226,   264,    99,
+     198,   229,   204,   199,   200,   206,   202,   232,   203,   215,
+     222,   191,   216,   193,   238,   217,   219,   221,   224,   121,
+      94,    95,    96,    97,    98,   227,   231,   234,   245,    99,
+     208,   209,   210,   211,   212,   213,   214,   246,   262,   256,
+     248,   255,   159,     2,     3,   254,     4,     5,     6,     7,
+       8,   257,     9,    10,    11,    12,    13,    14,    15,   259,
+      16,   260,    17,    18,    19,    20,    21,    22,    23,    24,
+      25,    26,   263,    37,   261,     0,     0,     0,     0,     0,
+       0,     0,     0,   159,     0,   239,     0,     0,    27,    28,
+       0,     0,     0,     0,    29,    30,    31,     0,    32,     0,
+       0,    33,    34,     0,    35,   258,    36,     4,     5,     6,
+       7,     8,     0,     9,    10,    11,    12,    13,    14,    15,
+       0,    16,     0,    17,    18,    19,     0,     0,    22,    23,
+      24,     0,    26,     0,     0,     0,     0,     0,     0,   183,
+     184,   185,   186,   187,   188,     0,     0,     0,     0,    27,
+      28,     0,     0,     0,     0,    29,    30,    31,     0,    32,
+     189,   190,    33,    34,   133,    35,     0,    36,     4,     5,
+       6,     7,     8,     0,     9,    10,    11,    12,    13,    14,
+      15,     0,    16,     0,    17,    18,    19,     0,     0,    22,
+      23,    24,     0,    26,     4,     5,     6,     7,     8,     0,
+       0,     0,    11,    12,     0,     0,     0,     0,     0,     0,
+      27,    28,     0,     0,     0,    22,    29,    30,    31,    26,
+      32,     0,     0,   105,    34,     0,    35,     0,     0,     0,
+       4,     5,     6,   158,     8,     0,    27,    28,    11,    12,
+      85,     0,    29,    30,    31,     0,    32,     0,     0,     0,
+       0,    22,    35,     0,     0,    26,     0,     0,     0,    86,
+      87,    88,    89,    90,    91,    92,    93,    94,    95,    96,
+      97,    98,    27,    28,    85,     0,    99,     0,    29,    30,
+      31,     0,    32,     0,     0,   223,     0,     0,    35,     0,
+       0,     0,     0,    86,    87,    88,    89,    90,    91,    92,
+      93,    94,    95,    96,    97,    98,     0,   180,     0,     0,
+      99,    49,    50,    51,    52,    53,    54,     0,     0,   241,
+      49,    50,    51,    52,    53,    54,     0,    85,     0,     0,
+       0,     0,    55,    56,     0,     0,    57,     0,     0,   163,
+       0,    55,    56,     0,     0,    57,    86,    87,    88,    89,
+      90,    91,    92,    93,    94,    95,    96,    97,    98,    85,
+       0,     0,     0,    99,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,    86,    87,
+      88,    89,    90,    91,    92,    93,    94,    95,    96,    97,
+      98,     0,     0,     0,     0,    99
+};
+
+static const yytype_int16 yycheck[] =
+{
+       9,    10,     1,    21,     6,    44,    58,    60,   181,     6,
+     167,    63,    24,    22,    23,    27,    28,    29,     6,     1,
+      32,    17,     3,    30,   104,   105,     6,    30,   152,   109,
+     154,     6,     7,   157,   131,   132,    35,    49,    50,    51,
+      52,    53,    54,   200,    22,    57,     6,    59,    60,   222,
+      52,    43,    44,    71,   178,    62,    37,    38,    39,    62,
+      41,    24,    30,    72,     6,     6,    61,   120,    61,    54,
+      61,    83,    61,    56,   127,   128,    88,    89,    90,    91,
+      92,    93,    94,    95,    96,    97,    98,    99,   100,   101,
+      58,    61,    47,    48,    49,    63,   220,    79,    79,    54,
+      61,    13,    56,    18,   103,   229,    30,     6,   120,    57,
+      30,   110,    61,    63,   238,   127,   128,   156,   171,   131,
+     132,    61,    61,    31,   204,    62,    41,    42,    43,    44,
+      45,    46,    47,    48,    49,     6,   216,   217,   262,    54,
+      62,   221,    16,    62,    61,     6,    57,   227,    57,    30,
+      63,   163,    62,   165,   234,    62,    62,    62,     6,   171,
+      45,    46,    47,    48,    49,    62,     6,    62,    52,    54,
+     182,   183,   184,   185,   186,   187,   188,     6,   258,    61,
+      63,    56,   181,     0,     1,    62,     3,     4,     5,     6,
+       7,    30,     9,    10,    11,    12,    13,    14,    15,    57,
+      17,     6,    19,    20,    21,    22,    23,    24,    25,    26,
+      27,    28,    62,     1,   257,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,   222,    -1,   237,    -1,    -1,    45,    46,
+      -1,    -1,    -1,    -1,    51,    52,    53,    -1,    55,    -1,
+      -1,    58,    59,    -1,    61,   254,    63,     3,     4,     5,
+       6,     7,    -1,     9,    10,    11,    12,    13,    14,    15,
+      -1,    17,    -1,    19,    20,    21,    -1,    -1,    24,    25,
+      26,    -1,    28,    -1,    -1,    -1,    -1,    -1,    -1,    31,
+      32,    33,    34,    35,    36,    -1,    -1,    -1,    -1,    45,
+      46,    -1,    -1,    -1,    -1,    51,    52,    53,    -1,    55,
+      52,    53,    58,    59,    60,    61,    -1,    63,     3,     4,
+       5,     6,     7,    -1,     9,    10,    11,    12,    13,    14,
+      15,    -1,    17,    -1,    19,    20,    21,    -1,    -1,    24,
+      25,    26,    -1,    28,     3,     4,     5,     6,     7,    -1,
+      -1,    -1,    11,    12,    -1,    -1,    -1,    -1,    -1,    -1,
+      45,    46,    -1,    -1,    -1,    24,    51,    52,    53,    28,
+      55,    -1,    -1,    58,    59,    -1,    61,    -1,    -1,    -1,
+       3,     4,     5,     6,     7,    -1,    45,    46,    11,    12,
+      18,    -1,    51,    52,    53,    -1,    55,    -1,    -1,    -1,
+      -1,    24,    61,    -1,    -1,    28,    -1,    -1,    -1,    37,
+      38,    39,    40,    41,    42,    43,    44,    45,    46,    47,
+      48,    49,    45,    46,    18,    -1,    54,    -1,    51,    52,
+      53,    -1,    55,    -1,    -1,    63,    -1,    -1,    61,    -1,
+      -1,    -1,    -1,    37,    38,    39,    40,    41,    42,    43,
+      44,    45,    46,    47,    48,    49,    -1,    18,    -1,    -1,
+      54,    31,    32,    33,    34,    35,    36,    -1,    -1,    63,
+      31,    32,    33,    34,    35,    36,    -1,    18,    -1,    -1,
+      -1,    -1,    52,    53,    -1,    -1,    56,    -1,    -1,    30,
+      -1,    52,    53,    -1,    -1,    56,    37,    38,    39,    40,
+      41,    42,    43,    44,    45,    46,    47,    48,    49,    18,
+      -1,    -1,    -1,    54,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    37,    38,
+      39,    40,    41,    42,    43,    44,    45,    46,    47,    48,
+      49,    -1,    -1,    -1,    -1,    54
+};
+
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
+{
+       0,    65,     0,     1,     3,     4,     5,     6,     7,     9,
+      10,    11,    12,    13,    14,    15,    17,    19,    20,    21,
+      22,    23,    24,    25,    26,    27,    28,    45,    46,    51,
+      52,    53,    55,    58,    59,    61,    63,    66,    68,    69,
+      71,    72,    83,    84,    85,    86,    87,    95,    95,    31,
+      32,    33,    34,    35,    36,    52,    53,    56,    98,    98,
+      98,     6,     6,    17,     6,    76,    76,    98,    98,    66,
+      71,    22,    24,    71,    71,    71,     6,     6,    71,    94,
+      69,    95,    95,    30,    95,    18,    37,    38,    39,    40,
+      41,    42,    43,    44,    45,    46,    47,    48,    49,    54,
+      96,    97,    95,    61,    82,    58,    67,    68,    69,    82,
+      61,    61,    71,    71,    71,    71,    71,    71,    70,    71,
+      61,    71,    77,    78,    78,    73,    74,    61,    61,    76,
+      98,    56,    56,    60,    68,    95,    62,    71,     6,    71,
+      71,    71,    71,    71,    71,    71,    71,    71,    71,    71,
+      71,    71,    71,    69,    67,    67,    13,    67,     6,    69,
+      81,     6,    57,    30,    78,    30,    61,    61,    78,    78,
+      75,    61,    70,    70,    99,    99,    62,    99,    82,    99,
+      18,    63,    31,    31,    32,    33,    34,    35,    36,    52,
+      53,    71,    62,    71,     6,    79,    80,    80,    62,    62,
+      61,    78,    57,    57,    16,    99,     6,    81,    71,    71,
+      71,    71,    71,    71,    71,    30,    62,    62,    80,    62,
+      67,    62,    63,    63,     6,    67,    67,    62,    99,    67,
+      81,     6,    67,    99,    62,    43,    44,    88,    67,    71,
+      99,    63,     6,    52,    89,    52,     6,    90,    63,    91,
+       6,     7,    92,    93,    62,    56,    61,    30,    98,    57,
+       6,    93,    67,    62,    99
+};
+
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
+{
+       0,    64,    65,    65,    65,    65,    65,    65,    65,    66,
+      66,    66,    66,    66,    66,    66,    66,    66,    66,    66,
+      66,    66,    66,    66,    66,    66,    66,    66,    66,    67,
+      67,    68,    68,    68,    68,    68,    68,    68,    68,    68,
+      68,    68,    68,    68,    68,    68,    68,    69,    69,    70,
+      70,    71,    71,    71,    71,    71,    71,    71,    71,    71,
+      71,    71,    71,    71,    71,    71,    71,    71,    71,    71,
+      71,    71,    71,    71,    71,    71,    71,    71,    71,    71,
+      71,    71,    73,    72,    74,    72,    75,    72,    76,    77,
+      77,    78,    78,    79,    79,    80,    80,    81,    81,    82,
+      83,    84,    85,    86,    87,    88,    88,    89,    89,    90,
+      91,    91,    92,    92,    93,    93,    94,    94,    94,    95,
+      95,    96,    97,    98,    99
+};
+
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     0,     2,     3,     3,     3,     3,     3,     3,
+       3,     3,     3,     3,     3,     2,     2,     2,     2,     6,
+       6,     6,     6,     6,     6,     5,     5,     5,     5,     1,
+       2,     3,     1,     1,     1,     2,     5,     3,     3,     1,
+       4,     7,     4,     5,    10,     8,    17,     1,     3,     1,
+       3,     1,     1,     1,     1,     4,     2,     2,     5,     6,
+       2,     3,     3,     3,     3,     3,     3,     3,     3,     3,
+       3,     3,     3,     3,     2,     4,     4,     2,     2,     3,
+       5,     1,     0,     7,     0,     7,     0,     8,     1,     1,
+       3,     0,     1,     1,     3,     0,     1,     0,     1,     3,
+       1,     1,     1,     1,     2,     1,     1,     2,     2,     0,
+       0,     2,     1,     3,     3,     4,     0,     2,     2,     1,
+       1,     1,     1,     0,     0
+};
+
+
+enum { YYENOMEM = -2 };
+
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
+
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
+
+
+#define YYRECOVERING()  (!!yyerrstatus)
+
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
+
+
+/* Enable debugging if requested.  */
+#if YYDEBUG
+
+# ifndef YYFPRINTF
+#  include <stdio.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYFPRINTF fprintf
+# endif
+
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
+static void
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+{
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  if (!yyvaluep)
+    return;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
+
+static void
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+{
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
+
+  yy_symbol_value_print (yyo, yykind, yyvaluep);
+  YYFPRINTF (yyo, ")");
+}
+
+/*------------------------------------------------------------------.
+| yy_stack_print -- Print the state stack from its BOTTOM up to its |
+| TOP (included).                                                   |
+`------------------------------------------------------------------*/
+
+static void
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
+{
+  YYFPRINTF (stderr, "Stack now");
+  for (; yybottom <= yytop; yybottom++)
+    {
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
+    }
+  YYFPRINTF (stderr, "\n");
+}
+
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
+
+
+/*------------------------------------------------.
+| Report that the YYRULE is going to be reduced.  |
+`------------------------------------------------*/
+
+static void
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule)
+{
+  int yylno = yyrline[yyrule];
+  int yynrhs = yyr2[yyrule];
+  int yyi;
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
+  /* The symbols being reduced.  */
+  for (yyi = 0; yyi < yynrhs; yyi++)
+    {
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)]);
+      YYFPRINTF (stderr, "\n");
+    }
+}
+
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule); \
+} while (0)
+
+/* Nonzero means print parse trace.  It is left uninitialized so that
+   multiple parsers can coexist.  */
+int yydebug;
+#else /* !YYDEBUG */
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
+# define YY_STACK_PRINT(Bottom, Top)
+# define YY_REDUCE_PRINT(Rule)
+#endif /* !YYDEBUG */
+
+
+/* YYINITDEPTH -- initial size of the parser's stacks.  */
+#ifndef YYINITDEPTH
+# define YYINITDEPTH 200
+#endif
+
+/* YYMAXDEPTH -- maximum size the stacks can grow to (effective only
+   if the built-in stack extension method is used).
+
+   Do not make this value too large; the results are undefined if
+   YYSTACK_ALLOC_MAXIMUM < YYSTACK_BYTES (YYMAXDEPTH)
+   evaluated with infinite-precision integer arithmetic.  */
+
+#ifndef YYMAXDEPTH
+# define YYMAXDEPTH 10000
+#endif
+
+
+
+
+
+
+/*-----------------------------------------------.
+| Release the memory associated to this symbol.  |
+`-----------------------------------------------*/
+
+static void
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep)
+{
+  YY_USE (yyvaluep);
+  if (!yymsg)
+    yymsg = "Deleting";
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/* Lookahead token kind.  */
+int yychar;
+
+/* The semantic value of the lookahead symbol.  */
+YYSTYPE yylval;
+/* Number of syntax errors so far.  */
+int yynerrs;
+
+
+
+
+/*----------.
+| yyparse.  |
+`----------*/
+
+int
+yyparse (void)
+{
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
+
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
+
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
+
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
+
+  int yyn;
+  /* The return value of yyparse.  */
+  int yyresult;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
+  /* The variables used to return semantic value and location from the
+     action routines.  */
+  YYSTYPE yyval;
+
+
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+
+  /* The number of symbols on the RHS of the reduced rule.
+     Keep to zero when no symbol should be popped.  */
+  int yylen = 0;
+
+  YYDPRINTF ((stderr, "Starting parse\n"));
+
+  yychar = YYEMPTY; /* Cause a token to be read.  */
+
+  goto yysetstate;
+
+
+/*------------------------------------------------------------.
+| yynewstate -- push a new state, which is found in yystate.  |
+`------------------------------------------------------------*/
+yynewstate:
+  /* In all cases, when you get here, the value and location stacks
+     have just been pushed.  So pushing a state here evens the stacks.  */
+  yyssp++;
+
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
+
+  if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
+    {
+      /* Get the current used size of the three stacks, in elements.  */
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
+
+# if defined yyoverflow
+      {
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
+      }
+# else /* defined YYSTACK_RELOCATE */
+      /* Extend the stack our own way.  */
+      if (YYMAXDEPTH <= yystacksize)
+        YYNOMEM;
+      yystacksize *= 2;
+      if (YYMAXDEPTH < yystacksize)
+        yystacksize = YYMAXDEPTH;
+
+      {
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+#  undef YYSTACK_RELOCATE
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
+      }
+# endif
+
+      yyssp = yyss + yysize - 1;
+      yyvsp = yyvs + yysize - 1;
+
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
+
+      if (yyss + yystacksize - 1 <= yyssp)
+        YYABORT;
+    }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
+
+
+  if (yystate == YYFINAL)
+    YYACCEPT;
+
+  goto yybackup;
+
+
+/*-----------.
+| yybackup.  |
+`-----------*/
+yybackup:
+  /* Do appropriate processing given the current state.  Read a
+     lookahead token if we need one and don't already have one.  */
+
+  /* First try to decide what to do without reference to lookahead token.  */
+  yyn = yypact[yystate];
+  if (yypact_value_is_default (yyn))
+    goto yydefault;
+
+  /* Not known => get a lookahead token if don't already have one.  */
+
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
+  if (yychar == YYEMPTY)
+    {
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex ();
+    }
+
+  if (yychar <= YYEOF)
+    {
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
+      YYDPRINTF ((stderr, "Now at end of input.\n"));
+    }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
+  else
+    {
+      yytoken = YYTRANSLATE (yychar);
+      YY_SYMBOL_PRINT ("Next token is", yytoken, &yylval, &yylloc);
+    }
+
+  /* If the proper action on seeing token YYTOKEN is to reduce or to
+     detect an error, take that action.  */
+  yyn += yytoken;
+  if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != yytoken)
+    goto yydefault;
+  yyn = yytable[yyn];
+  if (yyn <= 0)
+    {
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
+      yyn = -yyn;
+      goto yyreduce;
+    }
+
+  /* Count tokens shifted since error; after three, turn off error
+     status.  */
+  if (yyerrstatus)
+    yyerrstatus--;
+
+  /* Shift the lookahead token.  */
+  YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
+  yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
+  goto yynewstate;
+
+
+/*-----------------------------------------------------------.
+| yydefault -- do the default action for the current state.  |
+`-----------------------------------------------------------*/
+yydefault:
+  yyn = yydefact[yystate];
+  if (yyn == 0)
+    goto yyerrlab;
+  goto yyreduce;
+
+
+/*-----------------------------.
+| yyreduce -- do a reduction.  |
+`-----------------------------*/
+yyreduce:
+  /* yyn is the number of a rule to reduce with.  */
+  yylen = yyr2[yyn];
+
+  /* If YYLEN is nonzero, implement the default value of the action:
+     '$$ = $1'.
+
+     Otherwise, the following line sets YYVAL to garbage.
+     This behavior is undocumented and Bison
+     users should not rely upon it.  Assigning to YYVAL
+     unconditionally makes the parser a bit smaller, and it avoids a
+     GCC warning that YYVAL may be used uninitialized.  */
+  yyval = yyvsp[1-yylen];
+
+
+  YY_REDUCE_PRINT (yyn);
+  switch (yyn)
+    {
+  case 2: /* list: %empty  */
+#line 102 "gramm.y"
+                                { indef = inloop = parloop = 0; }
+#line 1448 "gramm.c"
+    break;
+
+  case 4: /* list: list defn term  */
+#line 104 "gramm.y"
+                                { oprcode(NULL); return 1; }
+#line 1454 "gramm.c"
+    break;
+
+  case 5: /* list: list stmt term  */
+#line 105 "gramm.y"
+                                { oprcode(NULL); optcode(); return 1; }
+#line 1460 "gramm.c"
+    break;
+
+  case 6: /* list: list asgn term  */
+#line 106 "gramm.y"
+                                { oprcode(oprpop); oprcode(NULL); return 1; }
+#line 1466 "gramm.c"
+    break;
+
+  case 7: /* list: list exprlist term  */
+#line 107 "gramm.y"
+                                { oprcode(println); oprcode(NULL); return 1; }
+#line 1472 "gramm.c"
+    break;
+
+  case 8: /* list: list error term  */
+#line 108 "gramm.y"
+                                { yyerrok; parloop = 0; }
+#line 1478 "gramm.c"
+    break;
+
+  case 9: /* asgn: VAR '=' expr  */
+#line 112 "gramm.y"
+                                { (yyval.inst) = (yyvsp[0].inst); oprcode(assign); namecode((yyvsp[-2].name)); }
+#line 1484 "gramm.c"
+    break;
+
+  case 10: /* asgn: VAR ADDEQ expr  */
+#line 113 "gramm.y"
+                                { (yyval.inst) = (yyvsp[0].inst); oprcode(addeq); namecode((yyvsp[-2].name)); }
+#line 1490 "gramm.c"
+    break;
+
+  case 11: /* asgn: VAR SUBEQ expr  */
+#line 114 "gramm.y"
+                                { (yyval.inst) = (yyvsp[0].inst); oprcode(subeq); namecode((yyvsp[-2].name)); }
+#line 1496 "gramm.c"
+    break;
+
+  case 12: /* asgn: VAR MULEQ expr  */
+#line 115 "gramm.y"
+                                { (yyval.inst) = (yyvsp[0].inst); oprcode(muleq); namecode((yyvsp[-2].name)); }
+#line 1502 "gramm.c"
+    break;
+
+  case 13: /* asgn: VAR DIVEQ expr  */
+#line 116 "gramm.y"
+                                { (yyval.inst) = (yyvsp[0].inst); oprcode(diveq); namecode((yyvsp[-2].name)); }
+#line 1508 "gramm.c"
+    break;
+
+  case 14: /* asgn: VAR MODEQ expr  */
+#line 117 "gramm.y"
+                                { (yyval.inst) = (yyvsp[0].inst); oprcode(modeq); namecode((yyvsp[-2].name)); }
+#line 1514 "gramm.c"
+    break;
+
+  case 15: /* asgn: INC VAR  */
+#line 118 "gramm.y"
+                                { (yyval.inst) = oprcode(preinc); namecode((yyvsp[0].name)); }
+#line 1520 "gramm.c"
+    break;
+
+  case 16: /* asgn: DEC VAR  */
+#line 119 "gramm.y"
+                                { (yyval.inst) = oprcode(predec); namecode((yyvsp[0].name)); }
+#line 1526 "gramm.c"
+    break;
+
+  case 17: /* asgn: VAR INC  */
+#line 120 "gramm.y"
+                                { (yyval.inst) = oprcode(postinc); namecode((yyvsp[-1].name)); }
+#line 1532 "gramm.c"
+    break;
+
+  case 18: /* asgn: VAR DEC  */
+#line 121 "gramm.y"
+                                { (yyval.inst) = oprcode(postdec); namecode((yyvsp[-1].name)); }
+#line 1538 "gramm.c"
+    break;
+
+  case 19: /* asgn: VAR '[' index ']' '=' expr  */
+#line 122 "gramm.y"
+                                         { (yyval.inst) = (yyvsp[-3].inst); elemcode((yyvsp[-5].name), ELEMSET); }
+#line 1544 "gramm.c"
+    break;
+
+  case 20: /* asgn: VAR '[' index ']' ADDEQ expr  */
+#line 123 "gramm.y"
+                                         { (yyval.inst) = (yyvsp[-3].inst); elemcode((yyvsp[-5].name), ELEMADD); }
+#line 1550 "gramm.c"
+    break;
+
+  case 21: /* asgn: VAR '[' index ']' SUBEQ expr  */
+#line 124 "gramm.y"
+                                         { (yyval.inst) = (yyvsp[-3].inst); elemcode((yyvsp[-5].name), ELEMSUB); }
+#line 1556 "gramm.c"
+    break;
+
+  case 22: /* asgn: VAR '[' index ']' MULEQ expr  */
+#line 125 "gramm.y"
+                                         { (yyval.inst) = (yyvsp[-3].inst); elemcode((yyvsp[-5].name), ELEMMUL); }
+#line 1562 "gramm.c"
+    break;
+
+  case 23: /* asgn: VAR '[' index ']' DIVEQ expr  */
+#line 126 "gramm.y"
+                                         { (yyval.inst) = (yyvsp[-3].inst); elemcode((yyvsp[-5].name), ELEMDIV); }
+#line 1568 "gramm.c"
+    break;
+
+  case 24: /* asgn: VAR '[' index ']' MODEQ expr  */
+#line 127 "gramm.y"
+                                         { (yyval.inst) = (yyvsp[-3].inst); elemcode((yyvsp[-5].name), ELEMMOD); }
+#line 1574 "gramm.c"
+    break;
+
+  case 25: /* asgn: INC VAR '[' index ']'  */
+#line 128 "gramm.y"
+                                         { (yyval.inst) = (yyvsp[-1].inst); oprcode(constpush); valcode(1.0); elemcode((yyvsp[-3].name), ELEMADD); }
+#line 1580 "gramm.c"
+    break;
+
+  case 26: /* asgn: DEC VAR '[' index ']'  */
+#line 129 "gramm.y"
+                                         { (yyval.inst) = (yyvsp[-1].inst); oprcode(constpush); valcode(1.0); elemcode((yyvsp[-3].name), ELEMSUB); }
+#line 1586 "gramm.c"
+    break;
+
+  case 27: /* asgn: VAR '[' index ']' INC  */
+#line 130 "gramm.y"
+                                         { (yyval.inst) = (yyvsp[-2].inst); elemcode((yyvsp[-4].name), ELEMINC); }
+#line 1592 "gramm.c"
+    break;
+
+  case 28: /* asgn: VAR '[' index ']' DEC  */
+#line 131 "gramm.y"
+                                         { (yyval.inst) = (yyvsp[-2].inst); elemcode((yyvsp[-4].name), ELEMDEC); }
+#line 1598 "gramm.c"
+    break;
+
+  case 30: /* stmtnl: '\n' stmtnl  */
+#line 137 "gramm.y"
+                                { (yyval.inst) = (yyvsp[0].inst); }
+#line 1604 "gramm.c"
+    break;
+
+  case 31: /* stmt: '{' stmtlist '}'  */
+#line 141 "gramm.y"
+                                                { (yyval.inst) = (yyvsp[-1].inst); }
+#line 1610 "gramm.c"
+    break;
+
+  case 32: /* stmt: BREAK  */
+#line 142 "gramm.y"
+                                                { looponly((yyvsp[0].name)->s); serialonly((yyvsp[0].name)->s); (yyval.inst) = oprcode(breakcode); }
+#line 1616 "gramm.c"
+    break;
+
+  case 33: /* stmt: CONTINUE  */
+#line 143 "gramm.y"
+                                                { looponly((yyvsp[0].name)->s); (yyval.inst) = oprcode(continuecode); }
+#line 1622 "gramm.c"
+    break;
+
+  case 34: /* stmt: RETURN  */
+#line 144 "gramm.y"
+                                                { defnonly(); (yyval.inst) = oprcode(procret); }
+#line 1628 "gramm.c"
+    break;
+
+  case 35: /* stmt: RETURN expr  */
+#line 145 "gramm.y"
+                                                { (yyval.inst) = (yyvsp[0].inst); defnonly(); oprcode(funcret); }
+#line 1634 "gramm.c"
+    break;
+
+  case 36: /* stmt: PROCEDURE begin '(' arglist ')'  */
+#line 146 "gramm.y"
+                                                { (yyval.inst) = (yyvsp[-3].inst); callcode((yyvsp[-4].name), (yyvsp[-1].narg)); }
+#line 1640 "gramm.c"
+    break;
+
+  case 37: /* stmt: PRINT begin arglist  */
+#line 147 "gramm.y"
+                                                { (yyval.inst) = (yyvsp[-1].inst); oprcode(_print); argcode((yyvsp[0].narg)); }
+#line 1646 "gramm.c"
+    break;
+
+  case 38: /* stmt: PRINTF begin arglist  */
+#line 148 "gramm.y"
+                                                { (yyval.inst) = (yyvsp[-1].inst); oprcode(_printf); argcode((yyvsp[0].narg)); }
+#line 1652 "gramm.c"
+    break;
+
+  case 39: /* stmt: exprlist  */
+#line 149 "gramm.y"
+                                                { oprcode(oprpop); }
+#line 1658 "gramm.c"
+    break;
+
+  case 40: /* stmt: if cond stmtnl end  */
+#line 150 "gramm.y"
+                                                { fill3((yyvsp[-3].inst), (yyvsp[-1].inst), NULL, (yyvsp[0].inst)); }
+#line 1664 "gramm.c"
+    break;
+
+  case 41: /* stmt: if cond stmtnl end ELSE stmtnl end  */
+#line 151 "gramm.y"
+                                                { fill3((yyvsp[-6].inst), (yyvsp[-4].inst), (yyvsp[-1].inst), (yyvsp[0].inst)); }
+#line 1670 "gramm.c"
+    break;
+
+  case 42: /* stmt: while cond stmtnl end  */
+#line 152 "gramm.y"
+                                                { fill2((yyvsp[-3].inst), (yyvsp[-1].inst), (yyvsp[0].inst)); inloop--; }
+#line 1676 "gramm.c"
+    break;
+
+  case 43: /* stmt: do stmtnl WHILE cond end  */
+#line 153 "gramm.y"
+                                                { fill2((yyvsp[-4].inst), (yyvsp[-1].inst), (yyvsp[0].inst)); inloop--; }
+#line 1682 "gramm.c"
+    break;
+
+  case 44: /* stmt: forloop '(' forcond ';' forcond ';' forcond ')' stmtnl end  */
+#line 154 "gramm.y"
+                                                                     { fill4((yyvsp[-9].inst), (yyvsp[-5].inst), (yyvsp[-3].inst), (yyvsp[-1].inst), (yyvsp[0].inst)); inloop--; }
+#line 1688 "gramm.c"
+    break;
+
+  case 45: /* stmt: forloop '(' VAR IN VAR ')' stmtnl end  */
+#line 155 "gramm.y"
+                                                { (yyvsp[-7].inst)->u.opr = forincode; fillin((yyvsp[-7].inst), (yyvsp[-5].name), (yyvsp[-3].name), (yyvsp[-1].inst), (yyvsp[0].inst)); inloop--; }
+#line 1694 "gramm.c"
+    break;
+
+  case 46: /* stmt: parfor '(' VAR '=' expr ';' VAR parcmp expr ';' parstep parhead parclauses ')' begin stmtnl end  */
+#line 156 "gramm.y"
+                                                                                                          {
+		if ((yyvsp[-10].name) != (yyvsp[-14].name) || (yyvsp[-6].name) != (yyvsp[-14].name))
+			yyerror("parallel loop must compare and increment %s", (yyvsp[-14].name)->s);
+		fillpar((yyvsp[-5].inst), (yyvsp[-14].name), (yyvsp[-9].narg), (yyvsp[-2].inst), (yyvsp[0].inst));
+		verifypar((yyvsp[-5].inst), indef ? defparams : NULL);
+		(yyval.inst) = (yyvsp[-12].inst);
+		parloop = (yyvsp[-16].narg);
+		inloop--;
+	  }
+#line 1708 "gramm.c"
+    break;
+
+  case 50: /* index: expr ',' expr  */
+#line 175 "gramm.y"
+                                                { oprcode(matindex); namecode((yyvsp[(-1) - (3)].name)); }
+#line 1714 "gramm.c"
+    break;
+
+  case 51: /* expr: NUMBER  */
+#line 179 "gramm.y"
+                                                { (yyval.inst) = oprcode(constpush); valcode((yyvsp[0].val)); }
+#line 1720 "gramm.c"
+    break;
+
+  case 52: /* expr: STRING  */
+#line 180 "gramm.y"
+                                                { (yyval.inst) = oprcode(strpush); strcode((yyvsp[0].str)); }
+#line 1726 "gramm.c"
+    break;
+
+  case 53: /* expr: PREVIOUS  */
+#line 181 "gramm.y"
+                                                { (yyval.inst) = oprcode(prevpush); }
+#line 1732 "gramm.c"
+    break;
+
+  case 54: /* expr: VAR  */
+#line 182 "gramm.y"
+                                                { (yyval.inst) = oprcode(eval); namecode((yyvsp[0].name)); }
+#line 1738 "gramm.c"
+    break;
+
+  case 55: /* expr: VAR '[' index ']'  */
+#line 183 "gramm.y"
+                                                { (yyval.inst) = (yyvsp[-1].inst); oprcode(elempush); namecode((yyvsp[-3].name)); }
+#line 1744 "gramm.c"
+    break;
+
+  case 56: /* expr: READ VAR  */
+#line 184 "gramm.y"
+                                                { oprcode(readnum); namecode((yyvsp[0].name)); }
+#line 1750 "gramm.c"
+    break;
+
+  case 57: /* expr: GETLINE VAR  */
+#line 185 "gramm.y"
+                                                { oprcode(readline); namecode((yyvsp[0].name)); }
+#line 1756 "gramm.c"
+    break;
+
+  case 58: /* expr: FUNCTION begin '(' arglist ')'  */
+#line 186 "gramm.y"
+                                                { (yyval.inst) = (yyvsp[-3].inst); callcode((yyvsp[-4].name), (yyvsp[-1].narg)); }
+#line 1762 "gramm.c"
+    break;
+
+  case 59: /* expr: SPAWN FUNCTION begin '(' arglist ')'  */
+#line 187 "gramm.y"
+                                                { (yyval.inst) = (yyvsp[-3].inst); oprcode(spawncode); namecode((yyvsp[-4].name)); argcode((yyvsp[-1].narg)); }
+#line 1768 "gramm.c"
+    break;
+
+  case 60: /* expr: '$' expr  */
+#line 188 "gramm.y"
+                                                { (yyval.inst) = (yyvsp[0].inst); oprcode(cmdarg); }
+#line 1774 "gramm.c"
+    break;
+
+  case 61: /* expr: expr '+' expr  */
+#line 189 "gramm.y"
+                                                { oprcode(add); }
+#line 1780 "gramm.c"
+    break;
+
+  case 62: /* expr: expr '-' expr  */
+#line 190 "gramm.y"
+                                                { oprcode(sub); }
+#line 1786 "gramm.c"
+    break;
+
+  case 63: /* expr: expr '*' expr  */
+#line 191 "gramm.y"
+                                                { oprcode(mul); }
+#line 1792 "gramm.c"
+    break;
+
+  case 64: /* expr: expr '/' expr  */
+#line 192 "gramm.y"
+                                                { oprcode(divd); }
+#line 1798 "gramm.c"
+    break;
+
+  case 65: /* expr: expr '%' expr  */
+#line 193 "gramm.y"
+                                                { oprcode(mod); }
+#line 1804 "gramm.c"
+    break;
+
+  case 66: /* expr: expr '^' expr  */
+#line 194 "gramm.y"
+                                                { oprcode(power); }
+#line 1810 "gramm.c"
+    break;
+
+  case 67: /* expr: expr GT expr  */
+#line 195 "gramm.y"
+                                                { oprcode(gt); }
+#line 1816 "gramm.c"
+    break;
+
+  case 68: /* expr: expr GE expr  */
+#line 196 "gramm.y"
+                                                { oprcode(ge); }
+#line 1822 "gramm.c"
+    break;
+
+  case 69: /* expr: expr LT expr  */
+#line 197 "gramm.y"
+                                                { oprcode(lt); }
+#line 1828 "gramm.c"
+    break;
+
+  case 70: /* expr: expr LE expr  */
+#line 198 "gramm.y"
+                                                { oprcode(le); }
+#line 1834 "gramm.c"
+    break;
+
+  case 71: /* expr: expr EQ expr  */
+#line 199 "gramm.y"
+                                                { oprcode(eq); }
+#line 1840 "gramm.c"
+    break;
+
+  case 72: /* expr: expr NE expr  */
+#line 200 "gramm.y"
+                                                { oprcode(ne); }
+#line 1846 "gramm.c"
+    break;
+
+  case 73: /* expr: expr IN VAR  */
+#line 201 "gramm.y"
+                                                { oprcode(inmap); namecode((yyvsp[0].name)); }
+#line 1852 "gramm.c"
+    break;
+
+  case 74: /* expr: NOT expr  */
+#line 202 "gramm.y"
+                                                { (yyval.inst) = (yyvsp[0].inst); oprcode(not); }
+#line 1858 "gramm.c"
+    break;
+
+  case 75: /* expr: expr and expr end  */
+#line 203 "gramm.y"
+                                                { fill2((yyvsp[-2].inst), (yyvsp[-1].inst), (yyvsp[0].inst)); }
+#line 1864 "gramm.c"
+    break;
+
+  case 76: /* expr: expr or expr end  */
+#line 204 "gramm.y"
+                                                { fill2((yyvsp[-2].inst), (yyvsp[-1].inst), (yyvsp[0].inst)); }
+#line 1870 "gramm.c"
+    break;
+
+  case 77: /* expr: '-' expr  */
+#line 205 "gramm.y"
+                                                { (yyval.inst) = (yyvsp[0].inst); oprcode(negate); }
+#line 1876 "gramm.c"
+    break;
+
+  case 78: /* expr: '+' expr  */
+#line 206 "gramm.y"
+                                                { (yyval.inst) = (yyvsp[0].inst); }
+#line 1882 "gramm.c"
+    break;
+
+  case 79: /* expr: '(' exprlist ')'  */
+#line 207 "gramm.y"
+                                                { (yyval.inst) = (yyvsp[-1].inst); }
+#line 1888 "gramm.c"
+    break;
+
+  case 80: /* expr: BLTIN begin '(' arglist ')'  */
+#line 208 "gramm.y"
+                                                { (yyval.inst) = (yyvsp[-3].inst); oprcode(bltin); namecode((yyvsp[-4].name)); argcode((yyvsp[-1].narg)); }
+#line 1894 "gramm.c"
+    break;
+
+  case 82: /* $@1: %empty  */
+#line 213 "gramm.y"
+                                        { indef = 1; verifydef((yyvsp[0].name), FUNCTION); }
+#line 1900 "gramm.c"
+    break;
+
+  case 83: /* defn: FUNC procname $@1 '(' paramlist ')' stmtnl  */
+#line 214 "gramm.y"
+                                        { oprcode(procret); define((yyvsp[-5].name), (yyvsp[-2].name)); indef = 0; }
+#line 1906 "gramm.c"
+    break;
+
+  case 84: /* $@2: %empty  */
+#line 215 "gramm.y"
+                                        { indef = 1; verifydef((yyvsp[0].name), PROCEDURE); }
+#line 1912 "gramm.c"
+    break;
+
+  case 85: /* defn: PROC procname $@2 '(' paramlist ')' stmtnl  */
+#line 216 "gramm.y"
+                                        { oprcode(procret); define((yyvsp[-5].name), (yyvsp[-2].name)); indef = 0; }
+#line 1918 "gramm.c"
+    break;
+
+  case 86: /* $@3: %empty  */
+#line 217 "gramm.y"
+                                        { indef = 1; verifydef((yyvsp[0].name), FUNCTION); }
+#line 1924 "gramm.c"
+    break;
+
+  case 87: /* defn: MEMO FUNC procname $@3 '(' paramlist ')' stmtnl  */
+#line 218 "gramm.y"
+                                        { oprcode(procret); define((yyvsp[-5].name), (yyvsp[-2].name)); indef = 0; memoize((yyvsp[-5].name)); }
+#line 1930 "gramm.c"
+    break;
+
+  case 89: /* args: expr  */
+#line 226 "gramm.y"
+                                { (yyval.narg) = 1; }
+#line 1936 "gramm.c"
+    break;
+
+  case 90: /* args: args ',' expr  */
+#line 227 "gramm.y"
+                                { (yyval.narg) = (yyvsp[-2].narg) + 1; }
+#line 1942 "gramm.c"
+    break;
+
+  case 91: /* arglist: %empty  */
+#line 231 "gramm.y"
+                                        { (yyval.narg) = 0; }
+#line 1948 "gramm.c"
+    break;
+
+  case 93: /* params: VAR  */
+#line 240 "gramm.y"
+                                { (yyval.name) = installlocalname((yyvsp[0].name)->s, NULL); }
+#line 1954 "gramm.c"
+    break;
+
+  case 94: /* params: params ',' VAR  */
+#line 241 "gramm.y"
+                                { (yyval.name) = installlocalname((yyvsp[0].name)->s, (yyvsp[-2].name)); }
+#line 1960 "gramm.c"
+    break;
+
+  case 95: /* paramlist: %empty  */
+#line 245 "gramm.y"
+                                { (yyval.name) = defparams = NULL; }
+#line 1966 "gramm.c"
+    break;
+
+  case 96: /* paramlist: params  */
+#line 246 "gramm.y"
+                                { (yyval.name) = defparams = (yyvsp[0].name); }
+#line 1972 "gramm.c"
+    break;
+
+  case 97: /* forcond: %empty  */
+#line 250 "gramm.y"
+                        { oprcode(NULL); }
+#line 1978 "gramm.c"
+    break;
+
+  case 98: /* forcond: exprlist  */
+#line 251 "gramm.y"
+                        { oprcode(NULL); }
+#line 1984 "gramm.c"
+    break;
+
+  case 99: /* cond: '(' exprlist ')'  */
+#line 255 "gramm.y"
+                            { oprcode(NULL); (yyval.inst) = (yyvsp[-1].inst); }
+#line 1990 "gramm.c"
+    break;
+
+  case 100: /* if: IF  */
+#line 259 "gramm.y"
+                { (yyval.inst) = oprcode(ifcode); oprcode(NULL); oprcode(NULL); oprcode(NULL); }
+#line 1996 "gramm.c"
+    break;
+
+  case 101: /* do: DO  */
+#line 263 "gramm.y"
+                { (yyval.inst) = oprcode(docode); oprcode(NULL); oprcode(NULL); inloop++; }
+#line 2002 "gramm.c"
+    break;
+
+  case 102: /* while: WHILE  */
+#line 267 "gramm.y"
+                { (yyval.inst) = oprcode(whilecode); oprcode(NULL); oprcode(NULL); inloop++; }
+#line 2008 "gramm.c"
+    break;
+
+  case 103: /* forloop: FOR  */
+#line 271 "gramm.y"
+                { (yyval.inst) = oprcode(forcode); oprcode(NULL); oprcode(NULL); oprcode(NULL); oprcode(NULL); inloop++; }
+#line 2014 "gramm.c"
+    break;
+
+  case 104: /* parfor: PARALLEL FOR  */
+#line 276 "gramm.y"
+                        { (yyval.narg) = parloop; parloop = ++inloop; }
+#line 2020 "gramm.c"
+    break;
+
+  case 105: /* parcmp: LT  */
+#line 281 "gramm.y"
+                { (yyval.narg) = 0; }
+#line 2026 "gramm.c"
+    break;
+
+  case 106: /* parcmp: LE  */
+#line 282 "gramm.y"
+                { (yyval.narg) = 1; }
+#line 2032 "gramm.c"
+    break;
+
+  case 107: /* parstep: VAR INC  */
+#line 286 "gramm.y"
+                        { (yyval.name) = (yyvsp[-1].name); }
+#line 2038 "gramm.c"
+    break;
+
+  case 108: /* parstep: INC VAR  */
+#line 287 "gramm.y"
+                        { (yyval.name) = (yyvsp[0].name); }
+#line 2044 "gramm.c"
+    break;
+
+  case 109: /* parhead: %empty  */
+#line 292 "gramm.y"
+                        { (yyval.inst) = oprcode(parforcode); oprcode(NULL); oprcode(NULL); oprcode(NULL); oprcode(NULL); }
+#line 2050 "gramm.c"
+    break;
+
+  case 114: /* parclause: VAR '[' ']'  */
+#line 307 "gramm.y"
+                                { namecode((yyvsp[-2].name)); argcode(PAROUT); }
+#line 2056 "gramm.c"
+    break;
+
+  case 115: /* parclause: BLTIN '(' VAR ')'  */
+#line 308 "gramm.y"
+                                { namecode((yyvsp[-1].name)); argcode(reduction((yyvsp[-3].name)->s)); }
+#line 2062 "gramm.c"
+    break;
+
+  case 116: /* stmtlist: %empty  */
+#line 312 "gramm.y"
+                        { (yyval.inst) = getprogp(); }
+#line 2068 "gramm.c"
+    break;
+
+  case 121: /* and: AND  */
+#line 323 "gramm.y"
+                { (yyval.inst) = oprcode(and); oprcode(NULL); oprcode(NULL); }
+#line 2074 "gramm.c"
+    break;
+
+  case 122: /* or: OR  */
+#line 327 "gramm.y"
+                { (yyval.inst) = oprcode(or); oprcode(NULL); oprcode(NULL); }
+#line 2080 "gramm.c"
+    break;
+
+  case 123: /* begin: %empty  */
+#line 331 "gramm.y"
+                                { (yyval.inst) = getprogp(); }
+#line 2086 "gramm.c"
+    break;
+
+  case 124: /* end: %empty  */
+#line 335 "gramm.y"
+                                { oprcode(NULL); (yyval.inst) = getprogp(); }
+#line 2092 "gramm.c"
+    break;
+
+
+#line 2096 "gramm.c"
+
+      default: break;
+    }
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
+
+  YYPOPSTACK (yylen);
+  yylen = 0;
+
+  *++yyvsp = yyval;
+
+  /* Now 'shift' the result of the reduction.  Determine what state
+     that goes to, based on the state we popped back to and the rule
+     number reduced by.  */
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
+
+  goto yynewstate;
+
+
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
+yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
+  /* If not already recovering from an error, report this error.  */
+  if (!yyerrstatus)
+    {
+      ++yynerrs;
+      yyerror (YY_("syntax error"));
+    }
+
+  if (yyerrstatus == 3)
+    {
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
+
+      if (yychar <= YYEOF)
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
+      else
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval);
+          yychar = YYEMPTY;
+        }
+    }
+
+  /* Else will try to reuse lookahead token after shifting the error
+     token.  */
+  goto yyerrlab1;
+
+
+/*---------------------------------------------------.
+| yyerrorlab -- error raised explicitly by YYERROR.  |
+`---------------------------------------------------*/
+yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
+
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYERROR.  */
+  YYPOPSTACK (yylen);
+  yylen = 0;
+  YY_STACK_PRINT (yyss, yyssp);
+  yystate = *yyssp;
+  goto yyerrlab1;
+
+
+/*-------------------------------------------------------------.
+| yyerrlab1 -- common code for both syntax error and YYERROR.  |
+`-------------------------------------------------------------*/
+yyerrlab1:
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
+
+  /* Pop stack until we find a state that shifts the error token.  */
+  for (;;)
+    {
+      yyn = yypact[yystate];
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
+
+      /* Pop the current state because it cannot handle the error token.  */
+      if (yyssp == yyss)
+        YYABORT;
+
+
+      yydestruct ("Error: popping",
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp);
+      YYPOPSTACK (1);
+      yystate = *yyssp;
+      YY_STACK_PRINT (yyss, yyssp);
+    }
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+
+  /* Shift the error token.  */
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
+
+  yystate = yyn;
+  goto yynewstate;
+
+
+/*-------------------------------------.
+| yyacceptlab -- YYACCEPT comes here.  |
+`-------------------------------------*/
+yyacceptlab:
+  yyresult = 0;
+  goto yyreturnlab;
+
+
+/*-----------------------------------.
+| yyabortlab -- YYABORT comes here.  |
+`-----------------------------------*/
+yyabortlab:
+  yyresult = 1;
+  goto yyreturnlab;
+
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
+yyexhaustedlab:
+  yyerror (YY_("memory exhausted"));
+  yyresult = 2;
+  goto yyreturnlab;
+
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
+  if (yychar != YYEMPTY)
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYABORT or YYACCEPT.  */
+  YYPOPSTACK (yylen);
+  YY_STACK_PRINT (yyss, yyssp);
+  while (yyssp != yyss)
+    {
+      yydestruct ("Cleanup: popping",
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp);
+      YYPOPSTACK (1);
+    }
+#ifndef yyoverflow
+  if (yyss != yyssa)
+    YYSTACK_FREE (yyss);
+#endif
+
+  return yyresult;
+}
+
+#line 338 "gramm.y"
+
+
+/* error if using break/continue out of loop */
+static void
+looponly(const char *s)
+{
+	if (!inloop)
+		yyerror("%s used outside loop", s);
+}
+
+/* error if using break in the body of a parallel loop, whose iterations all run */
+static void
+serialonly(const char *s)
+{
+	if (parloop && inloop == parloop)
+		yyerror("%s used in parallel loop", s);
+}
+
+/* error if using return out of function definition, or in a parallel loop */
+static void
+defnonly(void)
+{
+	if (!indef)
+		yyerror("return used outside definition");
+	if (parloop)
+		yyerror("return used in parallel loop");
+}
+
+/* get the reduction of a parallel loop named by bltin s */
+static int
+reduction(const char *s)
+{
+	if (strcmp(s, "sum") == 0)
+		return PARSUM;
+	if (strcmp(s, "min") == 0)
+		return PARMIN;
+	if (strcmp(s, "max") == 0)
+		return PARMAX;
+	yyerror("%s is no reduction", s);
+	return 0;
+}
@@ -0,0 +1,181 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison interface for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+#ifndef YY_YY_GRAMM_H_INCLUDED
+# define YY_YY_GRAMM_H_INCLUDED
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
+#endif
+#if YYDEBUG
+extern int yydebug;
+#endif
+
+/* Token kinds.  */
+#ifndef YYTOKENTYPE
+# define YYTOKENTYPE
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    STRING = 258,                  /* STRING  */
+    NUMBER = 259,                  /* NUMBER  */
+    PREVIOUS = 260,                /* PREVIOUS  */
+    VAR = 261,                     /* VAR  */
+    BLTIN = 262,                   /* BLTIN  */
+    UNDEF = 263,                   /* UNDEF  */
+    PRINT = 264,                   /* PRINT  */
+    PRINTF = 265,                  /* PRINTF  */
+    READ = 266,                    /* READ  */
+    GETLINE = 267,                 /* GETLINE  */
+    WHILE = 268,                   /* WHILE  */
+    DO = 269,                      /* DO  */
+    IF = 270,                      /* IF  */
+    ELSE = 271,                    /* ELSE  */
+    FOR = 272,                     /* FOR  */
+    IN = 273,                      /* IN  */
+    BREAK = 274,                   /* BREAK  */
+    CONTINUE = 275,                /* CONTINUE  */
+    PARALLEL = 276,                /* PARALLEL  */
+    FUNC = 277,                    /* FUNC  */
+    PROC = 278,                    /* PROC  */
+    FUNCTION = 279,                /* FUNCTION  */
+    PROCEDURE = 280,               /* PROCEDURE  */
+    RETURN = 281,                  /* RETURN  */
+    MEMO = 282,                    /* MEMO  */
+    SPAWN = 283,                   /* SPAWN  */
+    LOWEST = 284,                  /* LOWEST  */
+    ADDEQ = 285,                   /* ADDEQ  */
+    SUBEQ = 286,                   /* SUBEQ  */
+    MULEQ = 287,                   /* MULEQ  */
+    DIVEQ = 288,                   /* DIVEQ  */
+    MODEQ = 289,                   /* MODEQ  */
+    OR = 290,                      /* OR  */
+    AND = 291,                     /* AND  */
+    EQ = 292,                      /* EQ  */
+    NE = 293,                      /* NE  */
+    GT = 294,                      /* GT  */
+    GE = 295,                      /* GE  */
+    LT = 296,                      /* LT  */
+    LE = 297,                      /* LE  */
+    UNARYSIGN = 298,               /* UNARYSIGN  */
+    NOT = 299,                     /* NOT  */
+    INC = 300,                     /* INC  */
+    DEC = 301                      /* DEC  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
+#endif
+/* Token kinds.  */
+#define YYEMPTY -2
+#define YYEOF 0
+#define YYerror 256
+#define YYUNDEF 257
+#define STRING 258
+#define NUMBER 259
+#define PREVIOUS 260
+#define VAR 261
+#define BLTIN 262
+#define UNDEF 263
+#define PRINT 264
+#define PRINTF 265
+#define READ 266
+#define GETLINE 267
+#define WHILE 268
+#define DO 269
+#define IF 270
+#define ELSE 271
+#define FOR 272
+#define IN 273
+#define BREAK 274
+#define CONTINUE 275
+#define PARALLEL 276
+#define FUNC 277
+#define PROC 278
+#define FUNCTION 279
+#define PROCEDURE 280
+#define RETURN 281
+#define MEMO 282
+#define SPAWN 283
+#define LOWEST 284
+#define ADDEQ 285
+#define SUBEQ 286
+#define MULEQ 287
+#define DIVEQ 288
+#define MODEQ 289
+#define OR 290
+#define AND 291
+#define EQ 292
+#define NE 293
+#define GT 294
+#define GE 295
+#define LT 296
+#define LE 297
+#define UNARYSIGN 298
+#define NOT 299
+#define INC 300
+#define DEC 301
+
+/* Value type.  */
+#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
+union YYSTYPE
+{
+#line 64 "gramm.y"
+
+	String *str;
+	Name *name;
+	Inst *inst;
+	double val;
+	int narg;
+
+#line 167 "gramm.h"
+
+};
+typedef union YYSTYPE YYSTYPE;
+# define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
+#endif
+
+
+extern YYSTYPE yylval;
+
+
+int yyparse (void);
+
+
+#endif /* !YY_YY_GRAMM_H_INCLUDED  */
@@ -3,6 +3,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <setjmp.h>
+#include <string.h>
 #include "hoc.h"
 #include "code.h"
 #include "error.h"
@@ -10,9 +12,9 @@
 #define ipcode(i)  code((Inst){.type = IP, .u.ip = (i)})
 #define valcode(v) code((Inst){.type = VAL, .u.val = (v)})
 #define argcode(a) code((Inst){.type = NARG, .u.narg = (a)})
-#define strcode(s) code((Inst){.type = STR, .u.str = (s)})
 #define oprcode(o) code((Inst){.type = OPR, .u.opr = (o)})
 #define namecode(n) code((Inst){.type = NAME, .u.name = (n)})
+#define elemcode(n, op) oprcode(elemassign), namecode(n), argcode(op)
 #define fill1(x, a) \
 	N1((x))->type = IP, \
 	N1((x))->u.ip = (a)
@@ -31,13 +33,32 @@
 	N2((x))->u.ip = (b), \
 	N3((x))->u.ip = (c), \
 	N4((x))->u.ip = (d)
+#define fillin(x, v, a, b, c) \
+	N1((x))->type = N2((x))->type = NAME, \
+	N3((x))->type = N4((x))->type = IP, \
+	N1((x))->u.name = (v), \
+	N2((x))->u.name = (a), \
+	N3((x))->u.ip = (b), \
+	N4((x))->u.ip = (c)
+#define fillpar(x, v, le, b, e) \
+	N1((x))->type = NAME, \
+	N2((x))->type = NARG, \
+	N3((x))->type = N4((x))->type = IP, \
+	N1((x))->u.name = (v), \
+	N2((x))->u.narg = (le), \
+	N3((x))->u.ip = (b), \
+	N4((x))->u.ip = (e)
 
 int yylex(void);
 static void looponly(const char *);
+static void serialonly(const char *);
 static void defnonly(void);
+static int reduction(const char *);
 
 static int indef;
 static size_t inloop;
+static size_t parloop;          /* inloop in the body of the innermost parallel loop, or 0 */
+static Name *defparams;         /* parameters of the function being defined */
 %}
 
 %union {
@@ -52,35 +73,39 @@ static size_t inloop;
 %token <val>  NUMBER PREVIOUS
 %token <name> VAR BLTIN UNDEF
 %token <name> PRINT PRINTF READ GETLINE
-%token <name> WHILE DO IF ELSE FOR BREAK CONTINUE
-%token <name> FUNC PROC FUNCTION PROCEDURE RETURN
+%token <name> WHILE DO IF ELSE FOR IN BREAK CONTINUE PARALLEL
+%token <name> FUNC PROC FUNCTION PROCEDURE RETURN MEMO SPAWN
 %type  <name> params paramlist
 %type  <narg> args arglist
-%type  <inst> expr exprlist stmt stmtlist stmtnl asgn
+%type  <inst> expr exprlist stmt stmtlist stmtnl asgn index
 %type  <inst> and or do while if cond forcond forloop begin end
-%type  <name> procname
+%type  <inst> parhead
+%type  <narg> parfor parcmp
+%type  <name> procname parstep
+/* rules %prec LOWEST give way to any token with a precedence that may follow them */
+%nonassoc LOWEST
 %left  ','
 %right '=' ADDEQ SUBEQ MULEQ DIVEQ MODEQ
 %left  OR
 %left  AND
 %left  EQ NE
-%left  GT GE LT LE
+%left  GT GE LT LE IN
 %left  '+' '-'
 %left  '*' '/' '%'
-%right UNARYSIGN NOT INC DEC
+%right UNARYSIGN NOT INC DEC SPAWN
 %right '^'
 %right '$'
 
 %%
 
 list:
-	  /* nothing */         { indef = inloop = 0; }
+	  /* nothing */         { indef = inloop = parloop = 0; }
 	| list term
 	| list defn term        { oprcode(NULL); return 1; }
-	| list stmt term        { oprcode(NULL); return 1; }
+	| list stmt term        { oprcode(NULL); optcode(); return 1; }
 	| list asgn term        { oprcode(oprpop); oprcode(NULL); return 1; }
 	| list exprlist term    { oprcode(println); oprcode(NULL); return 1; }
-	| list error term       { yyerrok; }
+	| list error term       { yyerrok; parloop = 0; }
 	;
 
 asgn:
@@ -94,6 +119,16 @@ asgn:
 	| DEC VAR               { $$ = oprcode(predec); namecode($2); }
 	| VAR INC               { $$ = oprcode(postinc); namecode($1); }
 	| VAR DEC               { $$ = oprcode(postdec); namecode($1); }
+	| VAR '[' index ']' '=' expr     { $$ = $3; elemcode($1, ELEMSET); }
+	| VAR '[' index ']' ADDEQ expr   { $$ = $3; elemcode($1, ELEMADD); }
+	| VAR '[' index ']' SUBEQ expr   { $$ = $3; elemcode($1, ELEMSUB); }
+	| VAR '[' index ']' MULEQ expr   { $$ = $3; elemcode($1, ELEMMUL); }
+	| VAR '[' index ']' DIVEQ expr   { $$ = $3; elemcode($1, ELEMDIV); }
+	| VAR '[' index ']' MODEQ expr   { $$ = $3; elemcode($1, ELEMMOD); }
+	| INC VAR '[' index ']'          { $$ = $4; oprcode(constpush); valcode(1.0); elemcode($2, ELEMADD); }
+	| DEC VAR '[' index ']'          { $$ = $4; oprcode(constpush); valcode(1.0); elemcode($2, ELEMSUB); }
+	| VAR '[' index ']' INC          { $$ = $3; elemcode($1, ELEMINC); }
+	| VAR '[' index ']' DEC          { $$ = $3; elemcode($1, ELEMDEC); }
 	;
 
 /* used to break line after if, else, etc */
@@ -104,11 +139,11 @@ stmtnl:
 
 stmt:
 	  '{' stmtlist '}'                      { $$ = $2; }
-	| BREAK                                 { looponly($1->s); oprcode(breakcode); }
-	| CONTINUE                              { looponly($1->s); oprcode(continuecode); }
-	| RETURN                                { defnonly(); oprcode(procret); }
+	| BREAK                                 { looponly($1->s); serialonly($1->s); $$ = oprcode(breakcode); }
+	| CONTINUE                              { looponly($1->s); $$ = oprcode(continuecode); }
+	| RETURN %prec LOWEST                   { defnonly(); $$ = oprcode(procret); }
 	| RETURN expr                           { $$ = $2; defnonly(); oprcode(funcret); }
-	| PROCEDURE begin '(' arglist ')'       { $$ = $2; oprcode(call); namecode($1); argcode($4); }
+	| PROCEDURE begin '(' arglist ')'       { $$ = $2; callcode($1, $4); }
 	| PRINT begin arglist                   { $$ = $2; oprcode(_print); argcode($3); }
 	| PRINTF begin arglist                  { $$ = $2; oprcode(_printf); argcode($3); }
 	| exprlist                              { oprcode(oprpop); }
@@ -117,6 +152,16 @@ stmt:
 	| while cond stmtnl end                 { fill2($1, $3, $4); inloop--; }
 	| do stmtnl WHILE cond end              { fill2($1, $4, $5); inloop--; }
 	| forloop '(' forcond ';' forcond ';' forcond ')' stmtnl end { fill4($1, $5, $7, $9, $10); inloop--; }
+	| forloop '(' VAR IN VAR ')' stmtnl end { $1->u.opr = forincode; fillin($1, $3, $5, $7, $8); inloop--; }
+	| parfor '(' VAR '=' expr ';' VAR parcmp expr ';' parstep parhead parclauses ')' begin stmtnl end {
+		if ($7 != $3 || $11 != $3)
+			yyerror("parallel loop must compare and increment %s", $3->s);
+		fillpar($12, $3, $8, $15, $17);
+		verifypar($12, indef ? defparams : NULL);
+		$$ = $5;
+		parloop = $1;
+		inloop--;
+	  }
 	// | ';'           { $$ = oprcode(NULL); }         /* null statement */
 	;
 
@@ -124,14 +169,22 @@ exprlist:
 	  expr
 	| exprlist ',' expr
 
+/* the index of an array element, or the row and column of a matrix element; $-1 is the VAR */
+index:
+	  expr
+	| expr ',' expr                         { oprcode(matindex); namecode($<name>-1); }
+	;
+
 expr:
 	  NUMBER                                { $$ = oprcode(constpush); valcode($1); }
-	| STRING                                { $$ = oprcode(strpush); if (indef) movstr($1); strcode($1); }
+	| STRING                                { $$ = oprcode(strpush); strcode($1); }
 	| PREVIOUS                              { $$ = oprcode(prevpush); }
-	| VAR                                   { $$ = oprcode(eval); namecode($1); }
+	| VAR %prec LOWEST                      { $$ = oprcode(eval); namecode($1); }
+	| VAR '[' index ']' %prec LOWEST        { $$ = $3; oprcode(elempush); namecode($1); }
 	| READ VAR                              { oprcode(readnum); namecode($2); }
 	| GETLINE VAR                           { oprcode(readline); namecode($2); }
-	| FUNCTION begin '(' arglist ')'        { $$ = $2; oprcode(call); namecode($1); argcode($4); }
+	| FUNCTION begin '(' arglist ')'        { $$ = $2; callcode($1, $4); }
+	| SPAWN FUNCTION begin '(' arglist ')'  { $$ = $3; oprcode(spawncode); namecode($2); argcode($5); }
 	| '$' expr                              { $$ = $2; oprcode(cmdarg); }
 	| expr '+' expr                         { oprcode(add); }
 	| expr '-' expr                         { oprcode(sub); }
@@ -145,6 +198,7 @@ expr:
 	| expr LE expr                          { oprcode(le); }
 	| expr EQ expr                          { oprcode(eq); }
 	| expr NE expr                          { oprcode(ne); }
+	| expr IN VAR                           { oprcode(inmap); namecode($3); }
 	| NOT expr                              { $$ = $2; oprcode(not); }
 	| expr and expr end                     { fill2($2, $3, $4); }
 	| expr or expr end                      { fill2($2, $3, $4); }
@@ -160,6 +214,8 @@ defn:
 	  '(' paramlist ')' stmtnl      { oprcode(procret); define($2, $5); indef = 0; }
 	| PROC procname                 { indef = 1; verifydef($2, PROCEDURE); }
 	  '(' paramlist ')' stmtnl      { oprcode(procret); define($2, $5); indef = 0; }
+	| MEMO FUNC procname            { indef = 1; verifydef($3, FUNCTION); }
+	  '(' paramlist ')' stmtnl      { oprcode(procret); define($3, $6); indef = 0; memoize($3); }
 	;
 
 procname:
@@ -172,7 +228,7 @@ args:
 	;
 
 arglist:
-	  /* nothing */         { $$ = 0; }
+	  /* nothing */ %prec LOWEST    { $$ = 0; }
 	| args
 	;
 
@@ -186,8 +242,8 @@ params:
 	;
 
 paramlist:
-	  /* nothing */         { $$ = NULL; }
-	| params
+	  /* nothing */         { $$ = defparams = NULL; }
+	| params                { $$ = defparams = $1; }
 	;
 
 forcond:
@@ -215,6 +271,43 @@ forloop:
 	  FOR   { $$ = oprcode(forcode); oprcode(NULL); oprcode(NULL); oprcode(NULL); oprcode(NULL); inloop++; }
 	;
 
+/* a parallel loop; its value is the parloop of the enclosing one */
+parfor:
+	  PARALLEL FOR  { $$ = parloop; parloop = ++inloop; }
+	;
+
+/* whether a parallel loop runs up to its bound too */
+parcmp:
+	  LT    { $$ = 0; }
+	| LE    { $$ = 1; }
+	;
+
+parstep:
+	  VAR INC       { $$ = $1; }
+	| INC VAR       { $$ = $2; }
+	;
+
+/* parforcode comes after the code of the bounds, and before its clauses */
+parhead:
+	  /* nothing */ { $$ = oprcode(parforcode); oprcode(NULL); oprcode(NULL); oprcode(NULL); oprcode(NULL); }
+	;
+
+parclauses:
+	  /* nothing */
+	| ';' parclauselist
+	;
+
+parclauselist:
+	  parclause
+	| parclauselist ',' parclause
+	;
+
+/* an output array, or a reduction variable */
+parclause:
+	  VAR '[' ']'           { namecode($1); argcode(PAROUT); }
+	| BLTIN '(' VAR ')'     { namecode($3); argcode(reduction($1->s)); }
+	;
+
 stmtlist:
 	  /* nothing */ { $$ = getprogp(); }
 	| stmtlist term
@@ -252,10 +345,34 @@ looponly(const char *s)
 		yyerror("%s used outside loop", s);
 }
 
-/* error if using return out of function definition */
+/* error if using break in the body of a parallel loop, whose iterations all run */
+static void
+serialonly(const char *s)
+{
+	if (parloop && inloop == parloop)
+		yyerror("%s used in parallel loop", s);
+}
+
+/* error if using return out of function definition, or in a parallel loop */
 static void
 defnonly(void)
 {
 	if (!indef)
 		yyerror("return used outside definition");
+	if (parloop)
+		yyerror("return used in parallel loop");
+}
+
+/* get the reduction of a parallel loop named by bltin s */
+static int
+reduction(const char *s)
+{
+	if (strcmp(s, "sum") == 0)
+		return PARSUM;
+	if (strcmp(s, "min") == 0)
+		return PARMIN;
+	if (strcmp(s, "max") == 0)
+		return PARMAX;
+	yyerror("%s is no reduction", s);
+	return 0;
 }
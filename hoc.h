@@ -20,15 +20,37 @@ typedef struct String {
 /* datum content type */
 typedef union Value {
 	struct String *str;
+	struct Array *arr;
 	double val;
 } Value;
 
+/* array element, once the array holds a string */
+typedef struct Elem {
+	union Value u;
+	int isstr;
+} Elem;
+
+/* array entry type, listed and counted as strings are */
+typedef struct Array {
+	struct Array *prev, *next;
+	int orig;                       /* FINAL or AUTO */
+	size_t count;
+	size_t len, size;               /* elements used and allocated */
+	size_t cols;                    /* columns, if a matrix */
+	struct Map *map;                /* keys of the elements, if a map */
+	struct Sketch *sketch;          /* summary of a stream of numbers, if a sketch */
+	int shared;                     /* parallel loops and tasks reading it, so it must not change */
+	double *val;                    /* elements, while all are numbers */
+	struct Elem *elem;              /* elements, otherwise */
+} Array;
+
 /* symbol table entry */
 typedef struct Symbol {
 	struct Symbol *next;
 	union Value u;
 	char *name;
 	int isstr;
+	int isarr;
 } Symbol;
 
 /* interpreter stack type */
@@ -36,6 +58,7 @@ typedef struct Datum {
 	struct Datum *next;
 	union Value u;
 	int isstr;
+	int isarr;
 } Datum;
 
 /* machine instruction type */
@@ -57,6 +80,12 @@ typedef struct Function {
 	struct Inst *code;
 	struct Name *params;
 	int nparams;
+	int pure;                       /* uses only its parameters, does no I/O */
+	int memo;                       /* results are cached */
+	int inlen;                      /* instructions copied when inlined, or 0 */
+	size_t lineoff;                 /* where the lines of its code are in the line table, or SIZE_MAX */
+	int prevline;                   /* line they are encoded from */
+	struct Memo *cache;
 } Function;
 
 /* procedure/function call stack frame */
@@ -67,3 +96,10 @@ typedef struct Frame {
 	struct Name *name;
 	struct Inst *retpc;             /* where to resume after return */
 } Frame;
+
+/* top-level statement, for whole-program mode */
+typedef struct Stmt {
+	struct Stmt *next;
+	struct Inst *code;
+	int line;
+} Stmt;
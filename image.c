@@ -0,0 +1,769 @@
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <err.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "hoc.h"
+#include "code.h"
+#include "image.h"
+#include "gramm.h"
+
+/*
+ * A compiled program image is a serialization of the whole program
+ * memory (from the beginning of the program to prog.progp), of the
+ * names and strings its instructions refer to, and of the statement
+ * list.  Pointers are written as indices.  All integers but the magic
+ * and the version are written as unsigned LEB128 numbers, and floating
+ * point numbers are written as their IEEE-754 bits in little endian.
+ *
+ *      magic "HOCB", version (4 bytes, little endian)
+ *      flags the program was compiled with (FOPT for -O)
+ *      source size, source mtime, source hash (for the cache, else 0)
+ *      source file name, as length and bytes
+ *      nstrings, then each string as length and bytes
+ *      nnames, then each name as kind, length and bytes;
+ *          functions and procedures are followed by the index of the
+ *          instruction their code starts at, their flags (pure, memo)
+ *          and their parameters
+ *      ninsts, then each instruction as type and operand
+ *      length of the line table, then the line table (see code.c)
+ *      nstmts, then the index of the instruction each statement starts at
+ */
+
+#define MAGIC   "HOCB"
+#define VERSION 4
+
+/* flags the program was compiled with; the cache only takes images compiled with the current ones */
+#define FOPT    0x1             /* calls inlined and loops optimized (-O) */
+
+/* kinds of names */
+enum {NVAR, NBLTIN, NFUNC, NPROC};
+
+/* identity of a source file, for the cache */
+typedef struct Source {
+	uint64_t size;
+	uint64_t mtime;
+	uint64_t hash;
+} Source;
+
+/* hash table from pointers to indices */
+typedef struct Ptrtab {
+	struct {
+		const void *key;
+		size_t val;
+	} *v;
+	size_t size;
+	size_t n;
+} Ptrtab;
+
+/* read cursor over a mapped image */
+typedef struct Cursor {
+	const unsigned char *p;
+	const unsigned char *end;
+	const char *path;
+} Cursor;
+
+/* get the flags the program is compiled with */
+static uint64_t
+compflags(void)
+{
+	return getoptimize() ? FOPT : 0;
+}
+
+/* check return from calloc */
+static void *
+ecalloc(size_t n, size_t size)
+{
+	void *p;
+
+	if ((p = calloc(n, size)) == NULL)
+		err(1, "calloc");
+	return p;
+}
+
+static size_t
+ptrhash(const void *p)
+{
+	uint64_t h = (uintptr_t)p;
+
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	return h;
+}
+
+/* get slot of key in table */
+static size_t
+ptrslot(Ptrtab *tab, const void *key)
+{
+	size_t i;
+
+	for (i = ptrhash(key) & (tab->size - 1); tab->v[i].key; i = (i + 1) & (tab->size - 1))
+		if (tab->v[i].key == key)
+			break;
+	return i;
+}
+
+/* insert key into table, if not already there; return 1 if inserted */
+static int
+ptrput(Ptrtab *tab, const void *key, size_t val)
+{
+	Ptrtab new;
+	size_t i;
+
+	if (key == NULL)
+		return 0;
+	if ((tab->n + 1) * 2 > tab->size) {
+		new.size = tab->size ? tab->size * 2 : 64;
+		new.n = 0;
+		new.v = ecalloc(new.size, sizeof *new.v);
+		for (i = 0; i < tab->size; i++)
+			if (tab->v[i].key)
+				new.v[ptrslot(&new, tab->v[i].key)] = tab->v[i];
+		new.n = tab->n;
+		free(tab->v);
+		*tab = new;
+	}
+	i = ptrslot(tab, key);
+	if (tab->v[i].key)
+		return 0;
+	tab->v[i].key = key;
+	tab->v[i].val = val;
+	tab->n++;
+	return 1;
+}
+
+/* get pointer to the value of key in table, or NULL */
+static size_t *
+ptrget(Ptrtab *tab, const void *key)
+{
+	size_t i;
+
+	if (tab->size == 0 || key == NULL)
+		return NULL;
+	i = ptrslot(tab, key);
+	return tab->v[i].key ? &tab->v[i].val : NULL;
+}
+
+/* grow array v of n elements, if needed, so it fits one more element */
+static void *
+grow(void *v, size_t n, size_t size)
+{
+	/* the array doubles whenever n reaches a power of two */
+	if (n & (n - 1))
+		return v;
+	if ((v = realloc(v, (n ? n * 2 : 1) * size)) == NULL)
+		err(1, "realloc");
+	return v;
+}
+
+/* compute FNV-1a hash of n bytes */
+static uint64_t
+fnv1a(const void *p, size_t n, uint64_t h)
+{
+	const unsigned char *s = p;
+
+	while (n-- > 0) {
+		h ^= *s++;
+		h *= 0x100000001b3ULL;
+	}
+	return h;
+}
+
+static void
+wrnum(FILE *fp, uint64_t n)
+{
+	do {
+		putc((n & 0x7F) | (n > 0x7F ? 0x80 : 0), fp);
+		n >>= 7;
+	} while (n);
+}
+
+static void
+wr64(FILE *fp, uint64_t n)
+{
+	int i;
+
+	for (i = 0; i < 8; i++)
+		putc((n >> (i * 8)) & 0xFF, fp);
+}
+
+static void
+wrval(FILE *fp, double v)
+{
+	uint64_t n;
+
+	memcpy(&n, &v, sizeof n);
+	wr64(fp, n);
+}
+
+static void
+wrstr(FILE *fp, const char *s)
+{
+	size_t len;
+
+	len = strlen(s);
+	wrnum(fp, len);
+	fwrite(s, 1, len, fp);
+}
+
+static void
+corrupt(Cursor *cur)
+{
+	errx(1, "%s: corrupt program image", cur->path);
+}
+
+static uint64_t
+rdnum(Cursor *cur)
+{
+	uint64_t n = 0;
+	int shift;
+
+	for (shift = 0; shift < 64; shift += 7) {
+		if (cur->p >= cur->end)
+			corrupt(cur);
+		n |= (uint64_t)(*cur->p & 0x7F) << shift;
+		if (!(*cur->p++ & 0x80))
+			return n;
+	}
+	corrupt(cur);
+	return 0;
+}
+
+/* read number that must be less than max */
+static size_t
+rdindex(Cursor *cur, size_t max)
+{
+	uint64_t n;
+
+	if ((n = rdnum(cur)) >= max)
+		corrupt(cur);
+	return n;
+}
+
+static uint64_t
+rd64(Cursor *cur)
+{
+	uint64_t n = 0;
+	int i;
+
+	if (cur->end - cur->p < 8)
+		corrupt(cur);
+	for (i = 0; i < 8; i++)
+		n |= (uint64_t)*cur->p++ << (i * 8);
+	return n;
+}
+
+static double
+rdval(Cursor *cur)
+{
+	uint64_t n;
+	double v;
+
+	n = rd64(cur);
+	memcpy(&v, &n, sizeof v);
+	return v;
+}
+
+static char *
+rdstr(Cursor *cur)
+{
+	size_t len;
+	char *s;
+
+	len = rdindex(cur, cur->end - cur->p + 1);
+	if ((s = strndup((const char *)cur->p, len)) == NULL)
+		err(1, "strndup");
+	cur->p += len;
+	return s;
+}
+
+/* get kind of name, or -1 if it is not written to an image */
+static int
+namekind(Name *name)
+{
+	switch (name->type) {
+	case VAR:
+	case UNDEF:
+		return NVAR;
+	case BLTIN:
+		return NBLTIN;
+	case FUNCTION:
+		return NFUNC;
+	case PROCEDURE:
+		return NPROC;
+	}
+	return -1;
+}
+
+/* write image of the whole program into fp */
+static void
+writeimage(FILE *fp, const Source *src)
+{
+	Ptrtab targets = {NULL, 0, 0};
+	Ptrtab strings = {NULL, 0, 0};
+	Ptrtab names = {NULL, 0, 0};
+	String **strv = NULL;
+	Name **namev = NULL;
+	Inst *p, *end;
+	Name *name, *param;
+	Stmt *stmt;
+	const unsigned char *linetab;
+	size_t n, ninst, nstmt, linelen;
+	int kind;
+
+	/* find instructions that are pointed to, and number the strings */
+	end = getprogp();
+	for (ninst = 0, p = getproghead(); p != end; p = p->next, ninst++) {
+		if (p->type == IP) {
+			ptrput(&targets, p->u.ip, 0);
+		} else if (p->type == STR && ptrput(&strings, p->u.str, strings.n)) {
+			strv = grow(strv, strings.n - 1, sizeof *strv);
+			strv[strings.n - 1] = p->u.str;
+		}
+	}
+	for (nstmt = 0, stmt = getstmts(); stmt; stmt = stmt->next, nstmt++)
+		ptrput(&targets, stmt->code, 0);
+	for (name = getnametab(); name; name = name->next) {
+		if (name->type == FUNCTION || name->type == PROCEDURE)
+			ptrput(&targets, name->u.fun->code, 0);
+		if (namekind(name) != -1 && ptrput(&names, name, names.n)) {
+			namev = grow(namev, names.n - 1, sizeof *namev);
+			namev[names.n - 1] = name;
+		}
+	}
+	for (n = 0, p = getproghead(); ; p = p->next, n++) {
+		if (ptrget(&targets, p) != NULL)
+			*ptrget(&targets, p) = n;
+		if (p == end)
+			break;
+	}
+
+	/* header */
+	fwrite(MAGIC, 1, 4, fp);
+	putc(VERSION & 0xFF, fp);
+	putc((VERSION >> 8) & 0xFF, fp);
+	putc((VERSION >> 16) & 0xFF, fp);
+	putc((VERSION >> 24) & 0xFF, fp);
+	wrnum(fp, compflags());
+	wr64(fp, src ? src->size : 0);
+	wr64(fp, src ? src->mtime : 0);
+	wr64(fp, src ? src->hash : 0);
+	wrstr(fp, getfilename());
+
+	/* strings */
+	wrnum(fp, strings.n);
+	for (n = 0; n < strings.n; n++)
+		wrstr(fp, strv[n]->s);
+
+	/* names */
+	wrnum(fp, names.n);
+	for (n = 0; n < names.n; n++) {
+		name = namev[n];
+		kind = namekind(name);
+		putc(kind, fp);
+		wrstr(fp, name->s);
+		if (kind == NFUNC || kind == NPROC) {
+			wrnum(fp, *ptrget(&targets, name->u.fun->code));
+			wrnum(fp, name->u.fun->pure | name->u.fun->memo << 1);
+			wrnum(fp, name->u.fun->nparams);
+			for (param = name->u.fun->params; param; param = param->next)
+				wrstr(fp, param->s);
+		}
+	}
+
+	/* instructions */
+	wrnum(fp, ninst);
+	for (p = getproghead(); p != end; p = p->next) {
+		putc(p->type, fp);
+		switch (p->type) {
+		case VAL:
+			wrval(fp, p->u.val);
+			break;
+		case STR:
+			wrnum(fp, *ptrget(&strings, p->u.str));
+			break;
+		case NAME:
+			wrnum(fp, *ptrget(&names, p->u.name));
+			break;
+		case OPR:
+			if (p->u.opr && oprindex(p->u.opr) == -1)
+				errx(1, "%s: unknown operation", oprname(p->u.opr));
+			wrnum(fp, p->u.opr ? oprindex(p->u.opr) + 1 : 0);
+			break;
+		case IP:
+			wrnum(fp, p->u.ip ? *ptrget(&targets, p->u.ip) + 1 : 0);
+			break;
+		case NARG:
+			wrnum(fp, (unsigned)p->u.narg);
+			break;
+		}
+	}
+
+	/* lines */
+	linetab = getlinetab(&linelen);
+	wrnum(fp, linelen);
+	fwrite(linetab, 1, linelen, fp);
+
+	/* statements */
+	wrnum(fp, nstmt);
+	for (stmt = getstmts(); stmt; stmt = stmt->next)
+		wrnum(fp, *ptrget(&targets, stmt->code));
+
+	free(targets.v);
+	free(strings.v);
+	free(names.v);
+	free(strv);
+	free(namev);
+}
+
+/* read parameter list from cur */
+static Name *
+rdparams(Cursor *cur)
+{
+	Name *params;
+	char **v;
+	size_t n, i;
+
+	/* parameters are written in the order they are listed */
+	n = rdindex(cur, cur->end - cur->p + 1);
+	v = ecalloc(n, sizeof *v);
+	for (i = 0; i < n; i++)
+		v[i] = rdstr(cur);
+	params = NULL;
+	while (n-- > 0) {
+		params = installlocalname(v[n], params);
+		free(v[n]);
+	}
+	free(v);
+	return params;
+}
+
+/* read image from cur into the machine */
+static void
+readimage(Cursor *cur)
+{
+	String **strings;
+	Name **names, **params, *name;
+	Inst inst, **insts;
+	size_t *funcode, *funflags;
+	int *linev;
+	size_t nstrings, nnames, ninsts, nstmts, i, j, n;
+	void (*opr)(void);
+	char *s;
+	int kind;
+
+	/* header; the flags and the source fields are checked by the cache */
+	if (cur->end - cur->p < 8 || memcmp(cur->p, MAGIC, 4) != 0)
+		corrupt(cur);
+	if ((cur->p[4] | cur->p[5] << 8 | cur->p[6] << 16 | (unsigned)cur->p[7] << 24) != VERSION)
+		errx(1, "%s: unsupported program image version", cur->path);
+	cur->p += 8;
+	(void)rdnum(cur);
+	(void)rd64(cur);
+	(void)rd64(cur);
+	(void)rd64(cur);
+	setfilename(rdstr(cur));
+
+	/* strings */
+	nstrings = rdindex(cur, cur->end - cur->p + 1);
+	strings = ecalloc(nstrings, sizeof *strings);
+	for (i = 0; i < nstrings; i++)
+		strings[i] = addstr(rdstr(cur), 1);
+
+	/* names; functions are defined once their code is read */
+	nnames = rdindex(cur, cur->end - cur->p + 1);
+	names = ecalloc(nnames, sizeof *names);
+	params = ecalloc(nnames, sizeof *params);
+	funcode = ecalloc(nnames, sizeof *funcode);
+	funflags = ecalloc(nnames, sizeof *funflags);
+	for (i = 0; i < nnames; i++) {
+		if (cur->p >= cur->end)
+			corrupt(cur);
+		kind = *cur->p++;
+		s = rdstr(cur);
+		if ((name = lookupname(s)) == NULL)
+			name = installglobalname(s, UNDEF);
+		free(s);
+		names[i] = name;
+		switch (kind) {
+		case NVAR:
+			if (namekind(name) != NVAR)
+				errx(1, "%s: %s: name already used", cur->path, name->s);
+			break;
+		case NBLTIN:
+			if (name->type != BLTIN)
+				errx(1, "%s: %s: unknown built-in function", cur->path, name->s);
+			break;
+		case NFUNC:
+		case NPROC:
+			if (name->type != UNDEF)
+				errx(1, "%s: %s: name already used", cur->path, name->s);
+			name->type = (kind == NFUNC) ? FUNCTION : PROCEDURE;
+			funcode[i] = rdnum(cur);
+			funflags[i] = rdnum(cur);
+			params[i] = rdparams(cur);
+			break;
+		default:
+			corrupt(cur);
+		}
+	}
+
+	/* instructions; pointers are resolved after all are read */
+	ninsts = rdindex(cur, cur->end - cur->p + 1);
+	insts = ecalloc(ninsts + 1, sizeof *insts);
+	for (i = 0; i < ninsts; i++) {
+		if (cur->p >= cur->end)
+			corrupt(cur);
+		inst.type = *cur->p++;
+		switch (inst.type) {
+		case VAL:
+			inst.u.val = rdval(cur);
+			break;
+		case STR:
+			inst.u.str = strings[rdindex(cur, nstrings)];
+			break;
+		case NAME:
+			inst.u.name = names[rdindex(cur, nnames)];
+			break;
+		case OPR:
+			if ((j = rdnum(cur)) == 0)
+				inst.u.opr = NULL;
+			else if ((opr = oprfunc(j - 1)) == NULL)
+				corrupt(cur);
+			else
+				inst.u.opr = opr;
+			break;
+		case IP:
+			inst.u.ip = (Inst *)(uintptr_t)rdindex(cur, ninsts + 2);
+			break;
+		case NARG:
+			inst.u.narg = (int)rdnum(cur);
+			break;
+		default:
+			corrupt(cur);
+		}
+		insts[i] = code(inst);
+	}
+	insts[ninsts] = getprogp();
+	for (i = 0; i < ninsts; i++)
+		if (insts[i]->type == IP && insts[i]->u.ip)
+			insts[i]->u.ip = insts[(uintptr_t)insts[i]->u.ip - 1];
+
+	/* lines */
+	n = rdindex(cur, cur->end - cur->p + 1);
+	if (setlinetab(cur->p, n, ninsts) == -1)
+		corrupt(cur);
+	cur->p += n;
+	keepcode();
+
+	/* define functions and procedures */
+	for (i = 0; i < nnames; i++) {
+		if (names[i]->type != FUNCTION && names[i]->type != PROCEDURE)
+			continue;
+		if (funcode[i] >= ninsts)
+			corrupt(cur);
+		defineat(names[i], params[i], insts[funcode[i]]);
+		names[i]->u.fun->pure = funflags[i] & 1;
+		names[i]->u.fun->memo = (funflags[i] >> 1) & 1;
+	}
+
+	/* statements */
+	linev = getlines();
+	nstmts = rdindex(cur, cur->end - cur->p + 1);
+	for (i = 0; i < nstmts; i++) {
+		j = rdindex(cur, ninsts);
+		appendstmt(insts[j], linev[j]);
+	}
+	free(linev);
+	if (cur->p != cur->end)
+		corrupt(cur);
+
+	free(strings);
+	free(names);
+	free(params);
+	free(funcode);
+	free(funflags);
+	free(insts);
+}
+
+/* check whether fp is a program image; fp is rewound */
+int
+isimage(FILE *fp)
+{
+	char buf[4];
+	int ret;
+
+	ret = fread(buf, 1, sizeof buf, fp) == sizeof buf && memcmp(buf, MAGIC, 4) == 0;
+	rewind(fp);
+	return ret;
+}
+
+/* write image of the whole program into path */
+void
+saveimage(const char *path)
+{
+	FILE *fp;
+
+	if ((fp = fopen(path, "w")) == NULL)
+		err(1, "%s", path);
+	writeimage(fp, NULL);
+	if (fclose(fp) == EOF)
+		err(1, "%s", path);
+}
+
+/* load program image from fp into the machine */
+void
+loadimage(FILE *fp, const char *path)
+{
+	struct stat st;
+	Cursor cur;
+	void *p;
+
+	if (fstat(fileno(fp), &st) == -1)
+		err(1, "%s", path);
+	if (st.st_size == 0)
+		errx(1, "%s: corrupt program image", path);
+	if ((p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno(fp), 0)) == MAP_FAILED)
+		err(1, "%s", path);
+	cur.p = p;
+	cur.end = cur.p + st.st_size;
+	cur.path = path;
+	readimage(&cur);
+	(void)munmap(p, st.st_size);
+}
+
+/* get identity of source file; its contents are hashed only if hash != 0 */
+static int
+getsource(FILE *fp, Source *src, int hash)
+{
+	struct stat st;
+	void *p;
+
+	if (fstat(fileno(fp), &st) == -1 || !S_ISREG(st.st_mode))
+		return 0;
+	src->size = st.st_size;
+	src->mtime = st.st_mtime;
+	src->hash = 0;
+	if (!hash || st.st_size == 0)
+		return 1;
+	if ((p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno(fp), 0)) == MAP_FAILED)
+		return 0;
+	src->hash = fnv1a(p, st.st_size, 0xcbf29ce484222325ULL);
+	(void)munmap(p, st.st_size);
+	return 1;
+}
+
+/* get path of the cache file, in dir, of the source file at path compiled with the current flags */
+static char *
+cachepath(const char *dir, const char *path)
+{
+	char buf[PATH_MAX];
+	unsigned char flags;
+	char *s;
+	uint64_t h;
+
+	if (realpath(path, buf) == NULL)
+		return NULL;
+	flags = compflags();
+	h = fnv1a(buf, strlen(buf), 0xcbf29ce484222325ULL);
+	h = fnv1a(&flags, 1, h);
+	if ((s = malloc(strlen(dir) + 24)) == NULL)
+		return NULL;
+	(void)sprintf(s, "%s/%016llx.hocb", dir, (unsigned long long)h);
+	return s;
+}
+
+/* load program compiled from source fp from the cache in dir; return 0 if stale */
+int
+loadcache(const char *dir, const char *path, FILE *fp)
+{
+	struct stat st;
+	Source src;
+	Cursor cur;
+	char *cpath;
+	void *p;
+	int fd, ret = 0;
+
+	if (!getsource(fp, &src, 0) || (cpath = cachepath(dir, path)) == NULL)
+		return 0;
+	if ((fd = open(cpath, O_RDONLY)) == -1)
+		goto done;
+	if (fstat(fd, &st) == -1 || st.st_size < 32) {
+		close(fd);
+		goto done;
+	}
+	p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED)
+		goto done;
+	cur.p = p;
+	cur.end = cur.p + st.st_size;
+	cur.path = cpath;
+
+	/* the same flags, and a source of the same size, and either mtime or contents */
+	if (memcmp(cur.p, MAGIC, 4) != 0 || cur.p[4] != VERSION || cur.p[5] || cur.p[6] || cur.p[7])
+		goto unmap;
+	cur.p += 8;
+	if (rdnum(&cur) != compflags())
+		goto unmap;
+	if (rd64(&cur) != src.size)
+		goto unmap;
+	if (rd64(&cur) != src.mtime) {
+		(void)getsource(fp, &src, 1);
+		if (rd64(&cur) != src.hash)
+			goto unmap;
+	}
+	cur.p = p;
+	readimage(&cur);
+	ret = 1;
+unmap:
+	(void)munmap(p, st.st_size);
+done:
+	free(cpath);
+	return ret;
+}
+
+/* save program compiled from source fp into the cache in dir */
+void
+savecache(const char *dir, const char *path, FILE *fp)
+{
+	Source src;
+	FILE *cfp;
+	char *cpath, *tmp;
+	int fd;
+
+	if (!getsource(fp, &src, 1) || (cpath = cachepath(dir, path)) == NULL)
+		return;
+	if (mkdir(dir, 0777) == -1 && errno != EEXIST) {
+		warn("%s", dir);
+		goto done;
+	}
+	if ((tmp = malloc(strlen(cpath) + 8)) == NULL)
+		goto done;
+	(void)sprintf(tmp, "%s.XXXXXX", cpath);
+	if ((fd = mkstemp(tmp)) == -1 || (cfp = fdopen(fd, "w")) == NULL) {
+		warn("%s", tmp);
+		if (fd != -1)
+			close(fd);
+		goto error;
+	}
+	writeimage(cfp, &src);
+	if (fclose(cfp) == EOF || rename(tmp, cpath) == -1) {
+		warn("%s", cpath);
+		goto error;
+	}
+	free(tmp);
+	goto done;
+error:
+	(void)unlink(tmp);
+	free(tmp);
+done:
+	free(cpath);
+}
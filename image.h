@@ -0,0 +1,5 @@
+int isimage(FILE *fp);
+void saveimage(const char *path);
+void loadimage(FILE *fp, const char *path);
+int loadcache(const char *dir, const char *path, FILE *fp);
+void savecache(const char *dir, const char *path, FILE *fp);
@@ -0,0 +1,119 @@
+#include <pthread.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include "hoc.h"
+#include "code.h"
+#include "error.h"
+#include "libhoc.h"
+
+/*
+ * The interface of libhoc.  Each function makes its interpreter the
+ * current one of the calling thread, which is the one code.c runs.
+ * The parser and the scanner, made by yacc(1) and lex(1) or by hand,
+ * keep their state in globals, so programs are compiled one at a time
+ * under a lock; they are run without it.
+ */
+
+int yyparse(void);
+void scanstring(const char *s);
+
+static pthread_mutex_t parselock = PTHREAD_MUTEX_INITIALIZER;
+
+/* make an interpreter, whose command-line arguments are the argc strings argv; return NULL if out of memory */
+Hoc *
+hocnew(int argc, char *argv[])
+{
+	Hoc *h;
+
+	if ((h = newhoc()) == NULL)
+		return NULL;
+	geterrors()->quiet = 1;
+	if (setjmp(geterrors()->begin)) {
+		cleanup();
+		return NULL;
+	}
+	init(argc, argv);
+	return h;
+}
+
+/* free interpreter h */
+void
+hocfree(Hoc *h)
+{
+	sethoc(h);
+	cleanup();
+}
+
+/*
+ * compile the program src, whole, and run it, as hoc -w does: after an
+ * error, the program goes on with the next statement.  Return -1 if
+ * there were errors, and 0 otherwise.
+ */
+int
+hocrun(Hoc *h, const char *src)
+{
+	volatile int parsing;
+	int n;
+
+	sethoc(h);
+	n = errorcount();
+	pthread_mutex_lock(&parselock);
+	parsing = 1;
+	scanstring(src);
+	setjmp(geterrors()->begin);
+	if (parsing) {
+		while (prepare(), yyparse())
+			addstmt();
+		parsing = 0;
+		pthread_mutex_unlock(&parselock);
+	}
+	prepare();
+	run();
+	prepare();
+	return (errorcount() > n) ? -1 : 0;
+}
+
+/* call function or procedure name with the nargs numbers args, and store into v the value of a function; return -1 on error */
+int
+hoccall(Hoc *h, const char *name, const double *args, int nargs, double *v)
+{
+	sethoc(h);
+	if (setjmp(geterrors()->begin))
+		return -1;
+	prepare();
+	callbyname(name, args, nargs, v);
+	return 0;
+}
+
+/* store into v the number in global variable name; return -1 if it does not hold a number */
+int
+hocgetnum(Hoc *h, const char *name, double *v)
+{
+	Symbol *sym;
+
+	sethoc(h);
+	if ((sym = lookupvar(name)) == NULL || sym->isstr || sym->isarr)
+		return -1;
+	*v = sym->u.val;
+	return 0;
+}
+
+/* get the string in global variable name, valid until the variable changes, or NULL if it does not hold a string */
+const char *
+hocgetstr(Hoc *h, const char *name)
+{
+	Symbol *sym;
+
+	sethoc(h);
+	if ((sym = lookupvar(name)) == NULL || !sym->isstr)
+		return NULL;
+	return sym->u.str->s;
+}
+
+/* get the message of the last error of h */
+const char *
+hocerror(Hoc *h)
+{
+	sethoc(h);
+	return geterrors()->msg;
+}
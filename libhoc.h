@@ -0,0 +1,16 @@
+/*
+ * hoc as a library.  Each interpreter made by hocnew() has its own
+ * program, variables and stacks, and an interpreter can be used by a
+ * single thread at a time, so different threads can run different
+ * interpreters at once.  Programs print to the standard output, but
+ * their errors are kept for hocerror() instead of being printed.
+ */
+typedef struct Hoc Hoc;
+
+Hoc *hocnew(int argc, char *argv[]);
+void hocfree(Hoc *h);
+int hocrun(Hoc *h, const char *src);
+int hoccall(Hoc *h, const char *name, const double *args, int nargs, double *v);
+int hocgetnum(Hoc *h, const char *name, double *v);
+const char *hocgetstr(Hoc *h, const char *name);
+const char *hocerror(Hoc *h);
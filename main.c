@@ -1,4 +1,8 @@
+#include <sys/time.h>
 #include <err.h>
+#include <errno.h>
+#include <getopt.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,9 +11,27 @@
 #include <unistd.h>
 #include "hoc.h"
 #include "code.h"
+#include "error.h"
+#include "image.h"
+#include "pool.h"
+#include "prof.h"
+#include "trace.h"
 
 extern FILE *yyin;
-jmp_buf begin;
+
+static volatile sig_atomic_t running;           /* the machine is executing */
+static volatile sig_atomic_t interrupted;       /* an interrupt is pending */
+
+/* long options */
+enum {
+	OPT_MAXINSTS = 256,
+	OPT_TIMEOUT,
+};
+static struct option longopts[] = {
+	{"max-instructions", required_argument, NULL, OPT_MAXINSTS},
+	{"timeout",          required_argument, NULL, OPT_TIMEOUT},
+	{NULL,               0,                 NULL, 0}
+};
 
 int yyparse(void);
 
@@ -17,7 +39,9 @@ int yyparse(void);
 static void
 usage(void)
 {
-	(void)fprintf(stderr, "usage: hoc [file]\n");
+	(void)fprintf(stderr, "usage: hoc [-Omnpsw] [-C cachedir] [-F stacks] [-j threads] [-t trace]\n"
+	                     "           [--max-instructions n] [--timeout secs] [file [arguments ...]]\n"
+	                     "       hoc -c [-o output] file\n");
 	exit(1);
 }
 
@@ -29,16 +53,117 @@ sigfpehand(int sig)
 	err(1, "floating point exception");
 }
 
+/* print statistics on SIGUSR1 */
+static void
+sigusr1hand(int sig)
+{
+	(void)sig;
+	requeststats();
+}
+
+/*
+ * interrupt the running program; it is stopped at the next safe point
+ * and hoc goes on with the next statement.  When hoc is not running a
+ * program, or a previous interrupt could not be served, quit.
+ */
+static void
+siginthand(int sig)
+{
+	if (running && !interrupted) {
+		interrupted = 1;
+		requestint();
+		return;
+	}
+	signal(sig, SIG_DFL);
+	raise(sig);
+}
+
+/* stop the program when its time is up */
+static void
+sigalrmhand(int sig)
+{
+	(void)sig;
+	requesttimeout();
+}
+
 /* hoc */
 int
 main(int argc, char *argv[])
 {
 	struct sigaction sa;
-	FILE *fp = NULL;
-	char ch;
+	FILE *volatile fp = NULL;
+	static volatile int parsed = 0;
+	char *volatile file = NULL;
+	char *volatile output = NULL;
+	char *volatile cachedir = NULL;
+	char *stacks = NULL;
+	char *tracefile = NULL;
+	struct itimerval it;
+	unsigned long long maxinsts = 0;
+	double timeout = 0.0;
+	long nthreads = 0;
+	char *ep;
+	int Oflag = 0;
+	volatile int cflag = 0;
+	int mflag = 0;
+	volatile int nflag = 0;
+	int pflag = 0;
+	volatile int sflag = 0;
+	volatile int wflag = 0;
+	volatile int status = 0;
+	int ch;
 
-	while ((ch = getopt(argc, argv, "")) != -1) {
+	while ((ch = getopt_long(argc, argv, "C:F:Ocj:mno:pst:w", longopts, NULL)) != -1) {
 		switch (ch) {
+		case 'C':
+			cachedir = optarg;
+			break;
+		case 'F':
+			stacks = optarg;
+			break;
+		case 'O':
+			Oflag = 1;
+			break;
+		case 'c':
+			cflag = 1;
+			break;
+		case 'j':
+			nthreads = strtol(optarg, &ep, 10);
+			if (ep == optarg || *ep || nthreads < 1 || nthreads > 1024)
+				errx(1, "%s: invalid number of threads", optarg);
+			break;
+		case 'm':
+			mflag = 1;
+			break;
+		case 'o':
+			output = optarg;
+			break;
+		case 'n':
+			nflag = 1;
+			break;
+		case 'p':
+			pflag = 1;
+			break;
+		case 's':
+			sflag = 1;
+			break;
+		case 't':
+			tracefile = optarg;
+			break;
+		case 'w':
+			wflag = 1;
+			break;
+		case OPT_MAXINSTS:
+			errno = 0;
+			maxinsts = strtoull(optarg, &ep, 10);
+			if (errno || ep == optarg || *ep || maxinsts == 0 || *optarg == '-')
+				errx(1, "%s: invalid number of instructions", optarg);
+			break;
+		case OPT_TIMEOUT:
+			timeout = strtod(optarg, &ep);
+			if (ep == optarg || *ep || !(timeout > 0.0) || timeout > 1e8)
+				errx(1, "%s: invalid timeout", optarg);
+			break;
 		default:
 			usage();
 			break;
@@ -46,6 +171,16 @@ main(int argc, char *argv[])
 	}
 	argc -= optind;
 	argv += optind;
+	if (cflag) {
+		if (argc == 0 || strcmp(*argv, "-") == 0)
+			usage();
+		if (output == NULL) {
+			if ((output = malloc(strlen(*argv) + 2)) == NULL)
+				err(1, "malloc");
+			(void)sprintf(output, "%sb", *argv);
+		}
+		nflag = wflag = 1;
+	}
 
 	/* assign action for SIGFPE */
 	sa.sa_handler = sigfpehand;
@@ -54,30 +189,118 @@ main(int argc, char *argv[])
 	if (sigaction(SIGFPE, &sa, NULL) == -1)
 		err(1, "sigaction");
 
+	/* assign action for SIGUSR1 */
+	sa.sa_handler = sigusr1hand;
+	sa.sa_flags = SA_RESTART;
+	if (sigaction(SIGUSR1, &sa, NULL) == -1)
+		err(1, "sigaction");
+
+	/* assign action for SIGINT */
+	sa.sa_handler = siginthand;
+	if (sigaction(SIGINT, &sa, NULL) == -1)
+		err(1, "sigaction");
+
 	/* open input file */
 	if (argc) {
-		if (strcmp(*argv, "-") != 0)
-			if ((fp = fopen(*argv, "r")) == NULL)
-				err(1, "%s", *argv);
+		file = *argv;
+		if (strcmp(file, "-") != 0)
+			if ((fp = fopen(file, "r")) == NULL)
+				err(1, "%s", file);
 		if (fp)
 			yyin = fp;
 	}
 
 	/* initialize machine */
+	if (newhoc() == NULL)
+		err(1, "malloc");
 	init(argc, argv);
+	if (pflag)
+		profinit();
+	if (stacks)
+		sampleinit(stacks);
+	if (tracefile)
+		traceinit(tracefile);
+	if (sflag)
+		countinsts();
+	if (Oflag)
+		optimize();
+	if (mflag)
+		memoizeall();
+	if (maxinsts)
+		setmaxinsts(maxinsts);
+	if (nthreads)
+		poolsetsize(nthreads - 1);
+	if (timeout > 0.0) {
+		sa.sa_handler = sigalrmhand;
+		if (sigaction(SIGALRM, &sa, NULL) == -1)
+			err(1, "sigaction");
+		it.it_interval.tv_sec = it.it_interval.tv_usec = 0;
+		it.it_value.tv_sec = (time_t)timeout;
+		it.it_value.tv_usec = (suseconds_t)((timeout - floor(timeout)) * 1e6);
+		if (it.it_value.tv_sec == 0 && it.it_value.tv_usec == 0)
+			it.it_value.tv_usec = 1;
+		if (setitimer(ITIMER_REAL, &it, NULL) == -1)
+			err(1, "setitimer");
+	}
 
-	/* parse and execute input until EOF */
-	setjmp(begin);
-	while (prepare(), yyparse()) {
-		if (DEBUG)
-			debug();
-		execute(NULL);
+	/* load compiled program, given as input or from the cache */
+	if (fp && isimage(fp)) {
+		if (cflag)
+			errx(1, "%s: already compiled", file);
+		loadimage(fp, file);
+		parsed = wflag = 1;
+	} else if (fp && cachedir && !cflag) {
+		parsed = loadcache(cachedir, file, fp);
+		wflag = 1;
 	}
 
-	/* cleanup machine and close input file */
+	/* parse and execute input until EOF, or until a limit is exceeded */
+	setjmp(geterrors()->begin);
+	running = interrupted = 0;
+	if (limitexceeded()) {
+		status = 1;
+	} else if (wflag) {
+		/* parse the whole input first, then run it */
+		if (!parsed) {
+			while (prepare(), yyparse())
+				addstmt();
+			parsed = 1;
+			if (cflag && errorcount() > 0)
+				errx(1, "%s: not compiled", file);
+			else if (cflag)
+				saveimage(output);
+			else if (fp && cachedir && errorcount() == 0)
+				savecache(cachedir, file, fp);
+		}
+		if (!nflag) {
+			prepare();
+			running = 1;
+			run();
+			running = 0;
+		}
+	} else {
+		while (prepare(), yyparse()) {
+			if (DEBUG)
+				debug();
+			if (!nflag) {
+				running = 1;
+				execute(NULL);
+				running = 0;
+			}
+		}
+	}
+
+	/* report statistics, profile and trace, cleanup machine and close input file */
+	if (sflag) {
+		fflush(stdout);
+		printstats(stderr);
+	}
+	profreport();
+	samplereport();
+	traceexit();
 	cleanup();
 	if (fp)
 		fclose(fp);
 
-	return 0;
+	return status;
 }
@@ -0,0 +1,194 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hoc.h"
+#include "map.h"
+
+/*
+ * Hash tables of the keys of maps.  Keys are kept in an array, in the
+ * order they were added, so the values of a map are the elements of
+ * an ordinary array numbered as its keys are.  The table itself is an
+ * array of slots, each the hash of a key and its number, probed
+ * linearly and at most half full; since the hash is kept in the slot,
+ * most probes never look at the keys, and growing the table never
+ * hashes them again.  Numbers and short strings are held in the keys
+ * themselves; only long strings are held by reference, so adding an
+ * entry allocates nothing but when an array has to double.
+ */
+
+#define MINSLOTS   16
+#define MAXKEYS    (UINT32_MAX - 1)
+
+/* mix the bits of x, so any of them changes about half the bits of the hash */
+static uint32_t
+mix(uint64_t x)
+{
+	x ^= x >> 33;
+	x *= 0xFF51AFD7ED558CCDULL;
+	x ^= x >> 33;
+	x *= 0xC4CEB9FE1A85EC53ULL;
+	x ^= x >> 33;
+	return (uint32_t)x;
+}
+
+/* hash string s (FNV-1a) */
+static uint32_t
+hashstr(const char *s)
+{
+	uint64_t h;
+
+	for (h = 0xCBF29CE484222325ULL; *s; s++)
+		h = (h ^ (unsigned char)*s) * 0x100000001B3ULL;
+	return mix(h);
+}
+
+/* hash key k */
+static uint32_t
+hash(const Key *k)
+{
+	uint64_t x;
+
+	switch (k->type) {
+	case KEYNUM:
+		memcpy(&x, &k->u.num, sizeof x);
+		return mix(x);
+	case KEYSHORT:
+		return hashstr(k->u.s);
+	default:
+		return hashstr(k->u.str->s);
+	}
+}
+
+/* get the string of key k */
+static const char *
+keystr(const Key *k)
+{
+	return (k->type == KEYSHORT) ? k->u.s : k->u.str->s;
+}
+
+/* tell whether keys a and b are equal; a string key is never equal to a number */
+static int
+keyeq(const Key *a, const Key *b)
+{
+	if (a->type != b->type)
+		return 0;
+	if (a->type == KEYNUM)
+		return memcmp(&a->u.num, &b->u.num, sizeof a->u.num) == 0;
+	return strcmp(keystr(a), keystr(b)) == 0;
+}
+
+/* make k the key of number v; -0 is the same key as 0 */
+void
+numkey(Key *k, double v)
+{
+	k->type = KEYNUM;
+	k->u.num = (v == 0.0) ? 0.0 : v;
+}
+
+/* make k the key of string s, which it refers to if it is long */
+void
+strkey(Key *k, String *s)
+{
+	size_t n;
+
+	if ((n = strlen(s->s)) < KEYINLINE) {
+		k->type = KEYSHORT;
+		memcpy(k->u.s, s->s, n + 1);
+	} else {
+		k->type = KEYSTR;
+		k->u.str = s;
+	}
+}
+
+/* allocate an empty map, or return NULL */
+Map *
+mapnew(void)
+{
+	Map *m;
+
+	if ((m = malloc(sizeof *m)) == NULL)
+		return NULL;
+	m->keys = NULL;
+	m->len = m->size = 0;
+	m->slots = NULL;
+	m->mask = 0;
+	return m;
+}
+
+/* free map m; the strings its keys refer to are the caller's to release */
+void
+mapfree(Map *m)
+{
+	free(m->keys);
+	free(m->slots);
+	free(m);
+}
+
+/* double the slots of m, or allocate the first ones; return -1 if out of memory */
+static int
+rehash(Map *m)
+{
+	uint32_t *slots;
+	size_t n, i, j, mask;
+
+	n = m->slots ? 2 * (m->mask + 1) : MINSLOTS;
+	if (n > SIZE_MAX / (2 * sizeof *slots) || (slots = calloc(n, 2 * sizeof *slots)) == NULL)
+		return -1;
+	mask = n - 1;
+	if (m->slots) {
+		for (i = 0; i <= m->mask; i++) {
+			if (m->slots[2 * i + 1] == 0)
+				continue;
+			for (j = m->slots[2 * i] & mask; slots[2 * j + 1]; j = (j + 1) & mask)
+				;
+			slots[2 * j] = m->slots[2 * i];
+			slots[2 * j + 1] = m->slots[2 * i + 1];
+		}
+		free(m->slots);
+	}
+	m->slots = slots;
+	m->mask = mask;
+	return 0;
+}
+
+/*
+ * find key k in map m and return its number; if it is not there, add
+ * it after the last key if add != 0, or else return MAPNONE.  MAPNONE
+ * is also returned if there is no memory to add it.
+ */
+size_t
+mapfind(Map *m, const Key *k, int add)
+{
+	uint32_t h, i;
+	size_t j, size;
+	void *p;
+
+	h = hash(k);
+	j = 0;
+	if (m->slots) {
+		for (j = h & m->mask; (i = m->slots[2 * j + 1]) != 0; j = (j + 1) & m->mask)
+			if (m->slots[2 * j] == h && keyeq(&m->keys[i - 1], k))
+				return i - 1;
+	}
+	if (!add || m->len == MAXKEYS)
+		return MAPNONE;
+
+	/* add it, keeping the slots at most half full */
+	if (m->len == m->size) {
+		size = m->size ? 2 * m->size : MINSLOTS / 2;
+		if (size > SIZE_MAX / sizeof *m->keys || (p = realloc(m->keys, size * sizeof *m->keys)) == NULL)
+			return MAPNONE;
+		m->keys = p;
+		m->size = size;
+	}
+	if (m->slots == NULL || 2 * (m->len + 1) > m->mask + 1) {
+		if (rehash(m) == -1)
+			return MAPNONE;
+		for (j = h & m->mask; m->slots[2 * j + 1]; j = (j + 1) & m->mask)
+			;
+	}
+	m->slots[2 * j] = h;
+	m->slots[2 * j + 1] = (uint32_t)(m->len + 1);
+	m->keys[m->len] = *k;
+	return m->len++;
+}
@@ -0,0 +1,26 @@
+#define KEYINLINE  16           /* bytes of a string key kept in the key itself */
+#define MAPNONE    ((size_t)-1)
+
+/* key of a map entry */
+typedef struct Key {
+	enum {KEYNUM, KEYSHORT, KEYSTR} type;
+	union {
+		double num;
+		char s[KEYINLINE];      /* a string of less than KEYINLINE bytes */
+		struct String *str;     /* a longer string, which the map keeps a reference to */
+	} u;
+} Key;
+
+/* hash table of keys, numbered in the order they were added */
+typedef struct Map {
+	Key *keys;
+	size_t len, size;               /* keys used and allocated */
+	uint32_t *slots;                /* pairs of hash and key number + 1, or 0 if free */
+	size_t mask;                    /* number of slots - 1 */
+} Map;
+
+Map *mapnew(void);
+void mapfree(Map *m);
+void numkey(Key *k, double v);
+void strkey(Key *k, struct String *s);
+size_t mapfind(Map *m, const Key *k, int add);
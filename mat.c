@@ -0,0 +1,376 @@
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "mat.h"
+#include "vec.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define X86 1
+#include <immintrin.h>
+#else
+#define X86 0
+#endif
+
+/*
+ * Kernels for the matrix built-in functions; matrices are row-major.
+ * The product is computed on blocks of A and B packed into panels that
+ * stay in cache, MR x NR elements of C at a time, held in registers.
+ * Each element of C is still the sum of its products in order, so the
+ * result is that of the plain triple loop, whatever the processor.
+ * Products big enough are split into blocks of rows of C, each
+ * computed by its own thread.
+ */
+
+#define MR         4            /* rows of a tile of C */
+#define NR         8            /* columns of a tile of C */
+#define MC         64           /* rows of a packed block of A */
+#define KC         256          /* columns of A and rows of B of a packed block */
+#define NC         512          /* columns of a packed block of B */
+#define TB         32           /* side of the blocks of a transposition */
+#define MINROWS    32           /* rows of C given to a thread, at least */
+#define MINWORK    (1 << 20)    /* multiply-adds given to a thread, at least */
+#define MAXTHREADS 64
+
+/* the rows from r0 to r1 of a product, run by a thread */
+typedef struct Part {
+	void (*f)(struct Part *);
+	const double *a, *b;
+	double *c;
+	size_t n, k, m;
+	size_t r0, r1;
+	double *pa, *pb;        /* packed blocks of A and B */
+} Part;
+
+typedef void Tile(size_t kc, const double *pa, const double *pb, double *c, size_t ldc, size_t mr, size_t nr);
+
+static Tile *tile = NULL;
+
+/* compute the mr x nr tile of C at c, plus the product of the packed panels pa and pb */
+static void
+tile1(size_t kc, const double *pa, const double *pb, double *c, size_t ldc, size_t mr, size_t nr)
+{
+	double t[MR][NR];
+	size_t p, i, j;
+
+	for (i = 0; i < MR; i++)
+		for (j = 0; j < NR; j++)
+			t[i][j] = (i < mr && j < nr) ? c[i * ldc + j] : 0.0;
+	for (p = 0; p < kc; p++, pa += MR, pb += NR)
+		for (i = 0; i < MR; i++)
+			for (j = 0; j < NR; j++)
+				t[i][j] += pa[i] * pb[j];
+	for (i = 0; i < mr; i++)
+		for (j = 0; j < nr; j++)
+			c[i * ldc + j] = t[i][j];
+}
+
+#if X86
+
+/* the same, in eight AVX2 registers */
+__attribute__((target("avx2")))
+static void
+tile4(size_t kc, const double *pa, const double *pb, double *c, size_t ldc, size_t mr, size_t nr)
+{
+	__m256d c00, c01, c10, c11, c20, c21, c30, c31, a, b0, b1;
+	double t[MR][NR];
+	double *q;
+	size_t p, i, j, ld;
+
+	q = c;
+	ld = ldc;
+	if (mr < MR || nr < NR) {
+		for (i = 0; i < MR; i++)
+			for (j = 0; j < NR; j++)
+				t[i][j] = (i < mr && j < nr) ? c[i * ldc + j] : 0.0;
+		q = &t[0][0];
+		ld = NR;
+	}
+	c00 = _mm256_loadu_pd(q);
+	c01 = _mm256_loadu_pd(q + 4);
+	c10 = _mm256_loadu_pd(q + ld);
+	c11 = _mm256_loadu_pd(q + ld + 4);
+	c20 = _mm256_loadu_pd(q + 2 * ld);
+	c21 = _mm256_loadu_pd(q + 2 * ld + 4);
+	c30 = _mm256_loadu_pd(q + 3 * ld);
+	c31 = _mm256_loadu_pd(q + 3 * ld + 4);
+	for (p = 0; p < kc; p++, pa += MR, pb += NR) {
+		b0 = _mm256_loadu_pd(pb);
+		b1 = _mm256_loadu_pd(pb + 4);
+		a = _mm256_broadcast_sd(pa);
+		c00 = _mm256_add_pd(c00, _mm256_mul_pd(a, b0));
+		c01 = _mm256_add_pd(c01, _mm256_mul_pd(a, b1));
+		a = _mm256_broadcast_sd(pa + 1);
+		c10 = _mm256_add_pd(c10, _mm256_mul_pd(a, b0));
+		c11 = _mm256_add_pd(c11, _mm256_mul_pd(a, b1));
+		a = _mm256_broadcast_sd(pa + 2);
+		c20 = _mm256_add_pd(c20, _mm256_mul_pd(a, b0));
+		c21 = _mm256_add_pd(c21, _mm256_mul_pd(a, b1));
+		a = _mm256_broadcast_sd(pa + 3);
+		c30 = _mm256_add_pd(c30, _mm256_mul_pd(a, b0));
+		c31 = _mm256_add_pd(c31, _mm256_mul_pd(a, b1));
+	}
+	_mm256_storeu_pd(q, c00);
+	_mm256_storeu_pd(q + 4, c01);
+	_mm256_storeu_pd(q + ld, c10);
+	_mm256_storeu_pd(q + ld + 4, c11);
+	_mm256_storeu_pd(q + 2 * ld, c20);
+	_mm256_storeu_pd(q + 2 * ld + 4, c21);
+	_mm256_storeu_pd(q + 3 * ld, c30);
+	_mm256_storeu_pd(q + 3 * ld + 4, c31);
+	if (q != c)
+		for (i = 0; i < mr; i++)
+			for (j = 0; j < nr; j++)
+				c[i * ldc + j] = t[i][j];
+}
+
+#endif /* X86 */
+
+/* select the tile kernel for this processor; threads racing to select it select the same */
+static void
+gettile(void)
+{
+	Tile *t;
+
+	if (__atomic_load_n(&tile, __ATOMIC_ACQUIRE) != NULL)
+		return;
+	t = tile1;
+#if X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		t = tile4;
+#endif
+	__atomic_store_n(&tile, t, __ATOMIC_RELEASE);
+}
+
+/* pack the mc x kc block of A at a into panels of MR rows, padded with zeros */
+static void
+packa(const double *a, size_t lda, size_t mc, size_t kc, double *pa)
+{
+	size_t i, p, r;
+
+	for (i = 0; i < mc; i += MR)
+		for (p = 0; p < kc; p++)
+			for (r = 0; r < MR; r++)
+				*pa++ = (i + r < mc) ? a[(i + r) * lda + p] : 0.0;
+}
+
+/* pack the kc x nc block of B at b into panels of NR columns, padded with zeros */
+static void
+packb(const double *b, size_t ldb, size_t kc, size_t nc, double *pb)
+{
+	size_t j, p, r;
+
+	for (j = 0; j < nc; j += NR)
+		for (p = 0; p < kc; p++)
+			for (r = 0; r < NR; r++)
+				*pb++ = (j + r < nc) ? b[p * ldb + j + r] : 0.0;
+}
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+/* compute the rows from r0 to r1 of the product */
+static void
+gemm(Part *t)
+{
+	size_t i0, j0, p0, ir, jr, mc, nc, kc;
+	double *c;
+
+	memset(t->c + t->r0 * t->m, 0, (t->r1 - t->r0) * t->m * sizeof *t->c);
+	for (j0 = 0; j0 < t->m; j0 += NC) {
+		nc = MIN(NC, t->m - j0);
+		for (p0 = 0; p0 < t->k; p0 += KC) {
+			kc = MIN(KC, t->k - p0);
+			packb(t->b + p0 * t->m + j0, t->m, kc, nc, t->pb);
+			for (i0 = t->r0; i0 < t->r1; i0 += MC) {
+				mc = MIN(MC, t->r1 - i0);
+				packa(t->a + i0 * t->k + p0, t->k, mc, kc, t->pa);
+				for (jr = 0; jr < nc; jr += NR) {
+					for (ir = 0; ir < mc; ir += MR) {
+						c = t->c + (i0 + ir) * t->m + j0 + jr;
+						tile(kc, t->pa + ir * kc, t->pb + jr * kc, c, t->m,
+						     MIN(MR, mc - ir), MIN(NR, nc - jr));
+					}
+				}
+			}
+		}
+	}
+}
+
+/* compute the rows from r0 to r1 of the matrix-vector product */
+static void
+gemv(Part *t)
+{
+	size_t i;
+
+	for (i = t->r0; i < t->r1; i++)
+		t->c[i] = vecdot(t->a + i * t->k, t->b, t->k);
+}
+
+/* get the number of threads to split rows with work multiply-adds into */
+static size_t
+nthreads(size_t rows, double work)
+{
+	static long ncpus = 0;          /* shared by the threads of parallel loops */
+	long nc;
+	size_t n;
+
+	if ((nc = __atomic_load_n(&ncpus, __ATOMIC_RELAXED)) == 0) {
+		if ((nc = sysconf(_SC_NPROCESSORS_ONLN)) < 1)
+			nc = 1;
+		__atomic_store_n(&ncpus, nc, __ATOMIC_RELAXED);
+	}
+	n = MIN((size_t)nc, MAXTHREADS);
+	n = MIN(n, rows / MINROWS);
+	if (work / MINWORK < n)
+		n = (size_t)(work / MINWORK);
+	return n ? n : 1;
+}
+
+static void *
+runpart(void *p)
+{
+	Part *t;
+
+	t = p;
+	t->f(t);
+	return NULL;
+}
+
+/* run the n parts, each in a thread but the first, and wait for them */
+static void
+parallel(Part *parts, size_t n)
+{
+	pthread_t tid[MAXTHREADS];
+	int started[MAXTHREADS];
+	size_t i;
+
+	for (i = 1; i < n; i++)
+		if (!(started[i] = pthread_create(&tid[i], NULL, runpart, &parts[i]) == 0))
+			parts[i].f(&parts[i]);
+	parts[0].f(&parts[0]);
+	for (i = 1; i < n; i++)
+		if (started[i])
+			pthread_join(tid[i], NULL);
+}
+
+/* split the n rows of the operation f into parts */
+static size_t
+split(Part *parts, void (*f)(Part *), const double *a, const double *b, double *c,
+      size_t n, size_t k, size_t m)
+{
+	size_t i, nt;
+
+	nt = nthreads(n, (double)n * k * (m ? m : 1));
+	for (i = 0; i < nt; i++) {
+		parts[i].f = f;
+		parts[i].a = a;
+		parts[i].b = b;
+		parts[i].c = c;
+		parts[i].n = n;
+		parts[i].k = k;
+		parts[i].m = m;
+		parts[i].r0 = n * i / nt;
+		parts[i].r1 = n * (i + 1) / nt;
+		parts[i].pa = parts[i].pb = NULL;
+	}
+	return nt;
+}
+
+/* store the product of the n x k matrix a and the k x m matrix b into c; return ENOMEM if out of memory */
+int
+matmul(const double *a, const double *b, double *c, size_t n, size_t k, size_t m)
+{
+	Part parts[MAXTHREADS];
+	size_t i, nt, sa, sb;
+	double *buf;
+
+	gettile();
+	nt = split(parts, gemm, a, b, c, n, k, m);
+	sa = MC * MIN(KC, k);
+	sb = MIN(KC, k) * ((MIN(NC, m) + NR - 1) / NR * NR);
+	if ((buf = malloc(nt * (sa + sb) * sizeof *buf + 1)) == NULL)
+		return ENOMEM;
+	for (i = 0; i < nt; i++) {
+		parts[i].pa = buf + i * (sa + sb);
+		parts[i].pb = parts[i].pa + sa;
+	}
+	parallel(parts, nt);
+	free(buf);
+	return 0;
+}
+
+/* store the product of the n x m matrix a and the vector x into y */
+void
+matvec(const double *a, const double *x, double *y, size_t n, size_t m)
+{
+	Part parts[MAXTHREADS];
+
+	(void)veckernels();     /* select them before the threads do */
+	parallel(parts, split(parts, gemv, a, x, y, n, m, 0));
+}
+
+/* store the transpose of the n x m matrix a into t, a block at a time */
+void
+mattrans(const double *a, double *t, size_t n, size_t m)
+{
+	size_t i0, j0, i, j;
+
+	for (i0 = 0; i0 < n; i0 += TB)
+		for (j0 = 0; j0 < m; j0 += TB)
+			for (i = i0; i < i0 + TB && i < n; i++)
+				for (j = j0; j < j0 + TB && j < m; j++)
+					t[j * n + i] = a[i * m + j];
+}
+
+/* swap the n elements of x and y */
+static void
+swaprows(double *x, double *y, size_t n)
+{
+	double d;
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		d = x[i];
+		x[i] = y[i];
+		y[i] = d;
+	}
+}
+
+/*
+ * solve a x = b for the n x n matrix a and the n x m matrix b, by LU
+ * decomposition with partial pivoting; a is overwritten by its
+ * factors, and b by x.  Return EDOM if a is singular.
+ */
+int
+matsolve(double *a, double *b, size_t n, size_t m)
+{
+	size_t i, j, k, p;
+	double l;
+
+	for (k = 0; k < n; k++) {
+		for (p = i = k; i < n; i++)
+			if (fabs(a[i * n + k]) > fabs(a[p * n + k]))
+				p = i;
+		if (a[p * n + k] == 0.0)
+			return EDOM;
+		if (p != k) {
+			swaprows(a + k * n + k, a + p * n + k, n - k);
+			swaprows(b + k * m, b + p * m, m);
+		}
+		for (i = k + 1; i < n; i++) {
+			l = a[i * n + k] /= a[k * n + k];
+			vecaxpy(-l, a + k * n + k + 1, a + i * n + k + 1, n - k - 1);
+			vecaxpy(-l, b + k * m, b + i * m, m);
+		}
+	}
+	for (i = n; i-- > 0; ) {
+		for (j = i + 1; j < n; j++)
+			vecaxpy(-a[i * n + j], b + j * m, b + i * m, m);
+		for (j = 0; j < m; j++)
+			b[i * m + j] /= a[i * n + i];
+	}
+	return 0;
+}
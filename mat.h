@@ -0,0 +1,4 @@
+int matmul(const double *a, const double *b, double *c, size_t n, size_t k, size_t m);
+void matvec(const double *a, const double *x, double *y, size_t n, size_t m);
+void mattrans(const double *a, double *t, size_t n, size_t m);
+int matsolve(double *a, double *b, size_t n, size_t m);
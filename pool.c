@@ -0,0 +1,309 @@
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "pool.h"
+
+/*
+ * A pool of threads, started when the first job is submitted, that run
+ * jobs from a single queue in the order they were submitted.  A thread
+ * waiting for a job runs it itself if no thread of the pool has taken
+ * it yet, and runs other queued jobs while it waits, so jobs can wait
+ * for jobs they submit without running out of threads.  The threads
+ * block every signal, which are left to the threads running hoc.
+ *
+ * A loop is split by poolfor() into one range of iterations for each of
+ * its workers, each run by a job.  A worker takes its iterations GRAINS
+ * times fewer than its share at a time from the front of its range; once
+ * it runs out, it steals the back half of the range of another worker,
+ * so those that are done first help those that are slow.
+ */
+
+#define MAXTHREADS 256
+#define GRAINS     64           /* chunks of its share a worker takes, about */
+#define MIN(a, b)  ((a) < (b) ? (a) : (b))
+
+/* the iterations of a loop left to a worker, from next to end */
+typedef struct Range {
+	pthread_mutex_t lock;
+	size_t next, end;
+	char pad[64];                   /* keeps ranges on different cache lines */
+} Range;
+
+/* a loop being run by poolfor() */
+typedef struct Loop {
+	int (*f)(void *, size_t, size_t, size_t);
+	void *arg;
+	Range *ranges;
+	size_t nw;                      /* workers */
+	size_t grain;                   /* iterations taken at a time */
+	int stop;                       /* a worker failed, so the others stop */
+} Loop;
+
+/* a worker of a loop */
+typedef struct Worker {
+	Job job;
+	Loop *loop;
+	size_t w;
+} Worker;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queued = PTHREAD_COND_INITIALIZER;       /* a job was submitted */
+static pthread_cond_t done = PTHREAD_COND_INITIALIZER;         /* a job was done */
+static Job *head, *tail;                                        /* the queue */
+static long size = -1;                                          /* threads, or -1 until known */
+static long started;                                            /* threads running */
+
+/* use n threads besides those submitting jobs; the threads already started are kept */
+void
+poolsetsize(size_t n)
+{
+	pthread_mutex_lock(&lock);
+	size = MIN(n, MAXTHREADS);
+	pthread_mutex_unlock(&lock);
+}
+
+/* get the number of threads of the pool, one less than processors by default; called with lock held */
+static long
+getsize(void)
+{
+	long n;
+
+	if (size < 0) {
+		if ((n = sysconf(_SC_NPROCESSORS_ONLN)) < 1)
+			n = 1;
+		size = MIN(n - 1, MAXTHREADS);
+	}
+	return size;
+}
+
+/* get the number of threads of the pool */
+size_t
+poolsize(void)
+{
+	long n;
+
+	pthread_mutex_lock(&lock);
+	n = getsize();
+	pthread_mutex_unlock(&lock);
+	return n;
+}
+
+/* take the first job from the queue; called with lock held */
+static Job *
+dequeue(void)
+{
+	Job *j;
+
+	j = head;
+	if ((head = j->next) == NULL)
+		tail = NULL;
+	return j;
+}
+
+/* take job j from the queue; called with lock held */
+static void
+unqueue(Job *j)
+{
+	Job *p, *prev;
+
+	for (prev = NULL, p = head; p != j; prev = p, p = p->next)
+		;
+	if (prev)
+		prev->next = j->next;
+	else
+		head = j->next;
+	if (tail == j)
+		tail = prev;
+}
+
+/* run job j, which was taken from the queue; called with lock held */
+static void
+runjob(Job *j)
+{
+	j->state = JOBRUNNING;
+	pthread_mutex_unlock(&lock);
+	j->f(j->arg);
+	pthread_mutex_lock(&lock);
+	j->state = JOBDONE;
+	pthread_cond_broadcast(&done);
+}
+
+static void *
+runthread(void *p)
+{
+	(void)p;
+	pthread_mutex_lock(&lock);
+	for (;;) {
+		while (head == NULL)
+			pthread_cond_wait(&queued, &lock);
+		runjob(dequeue());
+	}
+	return NULL;
+}
+
+/* start the threads of the pool not started yet; called with lock held */
+static void
+start(void)
+{
+	pthread_attr_t attr;
+	pthread_t tid;
+	sigset_t all, old;
+
+	if (started >= getsize())
+		return;
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK, &all, &old);       /* the threads inherit it */
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	while (started < size && pthread_create(&tid, &attr, runthread, NULL) == 0)
+		started++;
+	pthread_attr_destroy(&attr);
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+	size = started;                 /* no more can be started */
+}
+
+/* queue job j, which calls f(arg); it is run by a thread of the pool, or by poolwait(j) */
+void
+poolsubmit(Job *j, void (*f)(void *), void *arg)
+{
+	j->f = f;
+	j->arg = arg;
+	j->next = NULL;
+	pthread_mutex_lock(&lock);
+	start();
+	j->state = JOBQUEUED;
+	if (tail)
+		tail->next = j;
+	else
+		head = j;
+	tail = j;
+	pthread_cond_signal(&queued);
+	pthread_mutex_unlock(&lock);
+}
+
+/* wait for job j to be done: run it if it was not taken yet, and run other jobs while it runs */
+void
+poolwait(Job *j)
+{
+	pthread_mutex_lock(&lock);
+	while (j->state != JOBDONE) {
+		if (j->state == JOBQUEUED) {
+			unqueue(j);
+			runjob(j);
+		} else if (head) {
+			runjob(dequeue());
+		} else {
+			pthread_cond_wait(&done, &lock);
+		}
+	}
+	pthread_mutex_unlock(&lock);
+}
+
+/* take the next iterations of worker w into i and j; return 0 if there are none left */
+static int
+take(Loop *l, size_t w, size_t *i, size_t *j)
+{
+	Range *r, *v;
+	size_t k, h, lo, hi;
+
+	r = &l->ranges[w];
+	for (;;) {
+		pthread_mutex_lock(&r->lock);
+		if (r->next < r->end) {
+			*i = r->next;
+			*j = r->next = MIN(r->next + l->grain, r->end);
+			pthread_mutex_unlock(&r->lock);
+			return 1;
+		}
+		pthread_mutex_unlock(&r->lock);
+
+		/* steal the back half of the range of the first worker that has some left */
+		for (lo = hi = k = 1; k < l->nw; k++) {
+			v = &l->ranges[(w + k) % l->nw];
+			pthread_mutex_lock(&v->lock);
+			if (v->next < v->end) {
+				h = (v->end - v->next + 1) / 2;
+				hi = v->end;
+				lo = v->end -= h;
+			}
+			pthread_mutex_unlock(&v->lock);
+			if (lo < hi)
+				break;
+		}
+		if (lo >= hi)
+			return 0;
+		pthread_mutex_lock(&r->lock);
+		r->next = lo;
+		r->end = hi;
+		pthread_mutex_unlock(&r->lock);
+	}
+}
+
+/* run the iterations of a worker, until there are none left or a worker failed */
+static void
+runworker(void *p)
+{
+	Worker *wk;
+	Loop *l;
+	size_t i, j;
+
+	wk = p;
+	l = wk->loop;
+	while (!__atomic_load_n(&l->stop, __ATOMIC_RELAXED) && take(l, wk->w, &i, &j))
+		if (l->f(l->arg, wk->w, i, j) != 0)
+			__atomic_store_n(&l->stop, 1, __ATOMIC_RELAXED);
+}
+
+/*
+ * run the iterations from 0 to n - 1 of a loop with nw workers, the first
+ * of them in the calling thread, by calls f(arg, w, i, j) of worker w for
+ * the iterations from i to j - 1.  When f returns nonzero, the workers
+ * stop after the iterations they are running.  Return ECANCELED if so,
+ * ENOMEM if out of memory, and 0 otherwise.
+ */
+int
+poolfor(size_t n, size_t nw, int (*f)(void *arg, size_t w, size_t i, size_t j), void *arg)
+{
+	Worker *wks;
+	Loop l;
+	size_t w;
+
+	if (n == 0)
+		return 0;
+	nw = MIN(nw, n);
+	if (nw == 0)
+		nw = 1;
+	l.f = f;
+	l.arg = arg;
+	l.nw = nw;
+	l.grain = n / (nw * GRAINS);
+	if (l.grain == 0)
+		l.grain = 1;
+	l.stop = 0;
+	l.ranges = malloc(nw * sizeof *l.ranges);
+	wks = malloc(nw * sizeof *wks);
+	if (l.ranges == NULL || wks == NULL) {
+		free(l.ranges);
+		free(wks);
+		return ENOMEM;
+	}
+	for (w = 0; w < nw; w++) {
+		pthread_mutex_init(&l.ranges[w].lock, NULL);
+		l.ranges[w].next = n / nw * w + MIN(w, n % nw);
+		l.ranges[w].end = l.ranges[w].next + n / nw + (w < n % nw);
+		wks[w].loop = &l;
+		wks[w].w = w;
+	}
+	for (w = 1; w < nw; w++)
+		poolsubmit(&wks[w].job, runworker, &wks[w]);
+	runworker(&wks[0]);
+	for (w = 1; w < nw; w++)
+		poolwait(&wks[w].job);
+	for (w = 0; w < nw; w++)
+		pthread_mutex_destroy(&l.ranges[w].lock);
+	free(l.ranges);
+	free(wks);
+	return l.stop ? ECANCELED : 0;
+}
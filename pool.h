@@ -0,0 +1,16 @@
+/* states of a job */
+enum {JOBQUEUED, JOBRUNNING, JOBDONE};
+
+/* a function run by a thread of the pool */
+typedef struct Job {
+	struct Job *next;
+	void (*f)(void *);
+	void *arg;
+	int state;
+} Job;
+
+void poolsetsize(size_t n);
+size_t poolsize(void);
+void poolsubmit(Job *j, void (*f)(void *), void *arg);
+void poolwait(Job *j);
+int poolfor(size_t n, size_t nw, int (*f)(void *arg, size_t w, size_t i, size_t j), void *arg);
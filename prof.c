@@ -0,0 +1,573 @@
+#include <sys/time.h>
+#include <err.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "hoc.h"
+#include "code.h"
+#include "prof.h"
+#include "gramm.h"
+
+/*
+ * The profiler is enabled by the -p option.  When it is enabled,
+ * execute() and call() report each operation and each call of a
+ * function or procedure, and the time spent on them is accumulated.
+ * Time is exclusive (self) for operations and lines, so the time of the
+ * loop body is not charged to whilecode(); and both inclusive and
+ * exclusive for functions.  When it is disabled, the only cost is a
+ * test of the `profiling` flag on each execute() and call().
+ *
+ * The sampler is enabled by the -F option.  It does not instrument
+ * anything; instead, a SIGPROF timer interrupts the program at regular
+ * intervals of CPU time, and the handler records the chain of frames
+ * of the functions being executed and the instruction each of them is
+ * at.  Identical stacks are counted in a preallocated table, so the
+ * handler neither allocates memory nor does I/O.  On exit, the stacks
+ * are written in the folded format read by flamegraph.pl and similar
+ * tools: one line per stack, with the frames separated by semicolons
+ * from the outermost one, then a space and the number of samples.
+ *
+ * Both record instructions, not lines, while the program runs, and map
+ * them to lines with the line table on exit; so program memory is not
+ * reused between statements while either is enabled.
+ */
+
+#define NSTACK     4096         /* maximum depth of nested operations and calls */
+#define NSAMPLES   4096         /* maximum number of distinct sampled stacks */
+#define NFRAMES    32           /* maximum number of frames in a sampled stack */
+#define SAMPLEUSEC 1000         /* sampling interval, in microseconds */
+
+/* profile entry of an operation, function, instruction or line */
+typedef struct Entry {
+	const void *key;
+	const char *s;
+	uint64_t count;
+	uint64_t self;          /* exclusive time, in nanoseconds */
+	uint64_t total;         /* inclusive time, in nanoseconds */
+	size_t active;          /* number of activations on the stack */
+	int line;
+} Entry;
+
+/* activation on the profile stack */
+typedef struct Activation {
+	const void *key;
+	uint64_t start;
+} Activation;
+
+/* profile table and stack */
+typedef struct Profile {
+	Entry *tab;             /* hash table, by key */
+	size_t size, n;
+	Activation stack[NSTACK];
+	size_t depth;
+	size_t lost;            /* activations too deep to be profiled */
+	uint64_t last;          /* time of last event */
+} Profile;
+
+/* sampled stack */
+typedef struct Sample {
+	uint64_t hash;
+	uint64_t count;
+	size_t depth;           /* number of frames, not counting the top level */
+	int truncated;          /* whether outer frames were not recorded */
+	Name *names[NFRAMES];   /* innermost first */
+	Inst *pcs[NFRAMES + 1]; /* where each frame is, then the top level */
+} Sample;
+
+/* folded stack */
+typedef struct Folded {
+	char *s;
+	uint64_t count;
+} Folded;
+
+int profiling = 0;
+
+static Profile *oprprof = NULL;
+static Profile *funprof = NULL;
+static Profile *instprof = NULL;
+
+static Sample *samples = NULL;
+static const char *samplepath = NULL;
+static volatile sig_atomic_t nlost = 0;
+
+/* line of each instruction, and line of the instruction before each one */
+static Profile *linemap = NULL;
+static Profile *pcmap = NULL;
+
+/* get monotonic time in nanoseconds */
+static uint64_t
+now(void)
+{
+	struct timespec ts;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* allocate profile */
+static Profile *
+newprofile(void)
+{
+	Profile *prof;
+
+	if ((prof = calloc(1, sizeof *prof)) == NULL)
+		err(1, "calloc");
+	prof->size = 1024;
+	if ((prof->tab = calloc(prof->size, sizeof *prof->tab)) == NULL)
+		err(1, "calloc");
+	return prof;
+}
+
+/* free profile */
+static void
+freeprofile(Profile *prof)
+{
+	if (prof == NULL)
+		return;
+	free(prof->tab);
+	free(prof);
+}
+
+/* get slot of key in hash table */
+static Entry *
+slot(Entry *tab, size_t size, const void *key)
+{
+	size_t i;
+
+	i = ((uintptr_t)key >> 4) & (size - 1);
+	while (tab[i].key && tab[i].key != key)
+		i = (i + 1) & (size - 1);
+	return &tab[i];
+}
+
+/* get entry of key in profile table, or NULL */
+static Entry *
+findentry(Profile *prof, const void *key)
+{
+	Entry *e;
+
+	e = slot(prof->tab, prof->size, key);
+	return e->key ? e : NULL;
+}
+
+/* get entry of key in profile table, adding it if needed */
+static Entry *
+getentry(Profile *prof, const void *key, const char *s)
+{
+	Entry *tab, *e;
+	size_t i;
+
+	e = slot(prof->tab, prof->size, key);
+	if (e->key)
+		return e;
+	if (2 * (prof->n + 1) > prof->size) {
+		/* the table doubles whenever it gets half full */
+		if ((tab = calloc(2 * prof->size, sizeof *tab)) == NULL)
+			err(1, "calloc");
+		for (i = 0; i < prof->size; i++)
+			if (prof->tab[i].key)
+				*slot(tab, 2 * prof->size, prof->tab[i].key) = prof->tab[i];
+		free(prof->tab);
+		prof->tab = tab;
+		prof->size *= 2;
+		e = slot(prof->tab, prof->size, key);
+	}
+	prof->n++;
+	e->key = key;
+	e->s = s;
+	return e;
+}
+
+/* push activation of key onto profile stack at time t */
+static void
+enter(Profile *prof, const void *key, const char *s, uint64_t t)
+{
+	Activation *act;
+	Entry *e;
+
+	if (prof->depth > 0 && prof->depth <= NSTACK)
+		getentry(prof, prof->stack[prof->depth - 1].key, NULL)->self += t - prof->last;
+	prof->last = t;
+	if (prof->depth++ >= NSTACK) {
+		prof->lost++;
+		return;
+	}
+	act = &prof->stack[prof->depth - 1];
+	act->key = key;
+	act->start = t;
+	e = getentry(prof, key, s);
+	e->count++;
+	e->active++;
+}
+
+/* pop activation from profile stack at time t */
+static void
+leave(Profile *prof, uint64_t t)
+{
+	Activation *act;
+	Entry *e;
+
+	if (prof->depth == 0)
+		return;
+	if (prof->depth-- > NSTACK)
+		return;
+	act = &prof->stack[prof->depth];
+	e = getentry(prof, act->key, NULL);
+	e->self += t - prof->last;
+	if (--e->active == 0)           /* count recursive calls once */
+		e->total += t - act->start;
+	prof->last = t;
+}
+
+/* unwind profile stack, after an error jumped to the main loop */
+static void
+unwind(Profile *prof)
+{
+	uint64_t t;
+
+	t = now();
+	while (prof->depth > 0)
+		leave(prof, t);
+}
+
+/* compare entries by exclusive time, empty ones last, for qsort(3) */
+static int
+cmpentry(const void *a, const void *b)
+{
+	const Entry *x = a, *y = b;
+
+	if (x->key == NULL || y->key == NULL)
+		return (x->key == NULL) - (y->key == NULL);
+	if (x->self != y->self)
+		return x->self < y->self ? 1 : -1;
+	if (x->count != y->count)
+		return x->count < y->count ? 1 : -1;
+	return 0;
+}
+
+/* sort profile table, which is no longer a hash table, and return total exclusive time */
+static uint64_t
+sortprofile(Profile *prof)
+{
+	uint64_t total = 0;
+	size_t i;
+
+	qsort(prof->tab, prof->size, sizeof prof->tab[0], cmpentry);
+	for (i = 0; i < prof->n; i++)
+		total += prof->tab[i].self;
+	return total;
+}
+
+/* get line of instruction, or 0 */
+static int
+instline(Profile *map, Inst *ip)
+{
+	Entry *e;
+
+	return (e = findentry(map, ip)) ? e->line : 0;
+}
+
+/* record line of instruction ip */
+static void
+mapline(Inst *ip, int line)
+{
+	getentry(linemap, ip, NULL)->line = line;
+	getentry(pcmap, ip->next, NULL)->line = line;
+}
+
+/* map instructions to lines, once the program is over */
+static void
+maplinesinit(void)
+{
+	Name *name;
+	Inst *code;
+
+	if (linemap)
+		return;
+	linemap = newprofile();
+	pcmap = newprofile();
+	maplines(1, mapline);
+
+	/* a function that has just been called is at its first instruction */
+	for (name = getnametab(); name; name = name->next) {
+		if (name->type != FUNCTION && name->type != PROCEDURE)
+			continue;
+		code = name->u.fun->code;
+		getentry(pcmap, code, NULL)->line = instline(linemap, code);
+	}
+}
+
+/* enable profiler */
+void
+profinit(void)
+{
+	oprprof = newprofile();
+	funprof = newprofile();
+	instprof = newprofile();
+	keepallcode();
+	profiling = 1;
+}
+
+/* an instruction is about to be executed */
+void
+profopr(Inst *ip)
+{
+	uint64_t t;
+
+	t = now();
+	enter(oprprof, (const void *)ip->u.opr, NULL, t);
+	enter(instprof, ip, NULL, t);
+}
+
+/* the instruction executed last has returned */
+void
+profoprend(void)
+{
+	uint64_t t;
+
+	t = now();
+	leave(instprof, t);
+	leave(oprprof, t);
+}
+
+/* a function or procedure is about to be called */
+void
+profcall(Name *name)
+{
+	enter(funprof, name, name->s, now());
+}
+
+/* the function or procedure called last has returned */
+void
+profret(void)
+{
+	leave(funprof, now());
+}
+
+/* unwind the profiler after an error */
+void
+profreset(void)
+{
+	if (!profiling)
+		return;
+	unwind(oprprof);
+	unwind(funprof);
+	unwind(instprof);
+}
+
+/* print profile report onto stderr */
+void
+profreport(void)
+{
+	Profile *lineprof;
+	Entry *e, *l;
+	uint64_t total;
+	size_t i;
+	int line;
+
+	if (!profiling)
+		return;
+	profreset();
+	fflush(stdout);
+
+	total = sortprofile(oprprof);
+	fprintf(stderr, "%12s %12s %7s  %s\n", "count", "self(ms)", "self%", "operation");
+	for (i = 0; i < oprprof->n; i++) {
+		e = &oprprof->tab[i];
+		fprintf(stderr, "%12llu %12.3f %6.2f%%  %s\n",
+		        (unsigned long long)e->count, e->self / 1e6,
+		        total ? 100.0 * e->self / total : 0.0,
+		        oprname((void (*)(void))e->key));
+	}
+
+	total = sortprofile(funprof);
+	if (funprof->n > 0)
+		fprintf(stderr, "\n%12s %12s %12s %7s  %s\n",
+		        "calls", "total(ms)", "self(ms)", "self%", "function");
+	for (i = 0; i < funprof->n; i++) {
+		e = &funprof->tab[i];
+		fprintf(stderr, "%12llu %12.3f %12.3f %6.2f%%  %s\n",
+		        (unsigned long long)e->count, e->total / 1e6, e->self / 1e6,
+		        total ? 100.0 * e->self / total : 0.0, e->s);
+	}
+
+	/* add up instructions by line; the line number is the key */
+	maplinesinit();
+	lineprof = newprofile();
+	for (i = 0; i < instprof->size; i++) {
+		e = &instprof->tab[i];
+		if (e->key == NULL)
+			continue;
+		line = instline(linemap, (Inst *)e->key);
+		l = getentry(lineprof, (const void *)(uintptr_t)(line + 1), NULL);
+		l->line = line;
+		l->count += e->count;
+		l->self += e->self;
+	}
+	total = sortprofile(lineprof);
+	if (lineprof->n > 0)
+		fprintf(stderr, "\n%12s %12s %7s  %s\n", "count", "self(ms)", "self%", "line");
+	for (i = 0; i < lineprof->n; i++) {
+		e = &lineprof->tab[i];
+		fprintf(stderr, "%12llu %12.3f %6.2f%%  %s:%d\n",
+		        (unsigned long long)e->count, e->self / 1e6,
+		        total ? 100.0 * e->self / total : 0.0,
+		        getfilename(), e->line);
+	}
+	freeprofile(lineprof);
+
+	if (oprprof->lost || funprof->lost)
+		fprintf(stderr, "\n%zu operations and %zu calls nested too deep were not profiled\n",
+		        oprprof->lost, funprof->lost);
+	freeprofile(oprprof);
+	freeprofile(funprof);
+	freeprofile(instprof);
+	oprprof = funprof = instprof = NULL;
+	profiling = 0;
+}
+
+/* record stack of frames being executed; called on SIGPROF */
+static void
+sighand(int sig)
+{
+	Sample *smp;
+	Frame *f;
+	Name *names[NFRAMES];
+	Inst *pcs[NFRAMES + 1];
+	uint64_t h;
+	size_t i, n, depth;
+
+	(void)sig;
+	h = 14695981039346656037ULL;
+	depth = 0;
+	pcs[0] = getpc();
+	for (f = getframe(); f && depth < NFRAMES; f = f->prev) {
+		h = (h ^ (uintptr_t)pcs[depth]) * 1099511628211ULL;
+		h = (h ^ (uintptr_t)f->name) * 1099511628211ULL;
+		names[depth++] = f->name;
+		pcs[depth] = f->retpc;
+	}
+	h = (h ^ (uintptr_t)pcs[depth]) * 1099511628211ULL;
+	h ^= (f != NULL);
+	i = h % NSAMPLES;
+	for (n = 0; n < NSAMPLES; n++, i = (i + 1) % NSAMPLES) {
+		smp = &samples[i];
+		if (smp->count == 0) {
+			smp->hash = h;
+			smp->depth = depth;
+			smp->truncated = (f != NULL);
+			memcpy(smp->names, names, depth * sizeof *names);
+			memcpy(smp->pcs, pcs, (depth + 1) * sizeof *pcs);
+			smp->count = 1;
+			return;
+		}
+		if (smp->hash == h && smp->depth == depth &&
+		    smp->truncated == (f != NULL) &&
+		    memcmp(smp->names, names, depth * sizeof *names) == 0 &&
+		    memcmp(smp->pcs, pcs, (depth + 1) * sizeof *pcs) == 0) {
+			smp->count++;
+			return;
+		}
+	}
+	nlost++;
+}
+
+/* compare folded stacks, for qsort(3) */
+static int
+cmpfolded(const void *a, const void *b)
+{
+	return strcmp(((const Folded *)a)->s, ((const Folded *)b)->s);
+}
+
+/* get folded stack of sample, without its count */
+static char *
+foldstack(Sample *smp)
+{
+	char *buf;
+	size_t size, len, j;
+
+	/* each frame is at most ";" and 32 bytes of name, ":", and the line */
+	size = 48 * (smp->depth + 1) + strlen(getfilename());
+	if ((buf = malloc(size)) == NULL)
+		err(1, "malloc");
+	len = 0;
+	if (smp->truncated)
+		len += snprintf(buf + len, size - len, "...;");
+	len += snprintf(buf + len, size - len, "%s:%d",
+	                getfilename(), instline(pcmap, smp->pcs[smp->depth]));
+	for (j = smp->depth; j > 0; j--)
+		len += snprintf(buf + len, size - len, ";%.32s:%d",
+		                smp->names[j - 1] ? smp->names[j - 1]->s : "?",
+		                instline(pcmap, smp->pcs[j - 1]));
+	return buf;
+}
+
+/* start sampling the call stack into the folded stacks file path */
+void
+sampleinit(const char *path)
+{
+	struct sigaction sa;
+	struct itimerval it;
+
+	if ((samples = calloc(NSAMPLES, sizeof *samples)) == NULL)
+		err(1, "calloc");
+	samplepath = path;
+	keepallcode();
+	sa.sa_handler = sighand;
+	sa.sa_flags = SA_RESTART;
+	sigemptyset(&sa.sa_mask);
+	if (sigaction(SIGPROF, &sa, NULL) == -1)
+		err(1, "sigaction");
+	it.it_interval.tv_sec = 0;
+	it.it_interval.tv_usec = SAMPLEUSEC;
+	it.it_value = it.it_interval;
+	if (setitimer(ITIMER_PROF, &it, NULL) == -1)
+		err(1, "setitimer");
+}
+
+/* stop sampling and write folded stacks; samples that fold into the same stack are merged */
+void
+samplereport(void)
+{
+	struct itimerval it;
+	Folded *folded;
+	FILE *fp;
+	size_t i, j, n;
+
+	if (samples == NULL)
+		return;
+	memset(&it, 0, sizeof it);
+	if (setitimer(ITIMER_PROF, &it, NULL) == -1)
+		err(1, "setitimer");
+	maplinesinit();
+	if ((folded = calloc(NSAMPLES, sizeof *folded)) == NULL)
+		err(1, "calloc");
+	for (n = i = 0; i < NSAMPLES; i++) {
+		if (samples[i].count == 0)
+			continue;
+		folded[n].s = foldstack(&samples[i]);
+		folded[n].count = samples[i].count;
+		n++;
+	}
+	qsort(folded, n, sizeof *folded, cmpfolded);
+	if ((fp = fopen(samplepath, "w")) == NULL)
+		err(1, "%s", samplepath);
+	for (i = 0; i < n; i = j) {
+		for (j = i + 1; j < n && strcmp(folded[j].s, folded[i].s) == 0; j++)
+			folded[i].count += folded[j].count;
+		fprintf(fp, "%s %llu\n", folded[i].s, (unsigned long long)folded[i].count);
+	}
+	if (fclose(fp) == EOF)
+		err(1, "%s", samplepath);
+	if (nlost)
+		warnx("%lu samples of too many distinct stacks were not recorded",
+		      (unsigned long)nlost);
+	for (i = 0; i < n; i++)
+		free(folded[i].s);
+	free(folded);
+	free(samples);
+	samples = NULL;
+}
@@ -0,0 +1,11 @@
+extern int profiling;
+
+void profinit(void);
+void profopr(Inst *ip);
+void profoprend(void);
+void profcall(Name *name);
+void profret(void);
+void profreset(void);
+void profreport(void);
+void sampleinit(const char *path);
+void samplereport(void);
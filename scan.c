@@ -0,0 +1,331 @@
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <err.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hoc.h"
+#include "code.h"
+#include "error.h"
+#include "gramm.h"
+
+/*
+ * Hand-written alternative to lex.l.  A regular input file is mapped
+ * into memory with mmap(2) and tokenized in place; other input (such
+ * as a terminal or a pipe) is read one line at a time.  The tokens and
+ * line numbers are the same as those produced by lex.l.
+ */
+
+#define ISDIGIT(c)  ((c) >= '0' && (c) <= '9')
+#define ISALPHA(c)  (((c) >= 'a' && (c) <= 'z') || ((c) >= 'A' && (c) <= 'Z') || (c) == '_')
+#define ISALNUM(c)  (ISALPHA(c) || ISDIGIT(c))
+#define ISOCTAL(c)  ((c) >= '0' && (c) <= '7')
+#define ISHEX(c)    (ISDIGIT(c) || ((c) >= 'a' && (c) <= 'f') || ((c) >= 'A' && (c) <= 'F'))
+
+FILE *yyin = NULL;
+int yylineno = 1;
+int toklineno = 1;              /* line the last token begins at */
+
+/* the input buffer */
+static struct {
+	const char *p;          /* next character to be scanned */
+	const char *end;        /* end of buffered input */
+	char *map;              /* mmap(2)ed input file */
+	size_t maplen;
+	char *line;             /* line buffer, for non-mappable input */
+	size_t linesize;
+	int init;
+	int eof;
+} in = {NULL, NULL, NULL, 0, NULL, 0, 0, 0};
+
+/* map regular input file into memory; return 0 if it cannot be mapped */
+static int
+mapinput(void)
+{
+	struct stat st;
+	void *p;
+
+	if (fstat(fileno(yyin), &st) == -1 || !S_ISREG(st.st_mode))
+		return 0;
+	if (st.st_size == 0) {
+		in.eof = 1;
+		return 1;
+	}
+	p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno(yyin), 0);
+	if (p == MAP_FAILED)
+		return 0;
+	(void)madvise(p, st.st_size, MADV_SEQUENTIAL);
+	in.map = p;
+	in.maplen = st.st_size;
+	in.p = in.map;
+	in.end = in.map + in.maplen;
+	in.eof = 1;             /* nothing else to read after the mapping */
+	return 1;
+}
+
+/* unmap input file and free line buffer */
+static void
+closeinput(void)
+{
+	if (in.map)
+		(void)munmap(in.map, in.maplen);
+	free(in.line);
+	in.map = in.line = NULL;
+	in.p = in.end = NULL;
+	in.maplen = in.linesize = 0;
+}
+
+/* scan string s instead of the input file, from its first line */
+void
+scanstring(const char *s)
+{
+	closeinput();
+	in.p = s;
+	in.end = s + strlen(s);
+	in.init = in.eof = 1;
+	yylineno = toklineno = 1;
+}
+
+/* fill input buffer with the next line; return 0 on end of input */
+static int
+fillinput(void)
+{
+	ssize_t n;
+
+	if (!in.init) {
+		in.init = 1;
+		if (yyin == NULL)
+			yyin = stdin;
+		if (mapinput() && in.p < in.end)
+			return 1;
+	}
+	if (in.eof) {
+		closeinput();
+		return 0;
+	}
+	if ((n = getline(&in.line, &in.linesize, yyin)) == -1) {
+		if (ferror(yyin))
+			err(1, "input");
+		in.eof = 1;
+		closeinput();
+		return 0;
+	}
+	in.p = in.line;
+	in.end = in.line + n;
+	return 1;
+}
+
+/* return character at p, or -1 at end of the buffer */
+static int
+peek(const char *p)
+{
+	return p < in.end ? (unsigned char)*p : -1;
+}
+
+static int
+makenum(const char *s, size_t len)
+{
+	char buf[64], *t;
+
+	t = buf;
+	if (len >= sizeof buf && (t = malloc(len + 1)) == NULL)
+		yyerror("out of memory");
+	memcpy(t, s, len);
+	t[len] = '\0';
+	yylval.val = atof(t);
+	if (t != buf)
+		free(t);
+	return NUMBER;
+}
+
+static int
+makenam(const char *s, size_t len)
+{
+	Name *name;
+	char *t;
+
+	/* if name isn't found, it is installed with the type VAR */
+	if ((name = lookupnamelen(s, len)) == NULL) {
+		if ((t = strndup(s, len)) == NULL)
+			yyerror("out of memory");
+		name = installglobalname(t, UNDEF);
+		free(t);
+	}
+
+	yylval.name = name;
+
+	/* see makenam() in lex.l for why UNDEF is returned as VAR */
+	return name->type == UNDEF ? VAR : name->type;
+}
+
+static int
+makestr(const char *s, size_t len)
+{
+	static char indextab[] = "'\"\\abfnrtv";
+	static char transtab[] = "''\"\"\\\\a\ab\bf\fn\nr\rt\tv\v";
+	const char *t;
+	char *buf, *u, *ind;
+
+	/* we don't need + 1 for s has quotation marks */
+	if ((buf = malloc(len)) == NULL)
+		yyerror("out of memory");
+	for (u = buf, t = s + 1; t < s + len - 1; u++, t++) {
+		if (*t != '\\') {
+			*u = *t;
+		} else {
+			t++;
+			if (strchr(indextab, *t) && (ind = strchr(transtab, *t))) {
+				*u = *(ind + 1);
+			} else {
+				*u = *t;
+			}
+		}
+	}
+	*u = '\0';
+	yylval.str = addstr(buf, 0);
+	return STRING;
+}
+
+/* return end of number starting at p */
+static const char *
+scannum(const char *p)
+{
+	while (ISDIGIT(peek(p)))
+		p++;
+	if (peek(p) == '.')
+		p++;
+	while (ISDIGIT(peek(p)))
+		p++;
+	if (peek(p) == 'e' || peek(p) == 'E') {
+		p++;
+		if (peek(p) == '+' || peek(p) == '-')
+			p++;
+		while (ISDIGIT(peek(p)))
+			p++;
+	}
+	return p;
+}
+
+/* return end of string literal starting at p, or NULL if it is not one */
+static const char *
+scanstr(const char *p)
+{
+	int c;
+
+	for (p++; (c = peek(p)) != '"'; p++) {
+		if (c == -1 || c == '\n')
+			return NULL;
+		if (c != '\\')
+			continue;
+		c = peek(++p);
+		if (c == 'x') {
+			if (!ISHEX(peek(p + 1)))
+				return NULL;
+		} else if (c == -1 || (!ISOCTAL(c) && (c == '\0' || !strchr("'\"?\\abfnrtv", c)))) {
+			return NULL;
+		}
+	}
+	return p + 1;
+}
+
+/* return next token */
+int
+yylex(void)
+{
+	const char *p, *q;
+	int c;
+
+again:
+	if (in.p >= in.end && !fillinput())
+		return 0;
+	p = in.p;
+	toklineno = yylineno;
+	switch (c = (unsigned char)*p++) {
+	case ' ': case '\t':
+		in.p = p;
+		goto again;
+	case '\\':
+		if (peek(p) == '\n') {
+			yylineno++;
+			in.p = p + 1;
+			goto again;
+		}
+		break;
+	case '\n':
+		yylineno++;
+		in.p = p;
+		return '\n';
+	case '#':
+		while (p < in.end && *p != '\n')
+			p++;
+		in.p = p;
+		return '\n';
+	case '"':
+		if ((q = scanstr(p - 1)) == NULL)
+			break;
+		in.p = q;
+		return makestr(p - 1, q - p + 1);
+	case '.':
+		if (!ISDIGIT(peek(p))) {
+			in.p = p;
+			return PREVIOUS;
+		}
+		/* FALLTHROUGH */
+	case '0': case '1': case '2': case '3': case '4':
+	case '5': case '6': case '7': case '8': case '9':
+		q = scannum(p - 1);
+		in.p = q;
+		return makenum(p - 1, q - p + 1);
+	case '+':
+		if (peek(p) == '+') { in.p = p + 1; return INC; }
+		if (peek(p) == '=') { in.p = p + 1; return ADDEQ; }
+		break;
+	case '-':
+		if (peek(p) == '-') { in.p = p + 1; return DEC; }
+		if (peek(p) == '=') { in.p = p + 1; return SUBEQ; }
+		break;
+	case '*':
+		if (peek(p) == '=') { in.p = p + 1; return MULEQ; }
+		break;
+	case '/':
+		if (peek(p) == '=') { in.p = p + 1; return DIVEQ; }
+		break;
+	case '%':
+		if (peek(p) == '=') { in.p = p + 1; return MODEQ; }
+		break;
+	case '>':
+		if (peek(p) == '=') { in.p = p + 1; return GE; }
+		in.p = p;
+		return GT;
+	case '<':
+		if (peek(p) == '=') { in.p = p + 1; return LE; }
+		in.p = p;
+		return LT;
+	case '=':
+		if (peek(p) == '=') { in.p = p + 1; return EQ; }
+		break;
+	case '!':
+		if (peek(p) == '=') { in.p = p + 1; return NE; }
+		in.p = p;
+		return NOT;
+	case '|':
+		if (peek(p) == '|') { in.p = p + 1; return OR; }
+		break;
+	case '&':
+		if (peek(p) == '&') { in.p = p + 1; return AND; }
+		break;
+	default:
+		if (ISALPHA(c)) {
+			for (q = p; q < in.end && ISALNUM((unsigned char)*q); q++)
+				;
+			in.p = q;
+			return makenam(p - 1, q - p + 1);
+		}
+		break;
+	}
+
+	/* any other character is returned as itself */
+	in.p = p;
+	return (char)c;
+}
@@ -0,0 +1,365 @@
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sketch.h"
+
+/*
+ * Sketches of streams of numbers, which take constant memory whatever
+ * the number of values added.  Every sketch keeps the count, minimum,
+ * maximum, and Welford's running mean and sum of squared deviations,
+ * which are merged by Chan's formula.  A histogram also counts the
+ * values in equal bins of a range.  A KLL sketch keeps a sample of the
+ * values in levels: a value at level h stands for 2^h values added.
+ * When a level is full it is compacted: it is sorted, and every other
+ * value of it, starting at the first or the second by the toss of a
+ * coin, goes up a level while the rest are dropped.  The capacity of
+ * each level is 2/3 of the one above it, the top one holding k values,
+ * so the whole sketch holds at most about 3k values; with k = 200, the
+ * rank of a quantile it answers is off by at most about 1.3% of the
+ * values added.  The coin is pseudo-random from a fixed seed, so a
+ * sketch is the same every run.
+ */
+
+#define KLLMIN     8            /* capacity of a level of a KLL sketch, at least */
+#define SEED       0x9E3779B97F4A7C15ULL
+
+/* a value of a KLL sketch and the number of values it stands for */
+typedef struct Item {
+	double x;
+	double w;
+} Item;
+
+/*
+ * allocate a sketch of the given kind: a histogram of n bins from lo
+ * to hi, or a KLL sketch of accuracy n; or return NULL
+ */
+Sketch *
+sknew(int kind, double lo, double hi, size_t n)
+{
+	Sketch *s;
+
+	if ((s = calloc(1, sizeof *s)) == NULL)
+		return NULL;
+	s->kind = kind;
+	s->min = INFINITY;
+	s->max = -INFINITY;
+	s->rand = SEED;
+	if (kind == SKHIST) {
+		s->lo = lo;
+		s->hi = hi;
+		s->nbins = n;
+		if ((s->bins = calloc(n, sizeof *s->bins)) == NULL) {
+			free(s);
+			return NULL;
+		}
+	} else if (kind == SKKLL) {
+		s->k = n;
+	}
+	return s;
+}
+
+/* free sketch s */
+void
+skfree(Sketch *s)
+{
+	size_t i;
+
+	for (i = 0; i < s->nlevels; i++)
+		free(s->levels[i].x);
+	free(s->levels);
+	free(s->bins);
+	free(s);
+}
+
+/* get the capacity of level h of KLL sketch s */
+static size_t
+capacity(const Sketch *s, size_t h)
+{
+	double c;
+	size_t i;
+
+	c = s->k;
+	for (i = h + 1; i < s->nlevels && c > KLLMIN; i++)
+		c *= 2.0 / 3.0;
+	return (c < KLLMIN) ? KLLMIN : (size_t)c;
+}
+
+/* make room for n more values in level l; return -1 if out of memory */
+static int
+grow(Level *l, size_t n)
+{
+	size_t size;
+	double *p;
+
+	if (l->len + n <= l->size)
+		return 0;
+	for (size = l->size ? l->size : KLLMIN; size < l->len + n; size *= 2)
+		;
+	if ((p = realloc(l->x, size * sizeof *p)) == NULL)
+		return -1;
+	l->x = p;
+	l->size = size;
+	return 0;
+}
+
+/* make sure s has n levels; return -1 if out of memory */
+static int
+addlevels(Sketch *s, size_t n)
+{
+	Level *p;
+
+	if (n <= s->nlevels)
+		return 0;
+	if ((p = realloc(s->levels, n * sizeof *p)) == NULL)
+		return -1;
+	memset(p + s->nlevels, 0, (n - s->nlevels) * sizeof *p);
+	s->levels = p;
+	s->nlevels = n;
+	return 0;
+}
+
+/* toss the coin of s (xorshift64) */
+static int
+toss(Sketch *s)
+{
+	s->rand ^= s->rand << 13;
+	s->rand ^= s->rand >> 7;
+	s->rand ^= s->rand << 17;
+	return s->rand & 1;
+}
+
+static int
+cmpdouble(const void *a, const void *b)
+{
+	double x, y;
+
+	x = *(const double *)a;
+	y = *(const double *)b;
+	return (x > y) - (x < y);
+}
+
+/* move every other value of level h of s up a level, leaving one if they are odd; return -1 if out of memory */
+static int
+compact(Sketch *s, size_t h)
+{
+	Level *l, *up;
+	size_t i, m;
+
+	if (addlevels(s, h + 2) == -1)
+		return -1;
+	l = &s->levels[h];
+	up = &s->levels[h + 1];
+	m = l->len & ~(size_t)1;
+	if (grow(up, m / 2) == -1)
+		return -1;
+	qsort(l->x, l->len, sizeof *l->x, cmpdouble);
+	for (i = toss(s); i < m; i += 2)
+		up->x[up->len++] = l->x[i];
+	if (l->len > m)
+		l->x[0] = l->x[m];
+	l->len -= m;
+	return 0;
+}
+
+/* compact the full levels of s, from the bottom up; return -1 if out of memory */
+static int
+compress(Sketch *s)
+{
+	size_t h;
+
+	for (h = 0; h < s->nlevels; h++)
+		if (s->levels[h].len >= capacity(s, h) && compact(s, h) == -1)
+			return -1;
+	return 0;
+}
+
+/* add the n values x to s; return EDOM if one is NaN, and ENOMEM if out of memory */
+int
+skadd(Sketch *s, const double *x, size_t n)
+{
+	Level *l;
+	double d, w;
+	size_t i, b;
+
+	for (i = 0; i < n; i++)
+		if (isnan(x[i]))
+			return EDOM;
+	for (i = 0; i < n; i++) {
+		s->n++;
+		d = x[i] - s->mean;
+		s->mean += d / s->n;
+		s->m2 += d * (x[i] - s->mean);
+		if (x[i] < s->min)
+			s->min = x[i];
+		if (x[i] > s->max)
+			s->max = x[i];
+		if (s->kind == SKHIST) {
+			if (x[i] < s->lo) {
+				s->under++;
+			} else if (x[i] >= s->hi) {
+				s->over++;
+			} else {
+				w = (s->hi - s->lo) / s->nbins;
+				b = (size_t)((x[i] - s->lo) / w);
+				s->bins[b < s->nbins ? b : s->nbins - 1]++;
+			}
+		} else if (s->kind == SKKLL) {
+			if (addlevels(s, 1) == -1 || grow(&s->levels[0], 1) == -1)
+				return ENOMEM;
+			l = &s->levels[0];
+			l->x[l->len++] = x[i];
+			if (l->len >= capacity(s, 0) && compress(s) == -1)
+				return ENOMEM;
+		}
+	}
+	return 0;
+}
+
+/* add the values summarized by t, of the same kind and range, to s; return EINVAL if they differ, and ENOMEM if out of memory */
+int
+skmerge(Sketch *s, const Sketch *t)
+{
+	double n, d, mean, m2;
+	size_t h, i, len;
+
+	if (s->kind != t->kind)
+		return EINVAL;
+	if (s->kind == SKHIST && (s->lo != t->lo || s->hi != t->hi || s->nbins != t->nbins))
+		return EINVAL;
+	if (t->n == 0)
+		return 0;
+
+	/* s and t may be the same sketch, so t is read before s is written */
+	if (s->kind == SKHIST) {
+		for (i = 0; i < s->nbins; i++)
+			s->bins[i] += t->bins[i];
+		s->under += t->under;
+		s->over += t->over;
+	} else if (s->kind == SKKLL) {
+		if (addlevels(s, t->nlevels) == -1)
+			return ENOMEM;
+		for (h = 0; h < t->nlevels; h++) {
+			if ((len = t->levels[h].len) == 0)
+				continue;
+			if (grow(&s->levels[h], len) == -1)
+				return ENOMEM;
+			memcpy(s->levels[h].x + s->levels[h].len, t->levels[h].x, len * sizeof *t->levels[h].x);
+			s->levels[h].len += len;
+		}
+		if (compress(s) == -1)
+			return ENOMEM;
+	}
+	n = (double)s->n + t->n;
+	d = t->mean - s->mean;
+	mean = s->mean + d * t->n / n;
+	m2 = s->m2 + t->m2 + d * d * s->n * t->n / n;
+	s->n += t->n;
+	s->mean = mean;
+	s->m2 = m2;
+	if (t->min < s->min)
+		s->min = t->min;
+	if (t->max > s->max)
+		s->max = t->max;
+	return 0;
+}
+
+/* get the sample variance of the values added to s */
+double
+skvariance(const Sketch *s)
+{
+	return (s->n > 1) ? s->m2 / (s->n - 1) : 0.0;
+}
+
+static int
+cmpitem(const void *a, const void *b)
+{
+	const Item *x, *y;
+
+	x = a;
+	y = b;
+	return (x->x > y->x) - (x->x < y->x);
+}
+
+/* store into z the quantile of each of the n fractions q of a histogram; values out of its range are taken as its bounds */
+static void
+histquantile(const Sketch *s, const double *q, double *z, size_t n)
+{
+	double target, cum, w;
+	size_t i, b;
+
+	w = (s->hi - s->lo) / s->nbins;
+	for (i = 0; i < n; i++) {
+		target = q[i] * s->n;
+		if (target <= s->under) {
+			z[i] = (s->under > 0) ? s->lo : s->min;
+			continue;
+		}
+		cum = s->under;
+		for (b = 0; b < s->nbins && cum + s->bins[b] < target; b++)
+			cum += s->bins[b];
+		if (b == s->nbins)
+			z[i] = s->hi;
+		else
+			z[i] = s->lo + w * (b + (target - cum) / s->bins[b]);
+		if (z[i] < s->min)
+			z[i] = s->min;
+		if (z[i] > s->max)
+			z[i] = s->max;
+	}
+}
+
+/* store into z the quantile of each of the n fractions q of a KLL sketch; return ENOMEM if out of memory */
+static int
+kllquantile(const Sketch *s, const double *q, double *z, size_t n)
+{
+	Item *items;
+	double target, w;
+	size_t h, i, j, m, lo, hi;
+
+	for (m = h = 0; h < s->nlevels; h++)
+		m += s->levels[h].len;
+	if ((items = malloc(m * sizeof *items + 1)) == NULL)
+		return ENOMEM;
+	for (m = h = 0, w = 1.0; h < s->nlevels; h++, w *= 2.0) {
+		for (j = 0; j < s->levels[h].len; j++) {
+			items[m].x = s->levels[h].x[j];
+			items[m++].w = w;
+		}
+	}
+	qsort(items, m, sizeof *items, cmpitem);
+	for (j = 1; j < m; j++)
+		items[j].w += items[j - 1].w;   /* the rank of each value */
+	for (i = 0; i < n; i++) {
+		/* the first value whose rank reaches q of the values added */
+		target = q[i] * items[m - 1].w;
+		for (lo = 0, hi = m - 1; lo < hi; ) {
+			j = lo + (hi - lo) / 2;
+			if (items[j].w < target)
+				lo = j + 1;
+			else
+				hi = j;
+		}
+		z[i] = (q[i] <= 0.0) ? s->min : (q[i] >= 1.0) ? s->max : items[lo].x;
+	}
+	free(items);
+	return 0;
+}
+
+/*
+ * store into z the quantile of each of the n fractions q, from 0 to 1,
+ * of the values added to s, which must be a histogram or KLL sketch and
+ * not empty; return EINVAL if it is not, and ENOMEM if out of memory
+ */
+int
+skquantile(const Sketch *s, const double *q, double *z, size_t n)
+{
+	if (s->n == 0 || s->kind == SKWELFORD)
+		return EINVAL;
+	if (s->kind == SKHIST) {
+		histquantile(s, q, z, n);
+		return 0;
+	}
+	return kllquantile(s, q, z, n);
+}
@@ -0,0 +1,33 @@
+#define KLLK       200          /* accuracy of a KLL sketch, by default */
+
+/* kinds of sketches */
+enum {SKWELFORD, SKHIST, SKKLL};
+
+/* a level of a KLL sketch, whose values each stand for 2^level values added */
+typedef struct Level {
+	double *x;
+	size_t len, size;
+} Level;
+
+/* summary of a stream of numbers */
+typedef struct Sketch {
+	int kind;
+	size_t n;                       /* values added */
+	double mean, m2;                /* Welford's running mean and sum of squared deviations */
+	double min, max;
+	double lo, hi;                  /* range of a histogram */
+	double under, over;             /* values below and above it */
+	double *bins;
+	size_t nbins;
+	size_t k;                       /* accuracy of a KLL sketch */
+	Level *levels;
+	size_t nlevels;
+	uint64_t rand;                  /* state of the coin of compactions */
+} Sketch;
+
+Sketch *sknew(int kind, double lo, double hi, size_t n);
+void skfree(Sketch *s);
+int skadd(Sketch *s, const double *x, size_t n);
+int skmerge(Sketch *s, const Sketch *t);
+double skvariance(const Sketch *s);
+int skquantile(const Sketch *s, const double *q, double *z, size_t n);
@@ -0,0 +1,395 @@
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "sort.h"
+
+/*
+ * Kernels for the sort built-in functions; every sort is stable, so its
+ * result is unique and does not depend on the number of threads.
+ * Numbers are sorted by an LSD radix sort of 64-bit keys made from
+ * their IEEE-754 bits, which compare as unsigned integers in the order
+ * of the numbers, DIGIT bits per pass.  Each pass is a counting sort:
+ * the keys are split into parts, each counted by its own thread, and
+ * the counts of all parts tell each thread where to move its keys.  A
+ * pass is skipped when all keys have the same digit, as the low digits
+ * of integers do.  Strings are sorted by a merge sort of their indices,
+ * each part sorted by its own thread, and the parts merged pairwise.
+ */
+
+#define DIGIT      11
+#define NBINS      (1 << DIGIT)
+#define SMALL      32           /* elements sorted by insertion */
+#define MINPART    (1 << 16)    /* elements given to a thread, at least */
+#define MAXTHREADS 64
+#define SIGN       ((uint64_t)1 << 63)
+#define MIN(a, b)  ((a) < (b) ? (a) : (b))
+
+/* the elements from i0 to i1 of a sort, run by a thread */
+typedef struct Part {
+	void (*f)(struct Part *);
+	uint64_t *k, *kt;       /* keys, and where a pass moves them */
+	size_t *v, *vt;         /* indices moved with the keys, or NULL */
+	size_t *count;          /* count of each digit, then where the next one goes */
+	int shift;              /* of the digit of the pass */
+	const char **s;         /* strings, for a merge sort */
+	int desc;
+	size_t i0, i1, i2;      /* a merge merges from i0 to i1 with from i1 to i2 */
+} Part;
+
+/* get the number of threads to split n elements into */
+static size_t
+nthreads(size_t n)
+{
+	static long ncpus = 0;          /* shared by the threads of parallel loops */
+	long nc;
+	size_t nt;
+
+	if ((nc = __atomic_load_n(&ncpus, __ATOMIC_RELAXED)) == 0) {
+		if ((nc = sysconf(_SC_NPROCESSORS_ONLN)) < 1)
+			nc = 1;
+		__atomic_store_n(&ncpus, nc, __ATOMIC_RELAXED);
+	}
+	nt = MIN((size_t)nc, MAXTHREADS);
+	nt = MIN(nt, n / MINPART);
+	return nt ? nt : 1;
+}
+
+static void *
+runpart(void *p)
+{
+	Part *t;
+
+	t = p;
+	t->f(t);
+	return NULL;
+}
+
+/* run the n parts, each in a thread but the first, and wait for them */
+static void
+parallel(Part *parts, size_t n)
+{
+	pthread_t tid[MAXTHREADS];
+	int started[MAXTHREADS];
+	size_t i;
+
+	for (i = 1; i < n; i++)
+		if (!(started[i] = pthread_create(&tid[i], NULL, runpart, &parts[i]) == 0))
+			parts[i].f(&parts[i]);
+	parts[0].f(&parts[0]);
+	for (i = 1; i < n; i++)
+		if (started[i])
+			pthread_join(tid[i], NULL);
+}
+
+/* get the key of x, in increasing order, or decreasing if desc != 0; NaNs are last, and -0 is 0 */
+static uint64_t
+sortkey(double x, int desc)
+{
+	uint64_t b;
+
+	if (isnan(x))
+		return UINT64_MAX;
+	if (x == 0.0)
+		x = 0.0;
+	memcpy(&b, &x, sizeof b);
+	b = (b & SIGN) ? ~b : b | SIGN;
+	return desc ? ~b : b;
+}
+
+/* get the number whose key is k */
+static double
+unkey(uint64_t k, int desc)
+{
+	double x;
+
+	if (desc)
+		k = ~k;
+	k = (k & SIGN) ? k & ~SIGN : ~k;
+	memcpy(&x, &k, sizeof x);
+	return x;
+}
+
+/* sort the n keys k, and the indices v if not NULL, by insertion */
+static void
+insertion(uint64_t *k, size_t *v, size_t n)
+{
+	uint64_t key;
+	size_t i, j, idx;
+
+	for (i = 1; i < n; i++) {
+		key = k[i];
+		idx = v ? v[i] : 0;
+		for (j = i; j > 0 && k[j - 1] > key; j--) {
+			k[j] = k[j - 1];
+			if (v)
+				v[j] = v[j - 1];
+		}
+		k[j] = key;
+		if (v)
+			v[j] = idx;
+	}
+}
+
+/* count the digits of the keys of a part */
+static void
+countpart(Part *t)
+{
+	size_t i;
+
+	memset(t->count, 0, NBINS * sizeof *t->count);
+	for (i = t->i0; i < t->i1; i++)
+		t->count[(t->k[i] >> t->shift) & (NBINS - 1)]++;
+}
+
+/* move the keys of a part to where their digits go */
+static void
+movepart(Part *t)
+{
+	size_t i, j;
+
+	for (i = t->i0; i < t->i1; i++) {
+		j = t->count[(t->k[i] >> t->shift) & (NBINS - 1)]++;
+		t->kt[j] = t->k[i];
+		if (t->v)
+			t->vt[j] = t->v[i];
+	}
+}
+
+/* sort the n keys k, moving the indices v with them if v is not NULL; return ENOMEM if out of memory */
+static int
+radix(uint64_t *k, size_t *v, size_t n)
+{
+	Part parts[MAXTHREADS];
+	uint64_t *kt, *ksave;
+	size_t *vt, *vsave, *count;
+	size_t i, d, nt, pos, off;
+	int shift;
+
+	if (n <= SMALL) {
+		insertion(k, v, n);
+		return 0;
+	}
+	nt = nthreads(n);
+	kt = malloc(n * sizeof *kt);
+	vt = v ? malloc(n * sizeof *vt) : NULL;
+	count = malloc(nt * NBINS * sizeof *count);
+	if (kt == NULL || (v && vt == NULL) || count == NULL) {
+		free(kt);
+		free(vt);
+		free(count);
+		return ENOMEM;
+	}
+	ksave = k;
+	vsave = v;
+	for (i = 0; i < nt; i++) {
+		parts[i].k = k;
+		parts[i].v = v;
+		parts[i].count = count + i * NBINS;
+		parts[i].i0 = n * i / nt;
+		parts[i].i1 = n * (i + 1) / nt;
+	}
+	for (shift = 0; shift < 64; shift += DIGIT) {
+		for (i = 0; i < nt; i++) {
+			parts[i].f = countpart;
+			parts[i].shift = shift;
+		}
+		parallel(parts, nt);
+
+		/* each part's keys of a digit go after those of the parts before */
+		d = (k[0] >> shift) & (NBINS - 1);
+		for (pos = i = 0; i < nt; i++)
+			pos += parts[i].count[d];
+		if (pos == n)
+			continue;       /* all keys have the same digit */
+		for (pos = d = 0; d < NBINS; d++) {
+			for (i = 0; i < nt; i++) {
+				off = parts[i].count[d];
+				parts[i].count[d] = pos;
+				pos += off;
+			}
+		}
+		for (i = 0; i < nt; i++) {
+			parts[i].f = movepart;
+			parts[i].kt = kt;
+			parts[i].vt = vt;
+		}
+		parallel(parts, nt);
+		for (i = 0; i < nt; i++) {
+			parts[i].k = kt;
+			parts[i].v = vt;
+		}
+		kt = k;
+		vt = v;
+		k = parts[0].k;
+		v = parts[0].v;
+	}
+	if (k != ksave) {
+		memcpy(ksave, k, n * sizeof *k);
+		if (v)
+			memcpy(vsave, v, n * sizeof *v);
+		kt = k;
+		vt = v;
+	}
+	free(kt);
+	free(vt);
+	free(count);
+	return 0;
+}
+
+/*
+ * store the n numbers x into z, in increasing order, or decreasing if
+ * desc != 0, with NaNs last; return ENOMEM if out of memory
+ */
+int
+sortnum(const double *x, double *z, size_t n, int desc)
+{
+	uint64_t *k;
+	size_t *idx, i;
+	int e;
+
+	for (i = 0; i < n; i++)
+		if (isnan(x[i]) || (x[i] == 0.0 && signbit(x[i])))
+			break;
+	if (i < n) {
+		/* NaNs and -0 are told apart from their equals by their indices */
+		if ((idx = malloc(n * sizeof *idx)) == NULL)
+			return ENOMEM;
+		if ((e = argsortnum(x, idx, n, desc)) == 0)
+			for (i = 0; i < n; i++)
+				z[i] = x[idx[i]];
+		free(idx);
+		return e;
+	}
+	if ((k = malloc(n * sizeof *k + 1)) == NULL)
+		return ENOMEM;
+	for (i = 0; i < n; i++)
+		k[i] = sortkey(x[i], desc);
+	if ((e = radix(k, NULL, n)) == 0)
+		for (i = 0; i < n; i++)
+			z[i] = unkey(k[i], desc);
+	free(k);
+	return e;
+}
+
+/* store into idx the indices of the n numbers x in the order sortnum() sorts them; return ENOMEM if out of memory */
+int
+argsortnum(const double *x, size_t *idx, size_t n, int desc)
+{
+	uint64_t *k;
+	size_t i;
+	int e;
+
+	if ((k = malloc(n * sizeof *k + 1)) == NULL)
+		return ENOMEM;
+	for (i = 0; i < n; i++) {
+		k[i] = sortkey(x[i], desc);
+		idx[i] = i;
+	}
+	e = radix(k, idx, n);
+	free(k);
+	return e;
+}
+
+/* compare the strings of indices a and b */
+static int
+cmp(const char **s, size_t a, size_t b, int desc)
+{
+	return desc ? strcmp(s[b], s[a]) : strcmp(s[a], s[b]);
+}
+
+/* merge the sorted runs of indices v from i0 to i1 and from i1 to i2 into tmp, and copy them back */
+static void
+merge(const char **s, int desc, size_t *v, size_t *tmp, size_t i0, size_t i1, size_t i2)
+{
+	size_t i, j, o;
+
+	for (i = i0, j = i1, o = i0; i < i1 && j < i2; )
+		tmp[o++] = (cmp(s, v[j], v[i], desc) < 0) ? v[j++] : v[i++];
+	while (i < i1)
+		tmp[o++] = v[i++];
+	while (j < i2)
+		tmp[o++] = v[j++];
+	memcpy(v + i0, tmp + i0, (i2 - i0) * sizeof *v);
+}
+
+/* sort the indices v from i0 to i1 by their strings */
+static void
+msort(const char **s, int desc, size_t *v, size_t *tmp, size_t i0, size_t i1)
+{
+	size_t i, j, idx, mid;
+
+	if (i1 - i0 <= SMALL) {
+		for (i = i0 + 1; i < i1; i++) {
+			idx = v[i];
+			for (j = i; j > i0 && cmp(s, v[j - 1], idx, desc) > 0; j--)
+				v[j] = v[j - 1];
+			v[j] = idx;
+		}
+		return;
+	}
+	mid = i0 + (i1 - i0) / 2;
+	msort(s, desc, v, tmp, i0, mid);
+	msort(s, desc, v, tmp, mid, i1);
+	merge(s, desc, v, tmp, i0, mid, i1);
+}
+
+/* sort the indices of a part */
+static void
+sortpart(Part *t)
+{
+	msort(t->s, t->desc, t->v, t->vt, t->i0, t->i1);
+}
+
+/* merge two runs of indices */
+static void
+mergepart(Part *t)
+{
+	merge(t->s, t->desc, t->v, t->vt, t->i0, t->i1, t->i2);
+}
+
+/*
+ * store into idx the indices of the n strings s in increasing order,
+ * or decreasing if desc != 0; return ENOMEM if out of memory
+ */
+int
+argsortstr(const char **s, size_t *idx, size_t n, int desc)
+{
+	Part parts[MAXTHREADS];
+	size_t bound[MAXTHREADS + 1];
+	size_t *tmp, i, m, nt, step;
+
+	for (i = 0; i < n; i++)
+		idx[i] = i;
+	if ((tmp = malloc(n * sizeof *tmp + 1)) == NULL)
+		return ENOMEM;
+	nt = nthreads(n);
+	for (i = 0; i <= nt; i++)
+		bound[i] = n * i / nt;
+	for (i = 0; i < nt; i++) {
+		parts[i].f = sortpart;
+		parts[i].s = s;
+		parts[i].desc = desc;
+		parts[i].v = idx;
+		parts[i].vt = tmp;
+		parts[i].i0 = bound[i];
+		parts[i].i1 = bound[i + 1];
+	}
+	parallel(parts, nt);
+
+	/* merge neighbour runs, halving their number each round */
+	for (step = 1; step < nt; step *= 2) {
+		for (m = 0, i = 0; i + step < nt; i += 2 * step, m++) {
+			parts[m].f = mergepart;
+			parts[m].i0 = bound[i];
+			parts[m].i1 = bound[i + step];
+			parts[m].i2 = bound[MIN(i + 2 * step, nt)];
+		}
+		parallel(parts, m);
+	}
+	free(tmp);
+	return 0;
+}
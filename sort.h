@@ -0,0 +1,3 @@
+int sortnum(const double *x, double *z, size_t n, int desc);
+int argsortnum(const double *x, size_t *idx, size_t n, int desc);
+int argsortstr(const char **s, size_t *idx, size_t n, int desc);
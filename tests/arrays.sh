@@ -0,0 +1,112 @@
+#!/bin/sh
+#
+# arrays.sh: check arrays: indexing, appending, sharing, and elements.
+#
+# usage: tests/arrays.sh
+#
+# Each case runs a script with hoc and checks what it prints, errors
+# included.  Build hoc first (make hoc); `make test` does both and runs
+# this script.
+
+HOC=${HOC:-./hoc}
+TMP=${TMPDIR:-/tmp}/hoctest.$$
+FAILED=0
+
+trap 'rm -rf "$TMP"' EXIT
+trap 'exit 1' INT TERM
+
+mkdir -p "$TMP" || exit 1
+
+# check name expected hoc-arguments ...: the script is read from stdin
+check() {
+	name=$1 expected=$2
+	shift 2
+	cat >"$TMP/script.hoc" || exit 1
+	got=$("$HOC" "$@" "$TMP/script.hoc" 2>&1)
+	if [ "$got" = "$expected" ]; then
+		echo "ok   $name"
+	else
+		echo "FAIL $name: expected \"$expected\", got \"$got\""
+		FAILED=1
+	fi
+}
+
+check "zeros and append" "3 0 0 0
+5 7 8" <<-'END'
+	a = array(3)
+	print len(a), a[0], a[1], a[2]
+	a[len(a)] = 7
+	a[len(a)] = 8
+	print len(a), a[3], a[4]
+END
+
+check "empty array" "0
+1 5" <<-'END'
+	a = array()
+	print len(a)
+	a[0] = 5
+	print len(a), a[0]
+END
+
+# storing a string switches the array from doubles to elements, keeping the numbers
+check "numbers to elements" "4 1.5 x -2 0
+1.5 y -2 3
+x" <<-'END'
+	a = array(0)
+	a[0] = 1.5
+	a[1] = 2
+	a[2] = -2
+	a[3] = 0
+	a[1] = "x"
+	print len(a), a[0], a[1], a[2], a[3]
+	s = a[1]
+	a[1] = "y"
+	a[3] = a[3] + 3
+	a[len(a)] = 0
+	print a[0], a[1], a[2], a[3]
+	print s
+END
+
+check "operators on elements" "11 9 4 6" <<-'END'
+	a = array(4)
+	a[0] = 10
+	a[0]++
+	a[1] = 10
+	a[1]--
+	a[2] = 2
+	a[2] *= 2
+	a[3] = 3
+	a[3] += a[3]
+	print a[0], a[1], a[2], a[3]
+END
+
+# assignment and calls share arrays, and never copy them
+check "references" "9 9
+42 42 4" <<-'END'
+	a = array(3)
+	b = a
+	b[0] = 9
+	print a[0], b[0]
+	func set(x) {
+		x[1] = 42
+		x[len(x)] = 0
+		return x
+	}
+	c = set(a)
+	print a[1], c[1], len(b)
+END
+
+check "index out of bounds" "hoc: line 2: a[3]: index out of bounds
+hoc: line 3: a[-1]: index out of bounds
+hoc: line 4: a[5]: index out of bounds" <<-'END'
+	a = array(3)
+	print a[3]
+	print a[-1]
+	a[5] = 1
+END
+
+check "length of strings" "5 0" <<-'END'
+	print len("hello"), len("")
+END
+
+exit $FAILED
@@ -0,0 +1,60 @@
+#!/bin/sh
+#
+# image.sh: check that program images and the cache run the program
+# hoc would compile.
+#
+# usage: tests/image.sh
+#
+# Each case runs a script with -s, once as a script and once through an
+# image or the cache, and checks that both print the same and execute
+# the same number of instructions, so an image compiled with other
+# options is not taken for this one.  Build hoc first (make hoc);
+# `make test` does both and runs this script.
+
+HOC=${HOC:-./hoc}
+TMP=${TMPDIR:-/tmp}/hoctest.$$
+FAILED=0
+
+trap 'rm -rf "$TMP"' EXIT
+trap 'exit 1' INT TERM
+
+mkdir -p "$TMP" || exit 1
+
+cat >"$TMP/script.hoc" <<-'END'
+	func sq(x) {
+		return x * x
+	}
+	s = 0
+	for (i = 0; i < 1000; i++)
+		s = s + sq(i) + 3 * 4
+	print s, "\n"
+END
+
+# run hoc-arguments ...: print the output and the instructions executed
+run() {
+	"$HOC" -s "$@" 2>&1 | grep -v '^[a-z ]*:'
+	"$HOC" -s "$@" 2>&1 >/dev/null | grep '^instructions executed:'
+}
+
+# check name expected got
+check() {
+	if [ "$3" = "$2" ]; then
+		echo "ok   $1"
+	else
+		echo "FAIL $1: expected \"$2\", got \"$3\""
+		FAILED=1
+	fi
+}
+
+for opts in "" "-O"; do
+	expected=$(run $opts "$TMP/script.hoc")
+	"$HOC" $opts -c -o "$TMP/script.hocb" "$TMP/script.hoc" || FAILED=1
+	check "image $opts" "$expected" "$(run "$TMP/script.hocb")"
+done
+
+# the cache keeps a program for each set of options, and each run takes its own
+for opts in "" "-O" "" "-O"; do
+	check "cache $opts" "$(run $opts "$TMP/script.hoc")" "$(run $opts -C "$TMP/cache" "$TMP/script.hoc")"
+done
+
+exit $FAILED
@@ -0,0 +1,105 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include "../libhoc.h"
+
+/*
+ * Check the interface of libhoc: running programs, calling their
+ * functions, reading their variables and errors, and interpreters
+ * kept apart, in one thread and in several at once.  Each check
+ * prints ok or FAIL, as the scripts of tests/ do, and the exit status
+ * is 1 if any failed.  `make test` builds it and runs it.
+ */
+
+#define NTHREADS 4
+
+static int failed = 0;
+
+/* report check name, which passed if ok */
+static void
+check(const char *name, int ok)
+{
+	if (ok)
+		printf("ok   %s\n", name);
+	else {
+		printf("FAIL %s\n", name);
+		failed = 1;
+	}
+}
+
+/* sum 1 to the number at arg in an interpreter of its own, and store the sum, or -1, at arg */
+static void *
+sumthread(void *arg)
+{
+	static const char src[] =
+		"func f(n, i, s) { s = 0; for (i = 1; i <= n; i++) s += i; return s }\n";
+	double n, v;
+	Hoc *h;
+
+	n = *(double *)arg;
+	if ((h = hocnew(0, NULL)) == NULL)
+		return NULL;
+	if (hocrun(h, src) != 0 || hoccall(h, "f", &n, 1, &v) != 0)
+		v = -1;
+	hocfree(h);
+	*(double *)arg = v;
+	return arg;
+}
+
+int
+main(void)
+{
+	double args[2], v, w, n[NTHREADS];
+	pthread_t t[NTHREADS];
+	const char *s;
+	Hoc *h, *h2;
+	int i, ok;
+
+	if ((h = hocnew(0, NULL)) == NULL || (h2 = hocnew(0, NULL)) == NULL) {
+		printf("FAIL hocnew\n");
+		return 1;
+	}
+
+	check("hocrun", hocrun(h, "x = 6 * 7\ns = sprintf(\"%s%d\", \"string\", 2)\nfunc plus(a, b) { return a + b }\n") == 0);
+	check("hocgetnum", hocgetnum(h, "x", &v) == 0 && v == 42);
+	check("hocgetstr", (s = hocgetstr(h, "s")) != NULL && strcmp(s, "string2") == 0);
+	check("hocgetnum of a string", hocgetnum(h, "s", &v) == -1);
+	check("hocgetstr of a number", hocgetstr(h, "x") == NULL);
+	check("undefined variables", hocgetnum(h, "nosuch", &v) == -1 && hocgetstr(h, "nosuch") == NULL);
+
+	args[0] = 2.5;
+	args[1] = 4;
+	check("hoccall", hoccall(h, "plus", args, 2, &v) == 0 && v == 6.5);
+	check("hoccall of an unknown function", hoccall(h, "nosuch", args, 2, &v) == -1 &&
+	    strstr(hocerror(h), "nosuch") != NULL);
+
+	/* the program goes on after an error, as hoc -w does */
+	ok = hocrun(h, "y = 1\nz = 1 / 0\nw = 2\n") == -1;
+	check("hocrun of an error", ok && strstr(hocerror(h), "division by zero") != NULL &&
+	    hocgetnum(h, "y", &v) == 0 && v == 1 && hocgetnum(h, "w", &w) == 0 && w == 2);
+	check("hocrun after an error", hocrun(h, "x = x + 1\n") == 0 && hocgetnum(h, "x", &v) == 0 && v == 43);
+	check("syntax error", hocrun(h, "x = (\n") == -1 && hocerror(h)[0] != '\0');
+
+	check("separate interpreters", hocrun(h2, "x = 1\n") == 0 && hocgetnum(h2, "x", &v) == 0 && v == 1 &&
+	    hocgetnum(h, "x", &w) == 0 && w == 43 && hocgetstr(h2, "s") == NULL);
+	hocfree(h2);
+	check("hocfree of another", hocgetnum(h, "x", &v) == 0 && v == 43);
+	hocfree(h);
+
+	for (i = 0; i < NTHREADS; i++) {
+		n[i] = 100000 * (i + 1);
+		if (pthread_create(&t[i], NULL, sumthread, &n[i]) != 0)
+			n[i] = -1;
+	}
+	ok = 1;
+	for (i = 0; i < NTHREADS; i++) {
+		if (n[i] != -1)
+			pthread_join(t[i], NULL);
+		v = 100000.0 * (i + 1);
+		if (n[i] != v * (v + 1) / 2)
+			ok = 0;
+	}
+	check("interpreters in threads", ok);
+
+	return failed;
+}
@@ -0,0 +1,59 @@
+#!/bin/sh
+#
+# lines.sh: check the lines of runtime errors.
+#
+# usage: tests/lines.sh
+#
+# Each case runs a script with hoc and some options, and checks that
+# its error is reported at the line of the code that failed, whether
+# the code is run as written or was inlined or hoisted by -O.  Build
+# hoc first (make hoc); `make test` does both and runs this script.
+
+HOC=${HOC:-./hoc}
+TMP=${TMPDIR:-/tmp}/hoctest.$$
+FAILED=0
+
+trap 'rm -rf "$TMP"' EXIT
+trap 'exit 1' INT TERM
+
+mkdir -p "$TMP" || exit 1
+
+# check name expected hoc-arguments ...: the script is read from stdin
+check() {
+	name=$1 expected=$2
+	shift 2
+	cat >"$TMP/script.hoc" || exit 1
+	got=$("$HOC" "$@" "$TMP/script.hoc" 2>&1 >/dev/null)
+	if [ "$got" = "$expected" ]; then
+		echo "ok   $name"
+	else
+		echo "FAIL $name: expected \"$expected\", got \"$got\""
+		FAILED=1
+	fi
+}
+
+# an error in a function reports its line, also when the call is inlined
+for opts in "" "-O" "-O -w"; do
+	check "inlined call $opts" "hoc: line 2: division by zero" $opts <<-'END'
+	func f(x) {
+		return 1 / x
+	}
+
+
+	print f(0)
+	END
+done
+
+# an error in a loop reports its line, also when the expression is hoisted
+for opts in "" "-O" "-O -w"; do
+	check "hoisted expression $opts" "hoc: line 5: division by zero" $opts <<-'END'
+	z = 0
+	s = 0
+
+	for (i = 0; i < 3; i++) {
+		s = s + 1 / z
+	}
+	END
+done
+
+exit $FAILED
@@ -0,0 +1,108 @@
+#!/bin/sh
+#
+# maps.sh: check maps: number and string keys, long keys, and order.
+#
+# usage: tests/maps.sh
+#
+# Each case runs a script with hoc and checks what it prints, errors
+# included.  map.c holds numbers and strings of up to 15 bytes in the
+# key itself and longer strings as references, so keys around that
+# length are checked.  Build hoc first (make hoc); `make test` does
+# both and runs this script.
+
+HOC=${HOC:-./hoc}
+TMP=${TMPDIR:-/tmp}/hoctest.$$
+FAILED=0
+
+trap 'rm -rf "$TMP"' EXIT
+trap 'exit 1' INT TERM
+
+mkdir -p "$TMP" || exit 1
+
+# check name expected hoc-arguments ...: the script is read from stdin
+check() {
+	name=$1 expected=$2
+	shift 2
+	cat >"$TMP/script.hoc" || exit 1
+	got=$("$HOC" "$@" "$TMP/script.hoc" 2>&1)
+	if [ "$got" = "$expected" ]; then
+		echo "ok   $name"
+	else
+		echo "FAIL $name: expected \"$expected\", got \"$got\""
+		FAILED=1
+	fi
+}
+
+# a number key is never equal to a string key; -0 is the key 0
+check "number and string keys" "4 one string one 3 zero
+1 1 0 0 1 1
+0 4" <<-'END'
+	m = map()
+	m[1] = "one"
+	m["1"] = "string one"
+	m[1.5] = 3
+	m[-0] = "zero"
+	print len(m), m[1], m["1"], m[1.5], m[0]
+	print 1 in m, "1" in m, 2 in m, "2" in m, 0 in m, -0 in m
+	print m[2], len(m)
+END
+
+check "long keys" "15 16 40 16
+0 0 3" <<-'END'
+	m = map()
+	k15 = "abcdefghijklmno"
+	k16 = "abcdefghijklmnop"
+	long = "a key that is longer than fifteen bytes"
+	m[k15] = 15
+	m[k16] = 16
+	m[long] = 40
+	print m[k15], m[k16], m[long], m["abcdefghijklmnop"]
+	print "abcdefghijklmnoq" in m, "abcdefghijklmn" in m, len(m)
+END
+
+# the map holds a reference to a long key, which outlives its variable
+check "long keys outlive their strings" "a key that is longer than fifteen bytes 1
+1" <<-'END'
+	m = map()
+	long = "a key that is longer than fifteen bytes"
+	m[long] = 1
+	long = 0
+	for (k in m) print k, m[k]
+	print "a key that is longer than fifteen bytes" in m
+END
+
+check "order and overwriting" "b 2
+1 uno
+c 3
+3 6" <<-'END'
+	m = map()
+	m["b"] = 2
+	m[1] = "one"
+	m["c"] = 3
+	m[1] = "uno"
+	for (k in m) print k, m[k]
+	m[1] = 1
+	print len(m), sum(m)
+END
+
+check "growth" "0 100000 1 0 0" <<-'END'
+	m = map()
+	for (i = 0; i < 100000; i++) m[i * 7] = i
+	for (i = 0; i < 50000; i++) m[sprintf("key %d", i)] = i
+	bad = 0
+	for (i = 0; i < 100000; i++) if (m[i * 7] != i) bad++
+	for (i = 0; i < 50000; i++) if (m[sprintf("key %d", i)] != i) bad++
+	n = 0
+	for (k in m) n++
+	print bad, n - 50000, 699993 in m, 699994 in m, "key 50000" in m
+END
+
+check "printing" "1: 2
+x: y" <<-'END'
+	m = map()
+	m[1] = 2
+	m["x"] = "y"
+	print m
+END
+
+exit $FAILED
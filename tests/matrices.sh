@@ -0,0 +1,135 @@
+#!/bin/sh
+#
+# matrices.sh: check matrices: indexing, products, transposes and solve().
+#
+# usage: tests/matrices.sh
+#
+# Each case runs a script with hoc and checks what it prints, errors
+# included.  mat.c computes products by blocks and tiles, and splits
+# big ones between threads, but sums each element in the order of the
+# plain triple loop (and each element of a matrix-vector product as
+# dot() does), so they are checked for equality against loops, with
+# sizes that are not multiples of the tiles and blocks.  Build hoc
+# first (make hoc); `make test` does both and runs this script.
+
+HOC=${HOC:-./hoc}
+TMP=${TMPDIR:-/tmp}/hoctest.$$
+FAILED=0
+
+trap 'rm -rf "$TMP"' EXIT
+trap 'exit 1' INT TERM
+
+mkdir -p "$TMP" || exit 1
+
+# check name expected hoc-arguments ...: the script is read from stdin
+check() {
+	name=$1 expected=$2
+	shift 2
+	cat >"$TMP/script.hoc" || exit 1
+	got=$("$HOC" "$@" "$TMP/script.hoc" 2>&1)
+	if [ "$got" = "$expected" ]; then
+		echo "ok   $name"
+	else
+		echo "FAIL $name: expected \"$expected\", got \"$got\""
+		FAILED=1
+	fi
+}
+
+check "indexing" "6 6 6 21
+6 4
+14 32
+32 77
+6 15" <<-'END'
+	m = matrix(2, 3)
+	for (i = 0; i < 2; i++) for (j = 0; j < 3; j++) m[i, j] = i * 3 + j + 1
+	print len(m), m[1, 2], m[5], sum(m)
+	t = transpose(m)
+	print t[2, 1], t[0, 1]
+	print matmul(m, t)
+	v = array(3)
+	v[0] = v[1] = v[2] = 1
+	print matvec(m, v)
+END
+
+check "product" "0 0" -O <<-'END'
+	r = 70
+	k = 300
+	c = 101
+	a = matrix(r, k)
+	b = matrix(k, c)
+	for (i = 0; i < r; i++) for (j = 0; j < k; j++) a[i, j] = sin(i * 7 + j) / 3
+	for (i = 0; i < k; i++) for (j = 0; j < c; j++) b[i, j] = cos(i * 5 - j) * 1.7
+	p = matmul(a, b)
+	bad = 0
+	for (i = 0; i < r; i++) for (j = 0; j < c; j++) {
+		s = 0
+		for (l = 0; l < k; l++) s += a[i, l] * b[l, j]
+		if (s != p[i, j]) bad++
+	}
+	x = array(k)
+	for (l = 0; l < k; l++) x[l] = l % 11 - 5.5
+	y = matvec(a, x)
+	bad2 = 0
+	row = array(k)
+	for (i = 0; i < r; i++) {
+		for (l = 0; l < k; l++) row[l] = a[i, l]
+		if (dot(row, x) != y[i]) bad2++
+	}
+	print bad, bad2
+END
+
+check "transpose" "0" <<-'END'
+	r = 45
+	c = 70
+	a = matrix(r, c)
+	for (i = 0; i < r; i++) for (j = 0; j < c; j++) a[i, j] = i * 1000 + j
+	t = transpose(a)
+	bad = 0
+	for (i = 0; i < r; i++) for (j = 0; j < c; j++) if (t[j, i] != a[i, j]) bad++
+	print bad
+END
+
+# solve() works on a copy, and pivots
+check "solve" "0.8 1.4
+2
+5 3
+1" <<-'END'
+	a = matrix(2, 2)
+	a[0, 0] = 2
+	a[0, 1] = 1
+	a[1, 0] = 1
+	a[1, 1] = 3
+	b = array(2)
+	b[0] = 3
+	b[1] = 5
+	print solve(a, b)
+	print a[0, 0]
+	p = matrix(2, 2)
+	p[0, 1] = 1
+	p[1, 0] = 1
+	print solve(p, b)
+	n = 30
+	m = matrix(n, n)
+	for (i = 0; i < n; i++) for (j = 0; j < n; j++) m[i, j] = 1 / (1 + abs(i - j)) + (i == j) * n
+	x = array(n)
+	for (i = 0; i < n; i++) x[i] = i - 7
+	y = solve(m, matvec(m, x))
+	bad = 0
+	for (i = 0; i < n; i++) if (abs(y[i] - x[i]) > 1e-12) bad++
+	print bad == 0
+END
+
+check "errors" "hoc: line 3: matmul: 2x2 and 3x1 matrices
+hoc: line 4: solve: singular matrix
+hoc: line 6: a is not a matrix
+hoc: line 7: m[0, 2]: index out of bounds" <<-'END'
+	m = matrix(2, 2)
+	b = array(2)
+	print matmul(m, matrix(3, 1))
+	print solve(m, b)
+	a = array(4)
+	print a[0, 0]
+	print m[0, 2]
+END
+
+exit $FAILED
@@ -0,0 +1,101 @@
+#!/bin/sh
+#
+# parallel.sh: check that parallel for loops give the same results on
+# any number of threads.
+#
+# usage: tests/parallel.sh
+#
+# Each case runs a script with hoc and checks what it prints, errors
+# included.  The loops are run with -j1, which runs them on a single
+# thread, and with more threads, which split the iterations between
+# them; the reductions add integers, so their results are exact in any
+# order.  Build hoc first (make hoc); `make test` does both and runs
+# this script.
+
+HOC=${HOC:-./hoc}
+TMP=${TMPDIR:-/tmp}/hoctest.$$
+FAILED=0
+
+trap 'rm -rf "$TMP"' EXIT
+trap 'exit 1' INT TERM
+
+mkdir -p "$TMP" || exit 1
+
+# check name expected hoc-arguments ...: the script is read from stdin
+check() {
+	name=$1 expected=$2
+	shift 2
+	cat >"$TMP/script.hoc" || exit 1
+	got=$("$HOC" "$@" "$TMP/script.hoc" 2>&1)
+	if [ "$got" = "$expected" ]; then
+		echo "ok   $name"
+	else
+		echo "FAIL $name: expected \"$expected\", got \"$got\""
+		FAILED=1
+	fi
+}
+
+# lengths below, at and above the number of threads
+cat >"$TMP/loops.hoc" <<-'END'
+	func f(x, t) {
+		t = x * x
+		return t % 7
+	}
+	proc run(n, y, s, lo, hi, c, i, k) {
+		y = array(n)
+		s = 0
+		lo = 0
+		hi = 0
+		parallel for (i = 0; i < n; i++; y[], sum(s), min(lo), max(hi)) {
+			k = f(i) - 3
+			y[i] = k
+			s += i * 2 + 1
+			if (k < lo) lo = k
+			if (i / 2 > hi) hi = i / 2
+		}
+		c = 0
+		for (k = 0; k < n; k++) c += y[k] * (k % 5)
+		print n, i, s == n * n, lo, hi, c
+	}
+	run(0)
+	run(1)
+	run(7)
+	run(1000)
+	run(100001)
+	i = 5
+	parallel for (i = 3; i <= 9; i++; sum(s)) s += i
+	print i, s
+END
+for j in 1 2 4 8; do
+	check "loops -j$j" "0 0 1 0 0 0
+1 1 1 -3 0 0
+7 7 1 -3 3 -9
+1000 1000 1 -3 499.5 -1994
+100001 100001 1 -3 50000 -199997
+10 42" -j$j <"$TMP/loops.hoc"
+done
+
+# each error stops its loop, and is reported once
+cat >"$TMP/errors.hoc" <<-'END'
+	g = 0
+	func bad(x) {
+		g = x
+		return x
+	}
+	a = array(100)
+	parallel for (i = 0; i < 100; i++; a[]) a[i] = bad(i)
+	parallel for (i = 0; i < 100; i++; a[]) a[i] = 1 / (i - 50)
+	b = array(10)
+	parallel for (i = 0; i < 2; i++; b[]) b[i * 20] = 1
+	parallel for (i = 0; i < 10; i++; b[]) b[i] = "s"
+	print "done"
+END
+for j in 1 4; do
+	check "errors -j$j" "hoc: line 3: g: parallel code assigns a global variable
+hoc: line 8: division by zero
+hoc: line 10: b[20]: index out of bounds
+hoc: line 11: b: parallel loop output holds only numbers
+done" -j$j <"$TMP/errors.hoc"
+done
+
+exit $FAILED
@@ -0,0 +1,39 @@
+#!/bin/sh
+#
+# scan.sh: check that the scanner takes the tokens lex.l takes.
+#
+# usage: tests/scan.sh
+#
+# Each case feeds hoc a script, written with printf(1) so it may hold
+# any byte, and checks the first line of its output and errors, as the
+# errors that follow depend on how the parser recovers.  Build hoc first
+# (make hoc); `make test` does both and runs this script.
+
+HOC=${HOC:-./hoc}
+TMP=${TMPDIR:-/tmp}/hoctest.$$
+FAILED=0
+
+trap 'rm -rf "$TMP"' EXIT
+trap 'exit 1' INT TERM
+
+mkdir -p "$TMP" || exit 1
+
+# check name expected printf-format: the script is made by printf
+check() {
+	name=$1 expected=$2
+	printf "$3" >"$TMP/script.hoc" || exit 1
+	got=$("$HOC" "$TMP/script.hoc" 2>&1 | head -n 1)
+	if [ "$got" = "$expected" ]; then
+		echo "ok   $name"
+	else
+		echo "FAIL $name: expected \"$expected\", got \"$got\""
+		FAILED=1
+	fi
+}
+
+check "escapes" "$(printf 'a\tb"?\\')" 'print "a\\tb\\"\\?\\\\"\n'
+check "unknown escape" "hoc: line 1: syntax error" 'print "a\\qb"\n'
+check "escaped NUL byte" "hoc: line 1: syntax error" 'print "a\\\000b"\n'
+check "unterminated string" "hoc: line 1: syntax error" 'print "ab\n'
+
+exit $FAILED
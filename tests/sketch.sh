@@ -0,0 +1,100 @@
+#!/bin/sh
+#
+# sketch.sh: check the Welford, histogram and KLL sketches.
+#
+# usage: tests/sketch.sh
+#
+# Each case runs a script with hoc and checks what it prints, errors
+# included.  KLL sketches compact their samples by coin tosses, so their
+# quantiles are checked against the bound on their rank error.  Build
+# hoc first (make hoc); `make test` does both and runs this script.
+
+HOC=${HOC:-./hoc}
+TMP=${TMPDIR:-/tmp}/hoctest.$$
+FAILED=0
+
+trap 'rm -rf "$TMP"' EXIT
+trap 'exit 1' INT TERM
+
+mkdir -p "$TMP" || exit 1
+
+# check name expected hoc-arguments ...: the script is read from stdin
+check() {
+	name=$1 expected=$2
+	shift 2
+	cat >"$TMP/script.hoc" || exit 1
+	got=$("$HOC" "$@" "$TMP/script.hoc" 2>&1)
+	if [ "$got" = "$expected" ]; then
+		echo "ok   $name"
+	else
+		echo "FAIL $name: expected \"$expected\", got \"$got\""
+		FAILED=1
+	fi
+}
+
+check "welford" "100 50.5 1 100 841.66667
+30
+200 50.5 837.43719" <<-'END'
+	w = welford()
+	for (i = 1; i <= 100; i++) w = add(w, i)
+	print len(w), mean(w), min(w), max(w), variance(w)
+	v = welford()
+	a = array(0)
+	a[0] = 1e9 + 4
+	a[1] = 1e9 + 7
+	a[2] = 1e9 + 13
+	a[3] = 1e9 + 16
+	v = add(v, a)
+	print variance(v)
+	u = welford()
+	for (i = 100; i >= 1; i--) u = add(u, i)
+	w = merge(w, u)
+	print len(w), mean(w), variance(w)
+END
+
+# values out of range count, but fall in no bin
+check "histogram" "12 2 2 2 2 2
+5 1 9.8" <<-'END'
+	h = histogram(0, 10, 5)
+	for (i = 0; i < 10; i++) h = add(h, i + 0.5)
+	h = add(h, -1)
+	h = add(h, 10)
+	b = bins(h)
+	print len(h), b[0], b[1], b[2], b[3], b[4]
+	q = array(0)
+	q[0] = 0.1
+	q[1] = 0.9
+	r = quantile(h, q)
+	print quantile(h, 0.5), r[0] >= 0 && r[0] <= 2, r[1]
+END
+
+check "kll" "100000 0
+200000 0 1 200000" <<-'END'
+	k = kll()
+	for (i = 1; i <= 100000; i++) k = add(k, i)
+	bad = 0
+	for (q = 0.05; q < 1; q += 0.05) if (abs(quantile(k, q) - q * 100000) > 3000) bad++
+	print len(k), bad
+	k2 = kll()
+	a = array(0)
+	for (i = 100001; i <= 200000; i++) a[len(a)] = i
+	k2 = add(k2, a)
+	k = merge(k, k2)
+	bad = 0
+	for (q = 0.05; q < 1; q += 0.05) if (abs(quantile(k, q) - q * 200000) > 6000) bad++
+	print len(k), bad, min(k), max(k)
+END
+
+check "errors" "hoc: line 3: merge: sketches of different kinds or ranges
+hoc: line 4: histogram: invalid bins 0
+hoc: line 5: quantile: empty sketch
+hoc: line 6: mean: empty sketch" <<-'END'
+	w = welford()
+	k = kll()
+	w = merge(w, k)
+	h = histogram(0, 1, 0)
+	print quantile(k, 0.5)
+	print mean(w)
+END
+
+exit $FAILED
@@ -0,0 +1,153 @@
+#!/bin/sh
+#
+# sort.sh: check sort(), sortdesc() and argsort().
+#
+# usage: tests/sort.sh
+#
+# Each case runs a script with hoc and checks what it prints, errors
+# included.  sort.c sorts small arrays by insertion and bigger ones by
+# a radix sort split between threads, so both are checked for the same
+# order: stable, NaNs last, and -0 equal to 0.  Build hoc first (make
+# hoc); `make test` does both and runs this script.
+
+HOC=${HOC:-./hoc}
+TMP=${TMPDIR:-/tmp}/hoctest.$$
+FAILED=0
+
+trap 'rm -rf "$TMP"' EXIT
+trap 'exit 1' INT TERM
+
+mkdir -p "$TMP" || exit 1
+
+# check name expected hoc-arguments ...: the script is read from stdin
+check() {
+	name=$1 expected=$2
+	shift 2
+	cat >"$TMP/script.hoc" || exit 1
+	got=$("$HOC" "$@" "$TMP/script.hoc" 2>&1)
+	if [ "$got" = "$expected" ]; then
+		echo "ok   $name"
+	else
+		echo "FAIL $name: expected \"$expected\", got \"$got\""
+		FAILED=1
+	fi
+}
+
+check "special numbers" "6 4 1 2 0 8 5 3 7
+-inf -1 -0 0 3 3 inf 1 1
+inf 3 3 -0 0 -1 -inf 1 1" <<-'END'
+	inf = 1e308 * 10
+	nan = inf - inf
+	a = array(0)
+	a[0] = 3
+	a[1] = -0
+	a[2] = 0
+	a[3] = nan
+	a[4] = -1
+	a[5] = inf
+	a[6] = -inf
+	a[7] = nan
+	a[8] = 3
+	print argsort(a)
+	s = sort(a)
+	print s[0], s[1], s[2], s[3], s[4], s[5], s[6], s[7] != s[7], s[8] != s[8]
+	d = sortdesc(a)
+	print d[0], d[1], d[2], d[3], d[4], d[5], d[6], d[7] != d[7], d[8] != d[8]
+END
+
+# in order, stable, and a permutation, with NaNs last and -0 equal to 0
+check "stable order" "0 0 0 0" <<-'END'
+	inf = 1e308 * 10
+	nan = inf - inf
+	func isnan(x) {
+		return x != x
+	}
+	func checkorder(a, p, seen, i, x, y, bad) {
+		seen = array(len(a))
+		bad = 0
+		if (len(p) != len(a)) bad++
+		for (i = 0; i < len(p); i++) {
+			if (seen[p[i]]) bad++
+			seen[p[i]] = 1
+		}
+		for (i = 0; i + 1 < len(p); i++) {
+			x = a[p[i]]
+			y = a[p[i + 1]]
+			if (isnan(x) && !isnan(y)) bad++
+			if (!isnan(x) && !isnan(y) && x > y) bad++
+			if ((x == y || isnan(x) && isnan(y)) && p[i] > p[i + 1]) bad++
+		}
+		return bad
+	}
+	func make(n, a, i) {
+		a = array(n)
+		for (i = 0; i < n; i++) {
+			a[i] = ((i * 7919) % 2003 - 1000) / 8
+			if (i % 97 == 0) a[i] = nan
+			if (i % 89 == 0) a[i] = -0
+			if (i % 101 == 0) a[i] = inf
+			if (i % 103 == 0) a[i] = -inf
+		}
+		return a
+	}
+	a = make(30)
+	b = make(1000)
+	c = make(200000)
+	print checkorder(a, argsort(a)), checkorder(b, argsort(b)), checkorder(c, argsort(c)), len(sort(c)) - len(c)
+END
+
+# sort() gives the elements argsort() orders, and sortdesc() their reverse but for NaNs and ties
+check "sort and sortdesc" "0 0" <<-'END'
+	a = array(100000)
+	for (i = 0; i < len(a); i++) a[i] = (i * 7919) % 100003 - 50000.5
+	s = sort(a)
+	d = sortdesc(a)
+	p = argsort(a)
+	bad = 0
+	for (i = 0; i < len(a); i++) if (s[i] != a[p[i]]) bad++
+	bad2 = 0
+	for (i = 0; i < len(a); i++) if (d[i] != s[len(a) - 1 - i]) bad2++
+	print bad, bad2
+END
+
+check "strings" "4 1 3 2 0
+Zoo apple apple fig pear
+pear fig apple apple Zoo" <<-'END'
+	b = array(0)
+	b[0] = "pear"
+	b[1] = "apple"
+	b[2] = "fig"
+	b[3] = "apple"
+	b[4] = "Zoo"
+	print argsort(b)
+	print sort(b)
+	print sortdesc(b)
+END
+
+# strings are merge sorted by threads; their keys here sort as v does
+check "many strings" "0" <<-'END'
+	n = 100000
+	a = array(n)
+	v = array(n)
+	for (i = 0; i < n; i++) {
+		v[i] = (i * 31) % 5000
+		a[i] = sprintf("k%05d", v[i])
+	}
+	p = argsort(a)
+	bad = 0
+	for (i = 0; i + 1 < n; i++) {
+		if (v[p[i]] > v[p[i + 1]]) bad++
+		if (v[p[i]] == v[p[i + 1]] && p[i] > p[i + 1]) bad++
+	}
+	print bad
+END
+
+check "empty and single" "0 0 0
+5" <<-'END'
+	a = array(0)
+	print len(sort(a)), len(sortdesc(a)), len(argsort(a))
+	a[0] = 5
+	print sort(a)
+END
+
+exit $FAILED
@@ -0,0 +1,114 @@
+#!/bin/sh
+#
+# tasks.sh: check spawn and wait().
+#
+# usage: tests/tasks.sh
+#
+# Each case runs a script with hoc and checks what it prints, errors
+# included.  Tasks run on the threads of the pool, or at once with -j1,
+# so the cases that wait for their values are run both ways.  Build hoc
+# first (make hoc); `make test` does both and runs this script.
+
+HOC=${HOC:-./hoc}
+TMP=${TMPDIR:-/tmp}/hoctest.$$
+FAILED=0
+
+trap 'rm -rf "$TMP"' EXIT
+trap 'exit 1' INT TERM
+
+mkdir -p "$TMP" || exit 1
+
+# check name expected hoc-arguments ...: the script is read from stdin
+check() {
+	name=$1 expected=$2
+	shift 2
+	cat >"$TMP/script.hoc" || exit 1
+	got=$("$HOC" "$@" "$TMP/script.hoc" 2>&1)
+	if [ "$got" = "$expected" ]; then
+		echo "ok   $name"
+	else
+		echo "FAIL $name: expected \"$expected\", got \"$got\""
+		FAILED=1
+	fi
+}
+
+# a task sees the globals as they were when it was spawned
+cat >"$TMP/values.hoc" <<-'END'
+	func sq(x) { return x * x }
+	func name(x) { return sprintf("task %d", x) }
+	func squares(n, a, i) {
+		a = array(n)
+		for (i = 0; i < n; i++) a[i] = i * i
+		return a
+	}
+	g = 3
+	func useg(x) { return g * x }
+	h1 = spawn sq(7)
+	h2 = spawn name(2)
+	h3 = spawn squares(5)
+	h4 = spawn useg(2)
+	g = 100
+	print wait(h4), wait(h2), wait(h1)
+	print wait(h3)
+	h = array(200)
+	for (i = 0; i < 200; i++) h[i] = spawn sq(i)
+	s = 0
+	for (i = 199; i >= 0; i--) s += wait(h[i])
+	print s
+END
+for j in 1 4; do
+	check "values -j$j" "6 task 2 49
+0 1 4 9 16
+2646700" -j$j <"$TMP/values.hoc"
+done
+
+# a handle is never reused, so a second wait fails even after more
+# spawns; errors go to the standard error at once, and prints are
+# buffered until exit
+check "double wait" "hoc: line 4: wait: 1 is no task
+hoc: line 6: wait: 1 is no task
+10
+2 20" <<-'END'
+	func f(x) { return x * 10 }
+	h1 = spawn f(1)
+	print wait(h1)
+	print wait(h1)
+	h2 = spawn f(2)
+	print wait(h1)
+	print h2, wait(h2)
+END
+
+check "bad handles" "hoc: line 3: wait: 0 is no task
+hoc: line 4: wait: 2 is no task
+hoc: line 5: wait: 1.5 is no task
+hoc: line 6: wait: -1 is no task
+10" <<-'END'
+	func f(x) { return x * 10 }
+	h = spawn f(1)
+	print wait(0)
+	print wait(2)
+	print wait(1.5)
+	print wait(-1)
+	print wait(h)
+END
+
+# an error of a task is reported by wait(), with the line where it failed
+check "errors" "hoc: line 3: division by zero
+hoc: line 10: wait: 1 is no task
+hoc: line 7: g: parallel code assigns a global variable
+next" <<-'END'
+	func fail(x) {
+		if (x > 2)
+			return 1 / 0
+		return x
+	}
+	g = 0
+	func setg(x) { g = x; return x }
+	h = spawn fail(5)
+	print wait(h)
+	print wait(h)
+	print wait(spawn setg(1))
+	print "next"
+END
+
+exit $FAILED
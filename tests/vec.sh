@@ -0,0 +1,154 @@
+#!/bin/sh
+#
+# vec.sh: check the built-in functions on whole arrays.
+#
+# usage: tests/vec.sh
+#
+# Each case runs a script with hoc and checks what it prints, errors
+# included.  The kernels of vec.c handle arrays in blocks, so lengths
+# around the block sizes are checked against plain loops.  Build hoc
+# first (make hoc); `make test` does both and runs this script.
+
+HOC=${HOC:-./hoc}
+TMP=${TMPDIR:-/tmp}/hoctest.$$
+FAILED=0
+
+trap 'rm -rf "$TMP"' EXIT
+trap 'exit 1' INT TERM
+
+mkdir -p "$TMP" || exit 1
+
+# check name expected hoc-arguments ...: the script is read from stdin
+check() {
+	name=$1 expected=$2
+	shift 2
+	cat >"$TMP/script.hoc" || exit 1
+	got=$("$HOC" "$@" "$TMP/script.hoc" 2>&1)
+	if [ "$got" = "$expected" ]; then
+		echo "ok   $name"
+	else
+		echo "FAIL $name: expected \"$expected\", got \"$got\""
+		FAILED=1
+	fi
+}
+
+check "reductions" "55 5.5 1 10 385
+5 1 2 10 0 9" <<-'END'
+	a = array(0)
+	for (i = 1; i <= 10; i++) a[len(a)] = i
+	print sum(a), mean(a), min(a), max(a), dot(a, a)
+	print count(a, ">", 5), count(a, "==", 3), count(a, "<=", 2), count(a, ">=", 1), count(a, "<", 1), count(a, "!=", 4)
+END
+
+check "elementwise" "10 1 55
+20 100 5 10
+4 40 20" <<-'END'
+	a = array(0)
+	for (i = 1; i <= 10; i++) a[len(a)] = i
+	c = cumsum(a)
+	print len(c), c[0], c[9]
+	v = vadd(a, a)
+	w = vmul(a, a)
+	s = vscale(a, 0.5)
+	print v[9], w[9], s[9], a[9]
+	r = axpy(2, a, v)
+	print r[0], r[9], v[4]
+END
+
+# every length up to a few blocks, with the extremes at the last element
+check "lengths" "0" <<-'END'
+	bad = 0
+	for (n = 1; n <= 40; n++) {
+		a = array(0)
+		for (i = 1; i <= n; i++) a[len(a)] = i
+		a[n - 1] = -n
+		s = 0
+		for (i = 0; i < n; i++) s += a[i]
+		d = 0
+		for (i = 0; i < n; i++) d += a[i] * a[i]
+		if (sum(a) != s || dot(a, a) != d || min(a) != -n) bad++
+		if (n > 1 && max(a) != n - 1) bad++
+		c = cumsum(a)
+		if (count(a, "<", 0) != 1 || c[n - 1] != s) bad++
+		v = vadd(a, vscale(a, -1))
+		if (min(v) != 0 || max(v) != 0) bad++
+	}
+	print bad
+END
+
+check "empty arrays" "0 0 0" <<-'END'
+	a = array(0)
+	print sum(a), len(cumsum(a)), len(vadd(a, a))
+END
+
+check "errors" "hoc: line 3: dot: arrays of different lengths
+hoc: line 4: vadd: arrays of different lengths
+hoc: line 5: count: unknown comparison
+hoc: line 6: max: empty array
+hoc: line 8: sum: array holds strings" <<-'END'
+	a = array(2)
+	b = array(3)
+	print dot(a, b)
+	print vadd(a, b)
+	print count(a, "~", 1)
+	print max(array(0))
+	a[0] = "s"
+	print sum(a)
+END
+
+# the functions of one argument on arrays give a new array, as on each element
+check "functions of arrays" "2.5 4 0 1.5
+-2 4 0 1
+1.5811388 2 0 1.2247449
+-2.5 4 0 1.5" <<-'END'
+	a = array(0)
+	a[0] = -2.5
+	a[1] = 4
+	a[2] = 0
+	a[3] = 1.5
+	print abs(a)
+	print int(a)
+	print sqrt(abs(a))
+	print a
+END
+
+# exp() and log() are polynomials on vectors, within 2 ulp of libm's
+check "exp and log" "0 0 0" <<-'END'
+	a = array(0)
+	for (x = -700; x < 709; x += 0.73) a[len(a)] = x
+	a[len(a)] = 1e-310
+	a[len(a)] = -1e-310
+	ex = exp(a)
+	bad1 = 0
+	for (i = 0; i < len(a); i++) if (abs(ex[i] - exp(a[i])) > 5e-16 * exp(a[i])) bad1++
+	b = array(0)
+	for (x = 1e-300; x < 1e300; x *= 3.7) b[len(b)] = x
+	b[len(b)] = 1e-310
+	b[len(b)] = 1
+	l = log(b)
+	bad2 = 0
+	for (i = 0; i < len(b); i++) if (abs(l[i] - log(b[i])) > 5e-16 * abs(log(b[i]))) bad2++
+	c = array(0)
+	for (x = 0.5; x < 2; x += 0.001) c[len(c)] = x
+	l = log(c)
+	bad3 = 0
+	for (i = 0; i < len(c); i++) if (abs(l[i] - log(c[i])) > 5e-16 * abs(log(c[i])) + 1e-300) bad3++
+	print bad1, bad2, bad3
+END
+
+# an element out of range fails the whole call, as it would alone
+check "errors of functions of arrays" "hoc: line 3: exp: result out of range
+hoc: line 5: sqrt: argument out of domain
+hoc: line 6: log: result out of range
+hoc: line 8: abs: array holds strings" <<-'END'
+	a = array(3)
+	a[1] = 1000
+	print exp(a)
+	a[1] = -1
+	print sqrt(a)
+	print log(array(2))
+	a[2] = "s"
+	print abs(a)
+END
+
+exit $FAILED
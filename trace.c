@@ -0,0 +1,160 @@
+#include <err.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "trace.h"
+
+/*
+ * The tracer is enabled by the -t option.  It records when each call
+ * to a function or procedure, each top-level statement and each input
+ * or output operation begins and ends, and writes them as duration
+ * events of the trace event format read by chrome://tracing, Perfetto
+ * and speedscope.  Events are stored into a preallocated buffer, which
+ * is written out only when it gets full and on exit.
+ */
+
+#define NEVENTS 8192            /* number of events buffered before being written */
+
+/* trace event */
+typedef struct Event {
+	const char *name;
+	const char *cat;        /* category; NULL for an end event */
+	uint64_t ts;            /* timestamp, in nanoseconds since the start */
+	int line;
+} Event;
+
+int tracing = 0;
+
+static struct {
+	Event *ev;
+	size_t n;
+	size_t depth;           /* number of events begun and not ended */
+	uint64_t start;
+	FILE *fp;
+	const char *path;
+	int first;              /* whether no event has been written yet */
+} trace = {NULL, 0, 0, 0, NULL, NULL, 1};
+
+/* get monotonic time in nanoseconds */
+static uint64_t
+now(void)
+{
+	struct timespec ts;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* write JSON string */
+static void
+putstr(const char *s, FILE *fp)
+{
+	putc('"', fp);
+	for (; *s; s++) {
+		if (*s == '"' || *s == '\\')
+			putc('\\', fp);
+		if ((unsigned char)*s >= ' ')
+			putc(*s, fp);
+	}
+	putc('"', fp);
+}
+
+/* write buffered events */
+static void
+flush(void)
+{
+	Event *e;
+	size_t i;
+
+	for (i = 0; i < trace.n; i++) {
+		e = &trace.ev[i];
+		fprintf(trace.fp, "%s{\"ph\":\"%c\",\"ts\":%llu.%03u,\"pid\":1,\"tid\":1",
+		        trace.first ? "" : ",\n", e->cat ? 'B' : 'E',
+		        (unsigned long long)(e->ts / 1000), (unsigned)(e->ts % 1000));
+		if (e->cat) {
+			fputs(",\"name\":", trace.fp);
+			putstr(e->name, trace.fp);
+			fprintf(trace.fp, ",\"cat\":\"%s\"", e->cat);
+			if (e->line > 0)
+				fprintf(trace.fp, ",\"args\":{\"line\":%d}", e->line);
+		}
+		putc('}', trace.fp);
+		trace.first = 0;
+	}
+	if (ferror(trace.fp))
+		err(1, "%s", trace.path);
+	trace.n = 0;
+}
+
+/* add event to the buffer */
+static void
+addevent(const char *name, const char *cat, int line)
+{
+	Event *e;
+
+	if (trace.n == NEVENTS)
+		flush();
+	e = &trace.ev[trace.n++];
+	e->name = name;
+	e->cat = cat;
+	e->line = line;
+	e->ts = now() - trace.start;
+}
+
+/* start tracing into the file path */
+void
+traceinit(const char *path)
+{
+	if ((trace.ev = calloc(NEVENTS, sizeof *trace.ev)) == NULL)
+		err(1, "calloc");
+	if ((trace.fp = fopen(path, "w")) == NULL)
+		err(1, "%s", path);
+	trace.path = path;
+	trace.start = now();
+	fputs("[\n", trace.fp);
+	tracing = 1;
+}
+
+/* begin event name of category cat, at line (or 0) */
+void
+tracebegin(const char *name, const char *cat, int line)
+{
+	trace.depth++;
+	addevent(name, cat, line);
+}
+
+/* end the event begun last */
+void
+traceend(void)
+{
+	if (trace.depth == 0)
+		return;
+	trace.depth--;
+	addevent(NULL, NULL, 0);
+}
+
+/* end the events left open by an error that jumped to the main loop */
+void
+tracereset(void)
+{
+	if (!tracing)
+		return;
+	while (trace.depth > 0)
+		traceend();
+}
+
+/* write buffered events and close the trace */
+void
+traceexit(void)
+{
+	if (!tracing)
+		return;
+	tracereset();
+	flush();
+	fputs("\n]\n", trace.fp);
+	if (fclose(trace.fp) == EOF)
+		err(1, "%s", trace.path);
+	free(trace.ev);
+	tracing = 0;
+}
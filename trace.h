@@ -0,0 +1,7 @@
+extern int tracing;
+
+void traceinit(const char *path);
+void tracebegin(const char *name, const char *cat, int line);
+void traceend(void);
+void tracereset(void);
+void traceexit(void);
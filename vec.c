@@ -0,0 +1,1101 @@
+#include <errno.h>
+#include <fenv.h>
+#include <float.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "vec.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define X86 1
+#include <immintrin.h>
+#else
+#define X86 0
+#endif
+
+/*
+ * Kernels for the array built-in functions.  Each operation has a
+ * scalar version and, on x86, an SSE2 and an AVX2 version; the best
+ * one the processor supports is selected the first time one is used.
+ * Sums and dot products are accumulated into LANES partial sums, in
+ * the same order by every version, so their results do not depend on
+ * the processor, though they may differ in the last bits from adding
+ * the elements one by one.
+ */
+
+#define LANES 8                 /* partial sums of sums and dot products */
+
+/* the kernels of one instruction set */
+typedef struct Kernels {
+	const char *name;
+	void (*sum)(const double *x, size_t n, double *s);
+	void (*dot)(const double *x, const double *y, size_t n, double *s);
+	double (*min)(const double *x, size_t n);
+	double (*max)(const double *x, size_t n);
+	size_t (*count)(const double *x, size_t n, int cmp, double v);
+	void (*axpy)(double a, const double *x, double *y, size_t n);
+	void (*add)(const double *x, const double *y, double *z, size_t n);
+	void (*mul)(const double *x, const double *y, double *z, size_t n);
+	void (*scale)(const double *x, double a, double *z, size_t n);
+	void (*exps)(const double *x, double *z, size_t n);
+	void (*logs)(const double *x, double *z, size_t n);
+	void (*sqrts)(const double *x, double *z, size_t n);
+	void (*abss)(const double *x, double *z, size_t n);
+	void (*ints)(const double *x, double *z, size_t n);
+} Kernels;
+
+static const Kernels *kernels = NULL;
+
+/* add the partial sums together, in a fixed order */
+static double
+fold(const double *s)
+{
+	return ((s[0] + s[1]) + (s[2] + s[3])) + ((s[4] + s[5]) + (s[6] + s[7]));
+}
+
+/* compare a and b */
+static int
+cmp1(double a, int cmp, double b)
+{
+	switch (cmp) {
+	case VECLT:
+		return a < b;
+	case VECLE:
+		return a <= b;
+	case VECGT:
+		return a > b;
+	case VECGE:
+		return a >= b;
+	case VECEQ:
+		return a == b;
+	default:
+		return a != b;
+	}
+}
+
+/* scalar kernels; they also do the elements left over by the others */
+
+static void
+sum1(const double *x, size_t n, double *s)
+{
+	size_t i, j;
+
+	for (i = 0; i + LANES <= n; i += LANES)
+		for (j = 0; j < LANES; j++)
+			s[j] += x[i + j];
+	for (j = 0; i < n; i++, j++)
+		s[j] += x[i];
+}
+
+static void
+dot1(const double *x, const double *y, size_t n, double *s)
+{
+	size_t i, j;
+
+	for (i = 0; i + LANES <= n; i += LANES)
+		for (j = 0; j < LANES; j++)
+			s[j] += x[i + j] * y[i + j];
+	for (j = 0; i < n; i++, j++)
+		s[j] += x[i] * y[i];
+}
+
+static double
+min1(const double *x, size_t n)
+{
+	double m;
+	size_t i;
+
+	for (m = INFINITY, i = 0; i < n; i++)
+		m = (x[i] < m) ? x[i] : m;
+	return m;
+}
+
+static double
+max1(const double *x, size_t n)
+{
+	double m;
+	size_t i;
+
+	for (m = -INFINITY, i = 0; i < n; i++)
+		m = (x[i] > m) ? x[i] : m;
+	return m;
+}
+
+static size_t
+count1(const double *x, size_t n, int cmp, double v)
+{
+	size_t i, c;
+
+	for (c = i = 0; i < n; i++)
+		c += cmp1(x[i], cmp, v);
+	return c;
+}
+
+static void
+axpy1(double a, const double *x, double *y, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		y[i] += a * x[i];
+}
+
+static void
+add1(const double *x, const double *y, double *z, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		z[i] = x[i] + y[i];
+}
+
+static void
+mul1(const double *x, const double *y, double *z, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		z[i] = x[i] * y[i];
+}
+
+static void
+scale1(const double *x, double a, double *z, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		z[i] = x[i] * a;
+}
+
+/*
+ * exp and log of one element, by polynomials evaluated the same way
+ * by every version of the kernels; arguments out of their range
+ * (overflow, underflow, nonpositive, subnormal, infinite or NaN) are
+ * left to libm, and so are tiny nonzero exp arguments, whose
+ * polynomial would raise a spurious underflow
+ */
+
+#define EXPMAX  708.0                           /* larger |x| are left to libm */
+#define EXPMIN  0x1p-60                         /* and so are smaller nonzero |x| */
+#define LOG2E   1.44269504088896338700e+00
+#define LN2HI   6.93147180369123816490e-01      /* ln 2, in two parts */
+#define LN2LO   1.90821492927058770002e-10
+#define MAGIC   6755399441055744.0              /* 2^52 + 2^51, for rounding */
+#define TWO52   4503599627370496.0              /* 2^52 */
+#define EXPBITS 0x4330000000000000ULL           /* bits of 2^52 */
+#define ONEBITS 0x3ff0000000000000ULL           /* bits of 1.0 */
+#define MANBITS 0x000fffffffffffffULL           /* mantissa bits */
+
+/* Taylor coefficients of exp(r), for |r| <= ln(2)/2 */
+static const double expc[] = {
+	1.0, 1.0, 1.0 / 2, 1.0 / 6, 1.0 / 24, 1.0 / 120, 1.0 / 720,
+	1.0 / 5040, 1.0 / 40320, 1.0 / 362880, 1.0 / 3628800,
+	1.0 / 39916800, 1.0 / 479001600, 1.0 / 6227020800
+};
+#define NEXPC   (sizeof expc / sizeof expc[0])
+
+/* coefficients of (atanh(f) - f) / f^3 in powers of f^2, for |f| <= 0.172 */
+static const double logc[] = {
+	1.0 / 3, 1.0 / 5, 1.0 / 7, 1.0 / 9, 1.0 / 11, 1.0 / 13,
+	1.0 / 15, 1.0 / 17, 1.0 / 19, 1.0 / 21, 1.0 / 23
+};
+#define NLOGC   (sizeof logc / sizeof logc[0])
+
+typedef union Bits {
+	double d;
+	uint64_t u;
+} Bits;
+
+/* exp(x) = 2^k exp(r), with k the integer nearest to x / ln 2 */
+static double
+exppoly(double x)
+{
+	Bits t, b;
+	double k, r, p;
+	int j;
+
+	if (!islessequal(fabs(x), EXPMAX) || (fabs(x) < EXPMIN && x != 0.0))
+		return exp(x);
+	t.d = x * LOG2E + MAGIC;
+	k = t.d - MAGIC;
+	b.u = (t.u + 1023) << 52;
+	r = (x - k * LN2HI) - k * LN2LO;
+	for (p = expc[NEXPC - 1], j = NEXPC - 2; j >= 0; j--)
+		p = p * r + expc[j];
+	return p * b.d;
+}
+
+/* log(x) = e ln 2 + 2 atanh(f), with x = 2^e m, sqrt(1/2) < m <= sqrt(2), and f = (m - 1) / (m + 1) */
+static double
+logpoly(double x)
+{
+	Bits v, b, m;
+	double e, f, s, h, p;
+	int j;
+
+	if (!isgreaterequal(x, DBL_MIN) || !islessequal(x, DBL_MAX))
+		return log(x);
+	v.d = x;
+	b.u = (v.u >> 52) | EXPBITS;
+	e = b.d - (TWO52 + 1023);
+	m.u = (v.u & MANBITS) | ONEBITS;
+	if (m.d > M_SQRT2) {
+		m.d *= 0.5;
+		e += 1.0;
+	}
+	f = (m.d - 1.0) / (m.d + 1.0);
+	s = f * f;
+	h = f + f;
+	for (p = logc[NLOGC - 1], j = NLOGC - 2; j >= 0; j--)
+		p = p * s + logc[j];
+	return e * LN2HI + (h + (h * s * p + e * LN2LO));
+}
+
+static void
+exps1(const double *x, double *z, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		z[i] = exppoly(x[i]);
+}
+
+static void
+logs1(const double *x, double *z, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		z[i] = logpoly(x[i]);
+}
+
+static void
+sqrts1(const double *x, double *z, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		z[i] = sqrt(x[i]);
+}
+
+static void
+abss1(const double *x, double *z, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		z[i] = fabs(x[i]);
+}
+
+static void
+ints1(const double *x, double *z, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		z[i] = trunc(x[i]);
+}
+
+/* store f of the elements of x left out of mask, of the lanes of a vector kernel, into z */
+static void
+fixlanes(double (*f)(double), const double *x, double *z, int mask, int lanes)
+{
+	int j;
+
+	if (mask == (1 << lanes) - 1)
+		return;
+	for (j = 0; j < lanes; j++)
+		if (!(mask & 1 << j))
+			z[j] = f(x[j]);
+}
+
+static const Kernels scalar = {
+	"scalar", sum1, dot1, min1, max1, count1, axpy1, add1, mul1, scale1,
+	exps1, logs1, sqrts1, abss1, ints1
+};
+
+#if X86
+
+/* SSE2 kernels */
+
+__attribute__((target("sse2")))
+static void
+sum2(const double *x, size_t n, double *s)
+{
+	__m128d a0, a1, a2, a3;
+	size_t i;
+
+	a0 = a1 = a2 = a3 = _mm_setzero_pd();
+	for (i = 0; i + LANES <= n; i += LANES) {
+		a0 = _mm_add_pd(a0, _mm_loadu_pd(x + i));
+		a1 = _mm_add_pd(a1, _mm_loadu_pd(x + i + 2));
+		a2 = _mm_add_pd(a2, _mm_loadu_pd(x + i + 4));
+		a3 = _mm_add_pd(a3, _mm_loadu_pd(x + i + 6));
+	}
+	_mm_storeu_pd(s, a0);
+	_mm_storeu_pd(s + 2, a1);
+	_mm_storeu_pd(s + 4, a2);
+	_mm_storeu_pd(s + 6, a3);
+	sum1(x + i, n - i, s);
+}
+
+__attribute__((target("sse2")))
+static void
+dot2(const double *x, const double *y, size_t n, double *s)
+{
+	__m128d a0, a1, a2, a3;
+	size_t i;
+
+	a0 = a1 = a2 = a3 = _mm_setzero_pd();
+	for (i = 0; i + LANES <= n; i += LANES) {
+		a0 = _mm_add_pd(a0, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+		a1 = _mm_add_pd(a1, _mm_mul_pd(_mm_loadu_pd(x + i + 2), _mm_loadu_pd(y + i + 2)));
+		a2 = _mm_add_pd(a2, _mm_mul_pd(_mm_loadu_pd(x + i + 4), _mm_loadu_pd(y + i + 4)));
+		a3 = _mm_add_pd(a3, _mm_mul_pd(_mm_loadu_pd(x + i + 6), _mm_loadu_pd(y + i + 6)));
+	}
+	_mm_storeu_pd(s, a0);
+	_mm_storeu_pd(s + 2, a1);
+	_mm_storeu_pd(s + 4, a2);
+	_mm_storeu_pd(s + 6, a3);
+	dot1(x + i, y + i, n - i, s);
+}
+
+/* _mm_min_pd(x, m) is x < m ? x : m, as min1() computes it */
+__attribute__((target("sse2")))
+static double
+min2(const double *x, size_t n)
+{
+	__m128d m0, m1;
+	double m[4];
+	size_t i;
+
+	m0 = m1 = _mm_set1_pd(INFINITY);
+	for (i = 0; i + 4 <= n; i += 4) {
+		m0 = _mm_min_pd(_mm_loadu_pd(x + i), m0);
+		m1 = _mm_min_pd(_mm_loadu_pd(x + i + 2), m1);
+	}
+	_mm_storeu_pd(m, m0);
+	_mm_storeu_pd(m + 2, m1);
+	m[0] = min1(m, 4);
+	m[1] = min1(x + i, n - i);
+	return (m[1] < m[0]) ? m[1] : m[0];
+}
+
+__attribute__((target("sse2")))
+static double
+max2(const double *x, size_t n)
+{
+	__m128d m0, m1;
+	double m[4];
+	size_t i;
+
+	m0 = m1 = _mm_set1_pd(-INFINITY);
+	for (i = 0; i + 4 <= n; i += 4) {
+		m0 = _mm_max_pd(_mm_loadu_pd(x + i), m0);
+		m1 = _mm_max_pd(_mm_loadu_pd(x + i + 2), m1);
+	}
+	_mm_storeu_pd(m, m0);
+	_mm_storeu_pd(m + 2, m1);
+	m[0] = max1(m, 4);
+	m[1] = max1(x + i, n - i);
+	return (m[1] > m[0]) ? m[1] : m[0];
+}
+
+__attribute__((target("sse2")))
+static size_t
+count2(const double *x, size_t n, int cmp, double v)
+{
+	__m128d a, b;
+	size_t i, c;
+	int mask;
+
+	b = _mm_set1_pd(v);
+	for (c = i = 0; i + 2 <= n; i += 2) {
+		a = _mm_loadu_pd(x + i);
+		switch (cmp) {
+		case VECLT:
+			mask = _mm_movemask_pd(_mm_cmplt_pd(a, b));
+			break;
+		case VECLE:
+			mask = _mm_movemask_pd(_mm_cmple_pd(a, b));
+			break;
+		case VECGT:
+			mask = _mm_movemask_pd(_mm_cmpgt_pd(a, b));
+			break;
+		case VECGE:
+			mask = _mm_movemask_pd(_mm_cmpge_pd(a, b));
+			break;
+		case VECEQ:
+			mask = _mm_movemask_pd(_mm_cmpeq_pd(a, b));
+			break;
+		default:
+			mask = _mm_movemask_pd(_mm_cmpneq_pd(a, b));
+			break;
+		}
+		c += (mask & 1) + (mask >> 1);
+	}
+	return c + count1(x + i, n - i, cmp, v);
+}
+
+__attribute__((target("sse2")))
+static void
+axpy2(double a, const double *x, double *y, size_t n)
+{
+	__m128d va;
+	size_t i;
+
+	va = _mm_set1_pd(a);
+	for (i = 0; i + 2 <= n; i += 2)
+		_mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(va, _mm_loadu_pd(x + i))));
+	axpy1(a, x + i, y + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static void
+add2(const double *x, const double *y, double *z, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i + 2 <= n; i += 2)
+		_mm_storeu_pd(z + i, _mm_add_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+	add1(x + i, y + i, z + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static void
+mul2(const double *x, const double *y, double *z, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i + 2 <= n; i += 2)
+		_mm_storeu_pd(z + i, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+	mul1(x + i, y + i, z + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static void
+scale2(const double *x, double a, double *z, size_t n)
+{
+	__m128d va;
+	size_t i;
+
+	va = _mm_set1_pd(a);
+	for (i = 0; i + 2 <= n; i += 2)
+		_mm_storeu_pd(z + i, _mm_mul_pd(_mm_loadu_pd(x + i), va));
+	scale1(x + i, a, z + i, n - i);
+}
+
+/*
+ * reduce the exp arguments at x to r, and return their scale 2^k; lanes
+ * left to libm are reduced as 0, and left out of mask
+ */
+__attribute__((target("sse2")))
+static __m128d
+expred2(const double *x, __m128d *r, int *mask)
+{
+	__m128d v, a, ok, k;
+	__m128i b;
+
+	v = _mm_loadu_pd(x);
+	ok = _mm_cmpord_pd(v, v);
+	v = _mm_and_pd(v, ok);          /* no NaN in the signaling comparisons */
+	a = _mm_andnot_pd(_mm_set1_pd(-0.0), v);
+	ok = _mm_and_pd(ok, _mm_cmple_pd(a, _mm_set1_pd(EXPMAX)));
+	ok = _mm_and_pd(ok, _mm_or_pd(_mm_cmpge_pd(a, _mm_set1_pd(EXPMIN)), _mm_cmpeq_pd(a, _mm_setzero_pd())));
+	v = _mm_and_pd(v, ok);
+	k = _mm_add_pd(_mm_mul_pd(v, _mm_set1_pd(LOG2E)), _mm_set1_pd(MAGIC));
+	b = _mm_slli_epi64(_mm_add_epi64(_mm_castpd_si128(k), _mm_set1_epi64x(1023)), 52);
+	k = _mm_sub_pd(k, _mm_set1_pd(MAGIC));
+	*r = _mm_sub_pd(_mm_sub_pd(v, _mm_mul_pd(k, _mm_set1_pd(LN2HI))), _mm_mul_pd(k, _mm_set1_pd(LN2LO)));
+	*mask = _mm_movemask_pd(ok);
+	return _mm_castsi128_pd(b);
+}
+
+/* two vectors at a time, so that their polynomials overlap */
+__attribute__((target("sse2")))
+static void
+exps2(const double *x, double *z, size_t n)
+{
+	__m128d r0, r1, s0, s1, p0, p1, c;
+	size_t i;
+	int j, m0, m1;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		s0 = expred2(x + i, &r0, &m0);
+		s1 = expred2(x + i + 2, &r1, &m1);
+		p0 = p1 = _mm_set1_pd(expc[NEXPC - 1]);
+		for (j = NEXPC - 2; j >= 0; j--) {
+			c = _mm_set1_pd(expc[j]);
+			p0 = _mm_add_pd(_mm_mul_pd(p0, r0), c);
+			p1 = _mm_add_pd(_mm_mul_pd(p1, r1), c);
+		}
+		_mm_storeu_pd(z + i, _mm_mul_pd(p0, s0));
+		_mm_storeu_pd(z + i + 2, _mm_mul_pd(p1, s1));
+		fixlanes(exp, x + i, z + i, m0 | m1 << 2, 4);
+	}
+	exps1(x + i, z + i, n - i);
+}
+
+/*
+ * reduce the log arguments at x to f, and return their exponents e;
+ * lanes out of [DBL_MIN, DBL_MAX] are reduced as 1, and left out of mask
+ */
+__attribute__((target("sse2")))
+static __m128d
+logred2(const double *x, __m128d *f, int *mask)
+{
+	__m128d v, ok, e, m, big, one;
+	__m128i u;
+
+	one = _mm_set1_pd(1.0);
+	v = _mm_loadu_pd(x);
+	ok = _mm_cmpord_pd(v, v);
+	v = _mm_and_pd(v, ok);
+	ok = _mm_and_pd(ok, _mm_and_pd(_mm_cmpge_pd(v, _mm_set1_pd(DBL_MIN)), _mm_cmple_pd(v, _mm_set1_pd(DBL_MAX))));
+	v = _mm_or_pd(_mm_and_pd(ok, v), _mm_andnot_pd(ok, one));
+	u = _mm_castpd_si128(v);
+	e = _mm_castsi128_pd(_mm_or_si128(_mm_srli_epi64(u, 52), _mm_set1_epi64x(EXPBITS)));
+	e = _mm_sub_pd(e, _mm_set1_pd(TWO52 + 1023));
+	m = _mm_castsi128_pd(_mm_or_si128(_mm_and_si128(u, _mm_set1_epi64x(MANBITS)), _mm_set1_epi64x(ONEBITS)));
+	big = _mm_cmpgt_pd(m, _mm_set1_pd(M_SQRT2));
+	m = _mm_or_pd(_mm_and_pd(big, _mm_mul_pd(m, _mm_set1_pd(0.5))), _mm_andnot_pd(big, m));
+	*f = _mm_div_pd(_mm_sub_pd(m, one), _mm_add_pd(m, one));
+	*mask = _mm_movemask_pd(ok);
+	return _mm_add_pd(e, _mm_and_pd(big, one));
+}
+
+/* log from its reduction, as logpoly() computes it */
+__attribute__((target("sse2")))
+static __m128d
+logsum2(__m128d e, __m128d f, __m128d s, __m128d p)
+{
+	__m128d h;
+
+	h = _mm_add_pd(f, f);
+	p = _mm_add_pd(_mm_mul_pd(_mm_mul_pd(h, s), p), _mm_mul_pd(e, _mm_set1_pd(LN2LO)));
+	return _mm_add_pd(_mm_mul_pd(e, _mm_set1_pd(LN2HI)), _mm_add_pd(h, p));
+}
+
+__attribute__((target("sse2")))
+static void
+logs2(const double *x, double *z, size_t n)
+{
+	__m128d e0, e1, f0, f1, s0, s1, p0, p1, c;
+	size_t i;
+	int j, m0, m1;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		e0 = logred2(x + i, &f0, &m0);
+		e1 = logred2(x + i + 2, &f1, &m1);
+		s0 = _mm_mul_pd(f0, f0);
+		s1 = _mm_mul_pd(f1, f1);
+		p0 = p1 = _mm_set1_pd(logc[NLOGC - 1]);
+		for (j = NLOGC - 2; j >= 0; j--) {
+			c = _mm_set1_pd(logc[j]);
+			p0 = _mm_add_pd(_mm_mul_pd(p0, s0), c);
+			p1 = _mm_add_pd(_mm_mul_pd(p1, s1), c);
+		}
+		_mm_storeu_pd(z + i, logsum2(e0, f0, s0, p0));
+		_mm_storeu_pd(z + i + 2, logsum2(e1, f1, s1, p1));
+		fixlanes(log, x + i, z + i, m0 | m1 << 2, 4);
+	}
+	logs1(x + i, z + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static void
+sqrts2(const double *x, double *z, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i + 2 <= n; i += 2)
+		_mm_storeu_pd(z + i, _mm_sqrt_pd(_mm_loadu_pd(x + i)));
+	sqrts1(x + i, z + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static void
+abss2(const double *x, double *z, size_t n)
+{
+	__m128d sign;
+	size_t i;
+
+	sign = _mm_set1_pd(-0.0);
+	for (i = 0; i + 2 <= n; i += 2)
+		_mm_storeu_pd(z + i, _mm_andnot_pd(sign, _mm_loadu_pd(x + i)));
+	abss1(x + i, z + i, n - i);
+}
+
+/* SSE2 has no rounding instruction */
+static const Kernels sse2 = {
+	"sse2", sum2, dot2, min2, max2, count2, axpy2, add2, mul2, scale2,
+	exps2, logs2, sqrts2, abss2, ints1
+};
+
+/* AVX2 kernels */
+
+__attribute__((target("avx2")))
+static void
+sum4(const double *x, size_t n, double *s)
+{
+	__m256d a0, a1;
+	size_t i;
+
+	a0 = a1 = _mm256_setzero_pd();
+	for (i = 0; i + LANES <= n; i += LANES) {
+		a0 = _mm256_add_pd(a0, _mm256_loadu_pd(x + i));
+		a1 = _mm256_add_pd(a1, _mm256_loadu_pd(x + i + 4));
+	}
+	_mm256_storeu_pd(s, a0);
+	_mm256_storeu_pd(s + 4, a1);
+	sum1(x + i, n - i, s);
+}
+
+__attribute__((target("avx2")))
+static void
+dot4(const double *x, const double *y, size_t n, double *s)
+{
+	__m256d a0, a1;
+	size_t i;
+
+	a0 = a1 = _mm256_setzero_pd();
+	for (i = 0; i + LANES <= n; i += LANES) {
+		a0 = _mm256_add_pd(a0, _mm256_mul_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+		a1 = _mm256_add_pd(a1, _mm256_mul_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4)));
+	}
+	_mm256_storeu_pd(s, a0);
+	_mm256_storeu_pd(s + 4, a1);
+	dot1(x + i, y + i, n - i, s);
+}
+
+__attribute__((target("avx2")))
+static double
+min4(const double *x, size_t n)
+{
+	__m256d m0;
+	double m[4];
+	size_t i;
+
+	m0 = _mm256_set1_pd(INFINITY);
+	for (i = 0; i + 4 <= n; i += 4)
+		m0 = _mm256_min_pd(_mm256_loadu_pd(x + i), m0);
+	_mm256_storeu_pd(m, m0);
+	m[0] = min1(m, 4);
+	m[1] = min1(x + i, n - i);
+	return (m[1] < m[0]) ? m[1] : m[0];
+}
+
+__attribute__((target("avx2")))
+static double
+max4(const double *x, size_t n)
+{
+	__m256d m0;
+	double m[4];
+	size_t i;
+
+	m0 = _mm256_set1_pd(-INFINITY);
+	for (i = 0; i + 4 <= n; i += 4)
+		m0 = _mm256_max_pd(_mm256_loadu_pd(x + i), m0);
+	_mm256_storeu_pd(m, m0);
+	m[0] = max1(m, 4);
+	m[1] = max1(x + i, n - i);
+	return (m[1] > m[0]) ? m[1] : m[0];
+}
+
+__attribute__((target("avx2")))
+static size_t
+count4(const double *x, size_t n, int cmp, double v)
+{
+	__m256d a, b;
+	size_t i, c;
+	int mask;
+
+	b = _mm256_set1_pd(v);
+	for (c = i = 0; i + 4 <= n; i += 4) {
+		a = _mm256_loadu_pd(x + i);
+		switch (cmp) {
+		case VECLT:
+			mask = _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_LT_OQ));
+			break;
+		case VECLE:
+			mask = _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_LE_OQ));
+			break;
+		case VECGT:
+			mask = _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_GT_OQ));
+			break;
+		case VECGE:
+			mask = _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_GE_OQ));
+			break;
+		case VECEQ:
+			mask = _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ));
+			break;
+		default:
+			mask = _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_NEQ_UQ));
+			break;
+		}
+		c += __builtin_popcount(mask);
+	}
+	return c + count1(x + i, n - i, cmp, v);
+}
+
+__attribute__((target("avx2")))
+static void
+axpy4(double a, const double *x, double *y, size_t n)
+{
+	__m256d va;
+	size_t i;
+
+	va = _mm256_set1_pd(a);
+	for (i = 0; i + 4 <= n; i += 4)
+		_mm256_storeu_pd(y + i, _mm256_add_pd(_mm256_loadu_pd(y + i), _mm256_mul_pd(va, _mm256_loadu_pd(x + i))));
+	axpy1(a, x + i, y + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void
+add4(const double *x, const double *y, double *z, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i + 4 <= n; i += 4)
+		_mm256_storeu_pd(z + i, _mm256_add_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+	add1(x + i, y + i, z + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void
+mul4(const double *x, const double *y, double *z, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i + 4 <= n; i += 4)
+		_mm256_storeu_pd(z + i, _mm256_mul_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+	mul1(x + i, y + i, z + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void
+scale4(const double *x, double a, double *z, size_t n)
+{
+	__m256d va;
+	size_t i;
+
+	va = _mm256_set1_pd(a);
+	for (i = 0; i + 4 <= n; i += 4)
+		_mm256_storeu_pd(z + i, _mm256_mul_pd(_mm256_loadu_pd(x + i), va));
+	scale1(x + i, a, z + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static __m256d
+expred4(const double *x, __m256d *r, int *mask)
+{
+	__m256d v, a, ok, k;
+	__m256i b;
+
+	v = _mm256_loadu_pd(x);
+	a = _mm256_andnot_pd(_mm256_set1_pd(-0.0), v);
+	ok = _mm256_cmp_pd(a, _mm256_set1_pd(EXPMAX), _CMP_LE_OQ);
+	ok = _mm256_and_pd(ok, _mm256_or_pd(_mm256_cmp_pd(a, _mm256_set1_pd(EXPMIN), _CMP_GE_OQ),
+	                                    _mm256_cmp_pd(a, _mm256_setzero_pd(), _CMP_EQ_OQ)));
+	v = _mm256_and_pd(v, ok);
+	k = _mm256_add_pd(_mm256_mul_pd(v, _mm256_set1_pd(LOG2E)), _mm256_set1_pd(MAGIC));
+	b = _mm256_slli_epi64(_mm256_add_epi64(_mm256_castpd_si256(k), _mm256_set1_epi64x(1023)), 52);
+	k = _mm256_sub_pd(k, _mm256_set1_pd(MAGIC));
+	*r = _mm256_sub_pd(_mm256_sub_pd(v, _mm256_mul_pd(k, _mm256_set1_pd(LN2HI))), _mm256_mul_pd(k, _mm256_set1_pd(LN2LO)));
+	*mask = _mm256_movemask_pd(ok);
+	return _mm256_castsi256_pd(b);
+}
+
+__attribute__((target("avx2")))
+static void
+exps4(const double *x, double *z, size_t n)
+{
+	__m256d r0, r1, s0, s1, p0, p1, c;
+	size_t i;
+	int j, m0, m1;
+
+	for (i = 0; i + 8 <= n; i += 8) {
+		s0 = expred4(x + i, &r0, &m0);
+		s1 = expred4(x + i + 4, &r1, &m1);
+		p0 = p1 = _mm256_set1_pd(expc[NEXPC - 1]);
+		for (j = NEXPC - 2; j >= 0; j--) {
+			c = _mm256_set1_pd(expc[j]);
+			p0 = _mm256_add_pd(_mm256_mul_pd(p0, r0), c);
+			p1 = _mm256_add_pd(_mm256_mul_pd(p1, r1), c);
+		}
+		_mm256_storeu_pd(z + i, _mm256_mul_pd(p0, s0));
+		_mm256_storeu_pd(z + i + 4, _mm256_mul_pd(p1, s1));
+		fixlanes(exp, x + i, z + i, m0 | m1 << 4, 8);
+	}
+	exps1(x + i, z + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static __m256d
+logred4(const double *x, __m256d *f, int *mask)
+{
+	__m256d v, ok, e, m, big, one;
+	__m256i u;
+
+	one = _mm256_set1_pd(1.0);
+	v = _mm256_loadu_pd(x);
+	ok = _mm256_and_pd(_mm256_cmp_pd(v, _mm256_set1_pd(DBL_MIN), _CMP_GE_OQ),
+	                   _mm256_cmp_pd(v, _mm256_set1_pd(DBL_MAX), _CMP_LE_OQ));
+	v = _mm256_blendv_pd(one, v, ok);
+	u = _mm256_castpd_si256(v);
+	e = _mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(u, 52), _mm256_set1_epi64x(EXPBITS)));
+	e = _mm256_sub_pd(e, _mm256_set1_pd(TWO52 + 1023));
+	m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(u, _mm256_set1_epi64x(MANBITS)), _mm256_set1_epi64x(ONEBITS)));
+	big = _mm256_cmp_pd(m, _mm256_set1_pd(M_SQRT2), _CMP_GT_OQ);
+	m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), big);
+	*f = _mm256_div_pd(_mm256_sub_pd(m, one), _mm256_add_pd(m, one));
+	*mask = _mm256_movemask_pd(ok);
+	return _mm256_add_pd(e, _mm256_and_pd(big, one));
+}
+
+__attribute__((target("avx2")))
+static __m256d
+logsum4(__m256d e, __m256d f, __m256d s, __m256d p)
+{
+	__m256d h;
+
+	h = _mm256_add_pd(f, f);
+	p = _mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(h, s), p), _mm256_mul_pd(e, _mm256_set1_pd(LN2LO)));
+	return _mm256_add_pd(_mm256_mul_pd(e, _mm256_set1_pd(LN2HI)), _mm256_add_pd(h, p));
+}
+
+__attribute__((target("avx2")))
+static void
+logs4(const double *x, double *z, size_t n)
+{
+	__m256d e0, e1, f0, f1, s0, s1, p0, p1, c;
+	size_t i;
+	int j, m0, m1;
+
+	for (i = 0; i + 8 <= n; i += 8) {
+		e0 = logred4(x + i, &f0, &m0);
+		e1 = logred4(x + i + 4, &f1, &m1);
+		s0 = _mm256_mul_pd(f0, f0);
+		s1 = _mm256_mul_pd(f1, f1);
+		p0 = p1 = _mm256_set1_pd(logc[NLOGC - 1]);
+		for (j = NLOGC - 2; j >= 0; j--) {
+			c = _mm256_set1_pd(logc[j]);
+			p0 = _mm256_add_pd(_mm256_mul_pd(p0, s0), c);
+			p1 = _mm256_add_pd(_mm256_mul_pd(p1, s1), c);
+		}
+		_mm256_storeu_pd(z + i, logsum4(e0, f0, s0, p0));
+		_mm256_storeu_pd(z + i + 4, logsum4(e1, f1, s1, p1));
+		fixlanes(log, x + i, z + i, m0 | m1 << 4, 8);
+	}
+	logs1(x + i, z + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void
+sqrts4(const double *x, double *z, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i + 4 <= n; i += 4)
+		_mm256_storeu_pd(z + i, _mm256_sqrt_pd(_mm256_loadu_pd(x + i)));
+	sqrts1(x + i, z + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void
+abss4(const double *x, double *z, size_t n)
+{
+	__m256d sign;
+	size_t i;
+
+	sign = _mm256_set1_pd(-0.0);
+	for (i = 0; i + 4 <= n; i += 4)
+		_mm256_storeu_pd(z + i, _mm256_andnot_pd(sign, _mm256_loadu_pd(x + i)));
+	abss1(x + i, z + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void
+ints4(const double *x, double *z, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i + 4 <= n; i += 4)
+		_mm256_storeu_pd(z + i, _mm256_round_pd(_mm256_loadu_pd(x + i), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC));
+	ints1(x + i, z + i, n - i);
+}
+
+static const Kernels avx2 = {
+	"avx2", sum4, dot4, min4, max4, count4, axpy4, add4, mul4, scale4,
+	exps4, logs4, sqrts4, abss4, ints4
+};
+
+#endif /* X86 */
+
+/* select the kernels for this processor; threads racing to select them select the same */
+static const Kernels *
+getkernels(void)
+{
+	const Kernels *k;
+
+	if ((k = __atomic_load_n(&kernels, __ATOMIC_ACQUIRE)) != NULL)
+		return k;
+	k = &scalar;
+#if X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		k = &avx2;
+	else if (__builtin_cpu_supports("sse2"))
+		k = &sse2;
+#endif
+	__atomic_store_n(&kernels, k, __ATOMIC_RELEASE);
+	return k;
+}
+
+/* get the name of the instruction set of the kernels */
+const char *
+veckernels(void)
+{
+	return getkernels()->name;
+}
+
+/* get the sum of the n elements of x */
+double
+vecsum(const double *x, size_t n)
+{
+	double s[LANES] = {0.0};
+
+	getkernels()->sum(x, n, s);
+	return fold(s);
+}
+
+/* get the least of the n elements of x, ignoring NaNs; +inf if none */
+double
+vecmin(const double *x, size_t n)
+{
+	return getkernels()->min(x, n);
+}
+
+/* get the greatest of the n elements of x, ignoring NaNs; -inf if none */
+double
+vecmax(const double *x, size_t n)
+{
+	return getkernels()->max(x, n);
+}
+
+/* get the dot product of x and y, of n elements */
+double
+vecdot(const double *x, const double *y, size_t n)
+{
+	double s[LANES] = {0.0};
+
+	getkernels()->dot(x, y, n, s);
+	return fold(s);
+}
+
+/* count the elements of x that compare with v as cmp */
+size_t
+veccount(const double *x, size_t n, int cmp, double v)
+{
+	return getkernels()->count(x, n, cmp, v);
+}
+
+/* add a times x to y */
+void
+vecaxpy(double a, const double *x, double *y, size_t n)
+{
+	getkernels()->axpy(a, x, y, n);
+}
+
+/* store x plus y into z */
+void
+vecadd(const double *x, const double *y, double *z, size_t n)
+{
+	getkernels()->add(x, y, z, n);
+}
+
+/* store x times y into z */
+void
+vecmul(const double *x, const double *y, double *z, size_t n)
+{
+	getkernels()->mul(x, y, z, n);
+}
+
+/* store x times a into z */
+void
+vecscale(const double *x, double a, double *z, size_t n)
+{
+	getkernels()->scale(x, a, z, n);
+}
+
+/* store the running sums of x into z, adding the elements one by one */
+void
+veccumsum(const double *x, double *z, size_t n)
+{
+	double s;
+	size_t i;
+
+	for (s = 0.0, i = 0; i < n; i++)
+		z[i] = s += x[i];
+}
+
+/* apply the libm function f to each of the n elements of x */
+static void
+map(double (*f)(double), const double *x, double *z, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		z[i] = f(x[i]);
+}
+
+/*
+ * store the function fn of each of the n elements of x into z; return
+ * EDOM or ERANGE if any element was out of the domain of fn or had a
+ * result out of range (overflow or underflow), as told by the floating
+ * point exception flags raised by the whole batch, and 0 otherwise.  Functions without a
+ * kernel (sin, cos, atan, log10) call libm on each element.
+ */
+int
+vecmath(int fn, const double *x, double *z, size_t n)
+{
+	const Kernels *k;
+
+	k = getkernels();
+	feclearexcept(FE_ALL_EXCEPT);
+	switch (fn) {
+	case VECABS:
+		k->abss(x, z, n);
+		break;
+	case VECATAN:
+		map(atan, x, z, n);
+		break;
+	case VECCOS:
+		map(cos, x, z, n);
+		break;
+	case VECEXP:
+		k->exps(x, z, n);
+		break;
+	case VECINT:
+		k->ints(x, z, n);
+		break;
+	case VECLOG:
+		k->logs(x, z, n);
+		break;
+	case VECLOG10:
+		map(log10, x, z, n);
+		break;
+	case VECSIN:
+		map(sin, x, z, n);
+		break;
+	case VECSQRT:
+		k->sqrts(x, z, n);
+		break;
+	}
+	if (fetestexcept(FE_INVALID))
+		return EDOM;
+	if (fetestexcept(FE_DIVBYZERO | FE_OVERFLOW | FE_UNDERFLOW))
+		return ERANGE;
+	return 0;
+}
@@ -0,0 +1,18 @@
+/* comparisons counted by veccount() */
+enum {VECLT, VECLE, VECGT, VECGE, VECEQ, VECNE};
+
+/* functions applied by vecmath() */
+enum {VECNONE, VECABS, VECATAN, VECCOS, VECEXP, VECINT, VECLOG, VECLOG10, VECSIN, VECSQRT};
+
+const char *veckernels(void);
+double vecsum(const double *x, size_t n);
+double vecmin(const double *x, size_t n);
+double vecmax(const double *x, size_t n);
+double vecdot(const double *x, const double *y, size_t n);
+size_t veccount(const double *x, size_t n, int cmp, double v);
+void vecaxpy(double a, const double *x, double *y, size_t n);
+void vecadd(const double *x, const double *y, double *z, size_t n);
+void vecmul(const double *x, const double *y, double *z, size_t n);
+void vecscale(const double *x, double a, double *z, size_t n);
+void veccumsum(const double *x, double *z, size_t n);
+int vecmath(int fn, const double *x, double *z, size_t n);